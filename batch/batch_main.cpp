@@ -0,0 +1,161 @@
+#include "audio/BatchProcessor.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+  // Matches SampleConversion::getFormatName(), ignoring case
+  bool parseFormat(const std::string& name, SampleFormat& format) {
+    for (SampleFormat candidate : { SampleFormat::Int16, SampleFormat::Int24, SampleFormat::Int32, SampleFormat::Float32 }) {
+      std::string candidateName = SampleConversion::getFormatName(candidate);
+
+      if (name.size() == candidateName.size() &&
+          std::equal(name.begin(), name.end(), candidateName.begin(),
+                     [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) ==
+                                                 std::tolower(static_cast<unsigned char>(b)); })) {
+        format = candidate;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Whole decimal number only: no sign, spaces or trailing text
+  bool parseCount(const std::string& text, unsigned long long& value) {
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0]))) return false;
+
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtoull(text.c_str(), &end, 10);
+    return errno == 0 && *end == '\0';
+  }
+
+  void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <file|directory|pattern>..." << std::endl
+              << "  --chain=<steps>     Effect chain, e.g. gain=-3dB,normalize=-1dB (default: normalize)" << std::endl
+              << "  --output=<dir>      Write results here instead of next to each input" << std::endl
+              << "  --suffix=<text>     Appended to output file names (default: _processed)" << std::endl
+              << "  --list=<file>       Read more inputs from a file, one per line" << std::endl
+              << "  --threads=<n>       Files processed at once (default: all hardware threads)" << std::endl
+              << "  --memory=<MiB>      Decoded audio held in memory at once (default: 1024)" << std::endl
+              << "  --format=<format>   Output samples: pcm16, pcm24, pcm32 or float32 (default: as input)" << std::endl
+              << "  --direct-io         Write outputs past the page cache" << std::endl
+              << "  --quiet             Only report failures" << std::endl;
+  }
+}
+
+int main(int argc, char** argv) {
+  BatchProcessor::Options options;
+  std::string chain = "normalize";
+  std::vector<std::string> arguments;
+  bool quiet = false;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+
+    if (argument.rfind("--chain=", 0) == 0) chain = argument.substr(8);
+    else if (argument.rfind("--output=", 0) == 0) options.outputDirectory = argument.substr(9);
+    else if (argument.rfind("--suffix=", 0) == 0) options.suffix = argument.substr(9);
+    else if (argument.rfind("--threads=", 0) == 0) {
+      unsigned long long threads;
+
+      if (!parseCount(argument.substr(10), threads) || threads > SIZE_MAX) {
+        std::cerr << "Invalid --threads: " << argument.substr(10) << std::endl;
+        return 2;
+      }
+      options.threads = static_cast<size_t>(threads);
+    }
+    else if (argument.rfind("--memory=", 0) == 0) {
+      unsigned long long mebibytes;
+
+      if (!parseCount(argument.substr(9), mebibytes) || mebibytes > (UINT64_MAX >> 20)) {
+        std::cerr << "Invalid --memory: " << argument.substr(9) << std::endl;
+        return 2;
+      }
+      options.memoryBudget = static_cast<uint64_t>(mebibytes) << 20;
+    }
+    else if (argument == "--quiet") quiet = true;
+    else if (argument == "--direct-io") options.directIo = true;
+    else if (argument.rfind("--format=", 0) == 0) {
+      if (!parseFormat(argument.substr(9), options.format)) {
+        std::cerr << "Unknown --format: " << argument.substr(9) << std::endl;
+        return 2;
+      }
+      options.keepInputFormat = false;
+    }
+    else if (argument.rfind("--list=", 0) == 0) {
+      std::ifstream list(argument.substr(7));
+      std::string line;
+
+      if (!list) {
+        std::cerr << "Cannot read input list: " << argument.substr(7) << std::endl;
+        return 2;
+      }
+
+      while (std::getline(list, line)) {
+        if (!line.empty()) arguments.push_back(line);
+      }
+    }
+    else if (argument.rfind("--", 0) == 0) {
+      printUsage(argv[0]);
+      return 2;
+    }
+    else arguments.push_back(argument);
+  }
+
+  std::string error;
+
+  if (!BatchProcessor::parseChain(chain, options.steps, error)) {
+    std::cerr << "Invalid --chain: " << error << std::endl;
+    return 2;
+  }
+
+  std::vector<std::string> inputs = BatchProcessor::expandInputs(arguments);
+
+  if (inputs.empty()) {
+    printUsage(argv[0]);
+    return 2;
+  }
+
+  size_t finished = 0;
+  options.onFileDone = [&finished, &inputs, quiet](const BatchProcessor::Result& result) {
+    ++finished;
+
+    if (!result.success) {
+      std::cerr << "[" << finished << "/" << inputs.size() << "] FAILED " << result.input << ": "
+                << result.error << std::endl;
+    }
+    else if (!quiet) {
+      std::cout << "[" << finished << "/" << inputs.size() << "] " << result.input << " -> " << result.output
+                << " (" << std::fixed << std::setprecision(2) << result.seconds << " s)" << std::endl;
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  BatchProcessor processor(options);
+  std::vector<BatchProcessor::Result> results = processor.run(inputs);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  size_t failures = 0;
+  uint64_t frames = 0;
+
+  for (const auto& result : results) {
+    if (!result.success) ++failures;
+    frames += result.frames;
+  }
+
+  std::cout << results.size() - failures << " of " << results.size() << " files processed in "
+            << std::fixed << std::setprecision(2) << seconds << " s ("
+            << (seconds > 0.0 ? (results.size() - failures) / seconds * 3600.0 : 0.0) << " files/hour, "
+            << frames << " frames)" << std::endl;
+
+  return failures == 0 ? 0 : 1;
+}
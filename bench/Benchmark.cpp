@@ -0,0 +1,234 @@
+#include "Benchmark.h"
+#include "audio/CpuFeatures.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+  const double kDefaultMinSeconds = 0.5;
+  const uint64_t kMaxIterations = 1000000000;
+
+  std::string escapeJson(const std::string& text) {
+    std::string escaped;
+
+    for (char c : text) {
+      if (c == '"' || c == '\\') escaped += '\\';
+      escaped += c;
+    }
+    return escaped;
+  }
+
+  std::string formatTime(double ns) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(ns < 10.0 ? 2 : 0);
+
+    if (ns < 1e4) out << ns << " ns";
+    else if (ns < 1e7) out << ns / 1e3 << " us";
+    else out << ns / 1e6 << " ms";
+    return out.str();
+  }
+
+  std::string formatRate(double perSecond, const char* unit) {
+    const char* prefixes[] = { "", "k", "M", "G", "T" };
+    size_t prefix = 0;
+
+    while (perSecond >= 1000.0 && prefix < 4) {
+      perSecond /= 1000.0;
+      ++prefix;
+    }
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << perSecond << " " << prefixes[prefix] << unit;
+    return out.str();
+  }
+}
+
+BenchmarkState::BenchmarkState(uint64_t iterations)
+  : iterations_(iterations), remaining_(iterations), started_(false), running_(false),
+  cpuStart_(0), realSeconds_(0.0), cpuSeconds_(0.0),
+  bytesPerIteration_(0), itemsPerIteration_(0) {}
+
+bool BenchmarkState::keepRunning() {
+  if (!skipReason_.empty()) return false;
+
+  if (!started_) {
+    started_ = true;
+    startTimer();
+  }
+
+  if (remaining_ > 0) {
+    --remaining_;
+    return true;
+  }
+
+  if (running_) stopTimer();
+  return false;
+}
+
+void BenchmarkState::pauseTiming() {
+  if (running_) stopTimer();
+}
+
+void BenchmarkState::resumeTiming() {
+  if (!running_) startTimer();
+}
+
+void BenchmarkState::startTimer() {
+  running_ = true;
+  realStart_ = Clock::now();
+  cpuStart_ = std::clock();
+}
+
+void BenchmarkState::stopTimer() {
+  running_ = false;
+  realSeconds_ += std::chrono::duration<double>(Clock::now() - realStart_).count();
+  cpuSeconds_ += static_cast<double>(std::clock() - cpuStart_) / CLOCKS_PER_SEC;
+}
+
+void BenchmarkRunner::add(const std::string& name, Function function) {
+  entries_.push_back({ name, std::move(function) });
+}
+
+BenchmarkRunner::Result BenchmarkRunner::measure(const Entry& entry, double minSeconds) const {
+  uint64_t iterations = 1;
+
+  while (true) {
+    BenchmarkState state(iterations);
+    entry.function(state);
+
+    Result result = { entry.name, iterations, 0.0, 0.0, 0.0, 0.0, state.getSkipReason() };
+
+    if (!result.skipReason.empty()) return result;
+
+    double seconds = state.getRealSeconds();
+
+    if (seconds >= minSeconds || iterations >= kMaxIterations) {
+      result.realNs = seconds * 1e9 / iterations;
+      result.cpuNs = state.getCpuSeconds() * 1e9 / iterations;
+
+      if (seconds > 0.0) {
+        result.bytesPerSecond = state.getBytesPerIteration() * iterations / seconds;
+        result.itemsPerSecond = state.getItemsPerIteration() * iterations / seconds;
+      }
+      return result;
+    }
+
+    // Aim a little past the minimum, growing at most tenfold per attempt
+    double predicted = seconds > 0.0 ? iterations * minSeconds * 1.4 / seconds : iterations * 10.0;
+    predicted = std::min(predicted, iterations * 10.0);
+    iterations = std::min(kMaxIterations, std::max(iterations + 1, static_cast<uint64_t>(predicted)));
+  }
+}
+
+int BenchmarkRunner::run(int argc, char** argv) {
+  std::string filter;
+  std::string jsonPath;
+  double minSeconds = kDefaultMinSeconds;
+  bool listOnly = false;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+
+    if (argument.rfind("--filter=", 0) == 0) filter = argument.substr(9);
+    else if (argument.rfind("--json=", 0) == 0) jsonPath = argument.substr(7);
+    else if (argument.rfind("--min-time=", 0) == 0) minSeconds = std::stod(argument.substr(11));
+    else if (argument == "--list") listOnly = true;
+    else {
+      std::cerr << "Usage: " << argv[0] << " [--filter=<substring>] [--min-time=<seconds>] [--json=<path>] [--list]"
+                << std::endl;
+      return 2;
+    }
+  }
+
+  if (listOnly) {
+    for (const Entry& entry : entries_) {
+      if (filter.empty() || entry.name.find(filter) != std::string::npos) {
+        std::cout << entry.name << std::endl;
+      }
+    }
+    return 0;
+  }
+
+  std::vector<Result> results;
+
+#ifndef NDEBUG
+  std::cout << "***WARNING*** Benchmarks built without NDEBUG; timings are not representative" << std::endl;
+#endif
+  std::cout << "SIMD level: " << CpuFeatures::getLevelName(CpuFeatures::getActiveLevel())
+            << ", hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+  std::cout << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(14) << "Time"
+            << std::setw(14) << "CPU" << std::setw(12) << "Iterations" << "  Throughput" << std::endl;
+  std::cout << std::string(110, '-') << std::endl;
+
+  for (const Entry& entry : entries_) {
+    if (!filter.empty() && entry.name.find(filter) == std::string::npos) continue;
+
+    Result result = measure(entry, minSeconds);
+    std::cout << std::left << std::setw(48) << result.name << std::right;
+
+    if (!result.skipReason.empty()) {
+      std::cout << "  skipped: " << result.skipReason << std::endl;
+      continue;
+    }
+
+    std::cout << std::setw(14) << formatTime(result.realNs) << std::setw(14) << formatTime(result.cpuNs)
+              << std::setw(12) << result.iterations;
+
+    if (result.bytesPerSecond > 0.0) std::cout << "  " << formatRate(result.bytesPerSecond, "B/s");
+    if (result.itemsPerSecond > 0.0) std::cout << "  " << formatRate(result.itemsPerSecond, "items/s");
+    std::cout << std::endl;
+
+    results.push_back(result);
+  }
+
+  if (!jsonPath.empty() && !writeJson(jsonPath, results)) {
+    std::cerr << "Failed to write " << jsonPath << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+bool BenchmarkRunner::writeJson(const std::string& path, const std::vector<Result>& results) const {
+  std::ofstream out(path);
+
+  if (!out) return false;
+
+  char date[32];
+  std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+  out << std::setprecision(10);
+  out << "{\n  \"context\": {\n"
+      << "    \"date\": \"" << date << "\",\n"
+      << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+      << "    \"simd_level\": \"" << CpuFeatures::getLevelName(CpuFeatures::getActiveLevel()) << "\",\n"
+#ifdef NDEBUG
+      << "    \"library_build_type\": \"release\"\n"
+#else
+      << "    \"library_build_type\": \"debug\"\n"
+#endif
+      << "  },\n  \"benchmarks\": [";
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& result = results[i];
+
+    out << (i ? "," : "") << "\n    {\n"
+        << "      \"name\": \"" << escapeJson(result.name) << "\",\n"
+        << "      \"run_name\": \"" << escapeJson(result.name) << "\",\n"
+        << "      \"run_type\": \"iteration\",\n"
+        << "      \"iterations\": " << result.iterations << ",\n"
+        << "      \"real_time\": " << result.realNs << ",\n"
+        << "      \"cpu_time\": " << result.cpuNs << ",\n"
+        << "      \"time_unit\": \"ns\"";
+
+    if (result.bytesPerSecond > 0.0) out << ",\n      \"bytes_per_second\": " << result.bytesPerSecond;
+    if (result.itemsPerSecond > 0.0) out << ",\n      \"items_per_second\": " << result.itemsPerSecond;
+    out << "\n    }";
+  }
+
+  out << "\n  ]\n}\n";
+  return static_cast<bool>(out);
+}
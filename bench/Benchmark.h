@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Timing state handed to a benchmark body. The body loops while
+// keepRunning() returns true; setup done before the first call and cleanup
+// after the last one is not timed.
+class BenchmarkState {
+public:
+  explicit BenchmarkState(uint64_t iterations);
+
+  bool keepRunning();
+
+  // Exclude per-iteration setup from the measurement
+  void pauseTiming();
+  void resumeTiming();
+
+  // Work done per iteration, reported as throughput
+  void setBytesPerIteration(uint64_t bytes) { bytesPerIteration_ = bytes; }
+  void setItemsPerIteration(uint64_t items) { itemsPerIteration_ = items; }
+
+  // Skip the benchmark, e.g. when the CPU lacks the kernel under test
+  void skip(const std::string& reason) { skipReason_ = reason; }
+
+  uint64_t getIterations() const { return iterations_; }
+  uint64_t getBytesPerIteration() const { return bytesPerIteration_; }
+  uint64_t getItemsPerIteration() const { return itemsPerIteration_; }
+  const std::string& getSkipReason() const { return skipReason_; }
+  double getRealSeconds() const { return realSeconds_; }
+  double getCpuSeconds() const { return cpuSeconds_; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  void startTimer();
+  void stopTimer();
+
+  uint64_t iterations_;
+  uint64_t remaining_;
+  bool started_;
+  bool running_;
+  Clock::time_point realStart_;
+  std::clock_t cpuStart_;
+  double realSeconds_;
+  double cpuSeconds_;
+  uint64_t bytesPerIteration_;
+  uint64_t itemsPerIteration_;
+  std::string skipReason_;
+};
+
+// Minimal Google Benchmark style runner: each benchmark repeats with a
+// growing iteration count until it runs for at least the minimum time,
+// then reports time per iteration and throughput on the console and,
+// optionally, as Google Benchmark compatible JSON.
+class BenchmarkRunner {
+public:
+  using Function = std::function<void(BenchmarkState&)>;
+
+  void add(const std::string& name, Function function);
+
+  // Options: --filter=<substring> --min-time=<seconds> --json=<path> --list
+  int run(int argc, char** argv);
+
+private:
+  struct Entry {
+    std::string name;
+    Function function;
+  };
+
+  struct Result {
+    std::string name;
+    uint64_t iterations;
+    double realNs;
+    double cpuNs;
+    double bytesPerSecond;
+    double itemsPerSecond;
+    std::string skipReason;
+  };
+
+  Result measure(const Entry& entry, double minSeconds) const;
+  bool writeJson(const std::string& path, const std::vector<Result>& results) const;
+
+  std::vector<Entry> entries_;
+};
+
+// Keeps the compiler from discarding a value computed only for timing
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static const T* volatile sink;
+  sink = &value;
+#endif
+}
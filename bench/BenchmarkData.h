@@ -0,0 +1,95 @@
+#pragma once
+
+#include "audio/AudioBuffer.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Deterministic noise at roughly -6 dBFS, so runs compare like with like
+inline std::shared_ptr<AudioBuffer> makeNoiseBuffer(size_t frames, size_t channels,
+                                                    SampleLayout layout = SampleLayout::Interleaved,
+                                                    size_t sampleRate = 44100) {
+  auto buffer = std::make_shared<AudioBuffer>(sampleRate, channels, layout);
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+
+  buffer->resize(frames);
+
+  for (size_t frame = 0; frame < frames; ++frame) {
+    for (size_t channel = 0; channel < channels; ++channel) {
+      buffer->setSample(frame, channel, noise(random));
+    }
+  }
+  return buffer;
+}
+
+// A 16-bit PCM WAV file that is deleted again when the last user lets go
+class TemporaryWavFile {
+public:
+  TemporaryWavFile(const std::string& path, size_t frames, uint16_t channels) : path_(path) {
+    std::ofstream file(path, std::ios::binary);
+    std::mt19937 random(99);
+    std::uniform_int_distribution<int> noise(-16384, 16383);
+
+    uint32_t dataSize = static_cast<uint32_t>(frames * channels * sizeof(int16_t));
+    uint32_t sampleRate = 44100;
+    uint32_t byteRate = sampleRate * channels * sizeof(int16_t);
+    uint16_t blockAlign = static_cast<uint16_t>(channels * sizeof(int16_t));
+    uint16_t pcm = 1, bits = 16;
+    uint32_t riffSize = 36 + dataSize, fmtSize = 16;
+
+    file.write("RIFF", 4);
+    file.write(reinterpret_cast<const char*>(&riffSize), 4);
+    file.write("WAVEfmt ", 8);
+    file.write(reinterpret_cast<const char*>(&fmtSize), 4);
+    file.write(reinterpret_cast<const char*>(&pcm), 2);
+    file.write(reinterpret_cast<const char*>(&channels), 2);
+    file.write(reinterpret_cast<const char*>(&sampleRate), 4);
+    file.write(reinterpret_cast<const char*>(&byteRate), 4);
+    file.write(reinterpret_cast<const char*>(&blockAlign), 2);
+    file.write(reinterpret_cast<const char*>(&bits), 2);
+    file.write("data", 4);
+    file.write(reinterpret_cast<const char*>(&dataSize), 4);
+
+    std::vector<int16_t> samples(frames * channels);
+
+    for (auto& sample : samples) {
+      sample = static_cast<int16_t>(noise(random));
+    }
+    file.write(reinterpret_cast<const char*>(samples.data()), dataSize);
+
+    size_ = 44 + dataSize;
+  }
+
+  ~TemporaryWavFile() {
+    std::remove(path_.c_str());
+  }
+
+  TemporaryWavFile(const TemporaryWavFile&) = delete;
+  TemporaryWavFile& operator=(const TemporaryWavFile&) = delete;
+
+  const std::string& getPath() const { return path_; }
+  uint64_t getSize() const { return size_; }
+
+private:
+  std::string path_;
+  uint64_t size_;
+};
+
+// Silences std::cout for its lifetime, for code that reports progress
+class QuietOutput {
+public:
+  QuietOutput() : previous_(std::cout.rdbuf(nullptr)) {}
+  ~QuietOutput() { std::cout.rdbuf(previous_); }
+
+  QuietOutput(const QuietOutput&) = delete;
+  QuietOutput& operator=(const QuietOutput&) = delete;
+
+private:
+  std::streambuf* previous_;
+};
@@ -0,0 +1,82 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+#include "audio/CpuFeatures.h"
+#include "audio/ThreadPool.h"
+#include <string>
+
+namespace {
+  const size_t kBufferFrames = 1 << 20;
+  const size_t kBufferChannels = 2;
+  const uint64_t kBufferBytes = kBufferFrames * kBufferChannels * sizeof(float);
+
+  const SimdLevel kLevels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+
+  using Kernel = void (*)(AudioBuffer& buffer, const AudioBuffer& other, ThreadPool* pool, uint64_t iteration);
+
+  struct KernelCase {
+    const char* name;
+    Kernel kernel;
+  };
+
+  const KernelCase kKernels[] = {
+    { "Peak", [](AudioBuffer& buffer, const AudioBuffer&, ThreadPool* pool, uint64_t) {
+        doNotOptimize(buffer.getPeakAmplitude(pool));
+      } },
+    { "RMS", [](AudioBuffer& buffer, const AudioBuffer&, ThreadPool* pool, uint64_t) {
+        doNotOptimize(buffer.getRMSAmplitude(pool));
+      } },
+    { "DCOffset", [](AudioBuffer& buffer, const AudioBuffer&, ThreadPool* pool, uint64_t) {
+        doNotOptimize(buffer.getDCOffset(0, pool));
+      } },
+    { "ApplyGain", [](AudioBuffer& buffer, const AudioBuffer&, ThreadPool* pool, uint64_t iteration) {
+        // Alternate exact powers of two so the signal neither grows nor decays
+        buffer.applyGain(iteration % 2 ? 2.0f : 0.5f, pool);
+      } },
+    { "Mix", [](AudioBuffer& buffer, const AudioBuffer& other, ThreadPool* pool, uint64_t) {
+        buffer.mix(other, 0.5f, pool);
+      } },
+  };
+
+  void runKernel(BenchmarkState& state, Kernel kernel, SimdLevel level, ThreadPool* pool) {
+    if (level > CpuFeatures::getSupportedLevel()) {
+      state.skip(std::string(CpuFeatures::getLevelName(level)) + " not supported");
+      return;
+    }
+
+    std::shared_ptr<AudioBuffer> buffer = makeNoiseBuffer(kBufferFrames, kBufferChannels);
+    std::shared_ptr<AudioBuffer> other = makeNoiseBuffer(kBufferFrames, kBufferChannels);
+    uint64_t iteration = 0;
+
+    CpuFeatures::setLevelOverride(level);
+
+    while (state.keepRunning()) {
+      kernel(*buffer, *other, pool, iteration++);
+    }
+
+    CpuFeatures::clearLevelOverride();
+    state.setBytesPerIteration(kBufferBytes);
+  }
+}
+
+void registerAudioBufferBenchmarks(BenchmarkRunner& runner) {
+  auto pool = std::make_shared<ThreadPool>();
+
+  for (const KernelCase& kernelCase : kKernels) {
+    Kernel kernel = kernelCase.kernel;
+
+    for (SimdLevel level : kLevels) {
+      std::string name = std::string("AudioBuffer/") + kernelCase.name + "/" + CpuFeatures::getLevelName(level);
+
+      runner.add(name, [kernel, level](BenchmarkState& state) {
+        runKernel(state, kernel, level, nullptr);
+      });
+    }
+
+    std::string name = std::string("AudioBuffer/") + kernelCase.name + "/threads:" +
+                       std::to_string(pool->getThreadCount() + 1);
+
+    runner.add(name, [kernel, pool](BenchmarkState& state) {
+      runKernel(state, kernel, CpuFeatures::getSupportedLevel(), pool.get());
+    });
+  }
+}
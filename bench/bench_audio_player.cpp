@@ -0,0 +1,58 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+#include "audio/AudioPlayer.h"
+#include "audio/GainEffect.h"
+#include <string>
+#include <vector>
+
+namespace {
+  const size_t kChannels = 2;
+  const size_t kBufferFrames = 10 * 44100;
+  const size_t kBlockSizes[] = { 256, 1024 };
+
+  // Cost of one device callback, driven offline with the same code path
+  void runCallbacks(BenchmarkState& state, size_t frames, bool withEffects, SampleLayout layout) {
+    std::shared_ptr<AudioBuffer> buffer = makeNoiseBuffer(kBufferFrames, kChannels, layout);
+    std::vector<float> output(frames * kChannels);
+    AudioPlayer player;
+
+    QuietOutput quiet;
+    player.initializeOffline(44100, kChannels, frames);
+
+    if (withEffects) {
+      player.setEffects({ std::make_shared<GainEffect>(0.5f), std::make_shared<GainEffect>(1.5f) });
+    }
+
+    while (state.keepRunning()) {
+      if (!player.isPlaying()) {
+        state.pauseTiming();
+        player.play(buffer);
+        state.resumeTiming();
+      }
+
+      player.renderBlock(output.data(), frames);
+      doNotOptimize(output[0]);
+    }
+
+    player.shutdown();
+    state.setItemsPerIteration(frames);
+  }
+}
+
+void registerAudioPlayerBenchmarks(BenchmarkRunner& runner) {
+  for (size_t frames : kBlockSizes) {
+    std::string suffix = "/frames:" + std::to_string(frames);
+
+    runner.add("AudioPlayer/Callback" + suffix, [frames](BenchmarkState& state) {
+      runCallbacks(state, frames, false, SampleLayout::Interleaved);
+    });
+
+    runner.add("AudioPlayer/CallbackPlanar" + suffix, [frames](BenchmarkState& state) {
+      runCallbacks(state, frames, false, SampleLayout::Planar);
+    });
+
+    runner.add("AudioPlayer/CallbackWithEffects" + suffix, [frames](BenchmarkState& state) {
+      runCallbacks(state, frames, true, SampleLayout::Interleaved);
+    });
+  }
+}
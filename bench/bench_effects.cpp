@@ -0,0 +1,80 @@
+#include "Benchmark.h"
+#include "audio/EffectChain.h"
+#include "audio/GainEffect.h"
+#include "audio/ParallelEffects.h"
+#include "audio/ThreadPool.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+  const size_t kChannels = 2;
+  const size_t kBlockSizes[] = { 64, 512, 4096 };
+  const size_t kEffectCount = 4;
+
+  // Times processBlock on a fresh copy of the input each block. Processing
+  // the same block over and over would decay it into denormals, which are
+  // far slower and would swamp the measurement; the copy is cheap in
+  // comparison.
+  void runBlocks(BenchmarkState& state, AudioEffect& effect, size_t frames, bool automate) {
+    std::vector<float> input(frames * kChannels, 0.25f);
+    std::vector<float> block(frames * kChannels);
+    GainEffect* gain = dynamic_cast<GainEffect*>(&effect);
+    uint64_t iteration = 0;
+
+    effect.prepare(44100, frames, kChannels);
+
+    while (state.keepRunning()) {
+      // A new target every block keeps the gain ramping
+      if (automate && gain) gain->setGain(iteration++ % 2 ? 0.5f : 1.0f);
+
+      std::copy(input.begin(), input.end(), block.begin());
+      effect.processBlock(block.data(), frames);
+      doNotOptimize(block[0]);
+    }
+
+    state.setItemsPerIteration(frames);
+  }
+}
+
+void registerEffectBenchmarks(BenchmarkRunner& runner) {
+  auto pool = std::make_shared<ThreadPool>();
+
+  for (size_t frames : kBlockSizes) {
+    std::string suffix = "/frames:" + std::to_string(frames);
+
+    runner.add("GainEffect/Constant" + suffix, [frames](BenchmarkState& state) {
+      GainEffect effect(0.5f);
+      runBlocks(state, effect, frames, false);
+    });
+
+    runner.add("GainEffect/Ramp" + suffix, [frames](BenchmarkState& state) {
+      GainEffect effect(0.5f);
+      runBlocks(state, effect, frames, true);
+    });
+
+    runner.add("EffectChain/4xGain" + suffix, [frames](BenchmarkState& state) {
+      EffectChain chain;
+
+      for (size_t i = 0; i < kEffectCount; ++i) {
+        chain.addEffect(std::make_shared<GainEffect>(0.9f));
+      }
+      runBlocks(state, chain, frames, false);
+    });
+
+    for (bool threaded : { false, true }) {
+      std::string name = std::string("ParallelEffects/4xGain") + (threaded ? "/threaded" : "") + suffix;
+
+      runner.add(name, [frames, threaded, pool](BenchmarkState& state) {
+        ParallelEffects parallel(0.5f);
+
+        for (size_t i = 0; i < kEffectCount; ++i) {
+          parallel.addBranch(std::make_shared<GainEffect>(0.9f), 0.1f);
+        }
+        parallel.setThreadPool(threaded ? pool.get() : nullptr);
+        runBlocks(state, parallel, frames, false);
+      });
+    }
+  }
+}
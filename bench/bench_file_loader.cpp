@@ -0,0 +1,43 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+#include "audio/AudioFileLoader.h"
+
+namespace {
+  // One minute of 44.1 kHz stereo, about 10 MB. The file stays in the page
+  // cache after the first pass, so these measure parsing and conversion
+  // rather than the disk.
+  const size_t kFileFrames = 60 * 44100;
+
+  void loadFile(BenchmarkState& state, const TemporaryWavFile& file, AudioFileLoader::LoadMode mode, bool materialize) {
+    AudioFileLoader loader;
+    loader.setLoadMode(mode);
+    loader.setVerbose(false);
+
+    while (state.keepRunning()) {
+      AudioBuffer buffer;
+      loader.loadWavFile(file.getPath(), buffer);
+
+      if (materialize) buffer.materialize();
+      doNotOptimize(buffer.getFrameCount());
+    }
+  }
+}
+
+void registerFileLoaderBenchmarks(BenchmarkRunner& runner) {
+  auto file = std::make_shared<TemporaryWavFile>("bench_loader.wav", kFileFrames, 2);
+
+  runner.add("AudioFileLoader/Buffered", [file](BenchmarkState& state) {
+    loadFile(state, *file, AudioFileLoader::LoadMode::Buffered, false);
+    state.setBytesPerIteration(file->getSize());
+  });
+
+  // Opening only parses the header; samples are converted on demand
+  runner.add("AudioFileLoader/MappedOpen", [file](BenchmarkState& state) {
+    loadFile(state, *file, AudioFileLoader::LoadMode::Mapped, false);
+  });
+
+  runner.add("AudioFileLoader/MappedMaterialize", [file](BenchmarkState& state) {
+    loadFile(state, *file, AudioFileLoader::LoadMode::Mapped, true);
+    state.setBytesPerIteration(file->getSize());
+  });
+}
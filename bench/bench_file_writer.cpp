@@ -0,0 +1,50 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+#include "audio/AudioFileWriter.h"
+#include <cstdio>
+
+namespace {
+  // One minute of 44.1 kHz stereo, as for the loader benchmarks
+  const size_t kFileFrames = 60 * 44100;
+
+  const char* kOutputPath = "bench_writer.wav";
+
+  void writeFile(BenchmarkState& state, const AudioBuffer& buffer, SampleFormat format, bool dither, bool directIo) {
+    AudioFileWriter writer;
+    writer.setSampleFormat(format);
+    writer.setDither(dither);
+    writer.setDirectIo(directIo);
+
+    while (state.keepRunning()) {
+      doNotOptimize(writer.writeWavFile(kOutputPath, buffer));
+    }
+
+    state.setBytesPerIteration(buffer.getFrameCount() * buffer.getChannelCount() * SampleConversion::getBytesPerSample(format));
+    std::remove(kOutputPath);
+  }
+}
+
+void registerFileWriterBenchmarks(BenchmarkRunner& runner) {
+  auto buffer = makeNoiseBuffer(kFileFrames, 2);
+
+  runner.add("AudioFileWriter/PCM16", [buffer](BenchmarkState& state) {
+    writeFile(state, *buffer, SampleFormat::Int16, false, false);
+  });
+
+  runner.add("AudioFileWriter/PCM16Dither", [buffer](BenchmarkState& state) {
+    writeFile(state, *buffer, SampleFormat::Int16, true, false);
+  });
+
+  runner.add("AudioFileWriter/PCM24Dither", [buffer](BenchmarkState& state) {
+    writeFile(state, *buffer, SampleFormat::Int24, true, false);
+  });
+
+  runner.add("AudioFileWriter/Float32", [buffer](BenchmarkState& state) {
+    writeFile(state, *buffer, SampleFormat::Float32, false, false);
+  });
+
+  // Bypasses the page cache, so this one includes the disk
+  runner.add("AudioFileWriter/PCM24DirectIo", [buffer](BenchmarkState& state) {
+    writeFile(state, *buffer, SampleFormat::Int24, true, true);
+  });
+}
@@ -0,0 +1,23 @@
+#include "Benchmark.h"
+
+void registerFileLoaderBenchmarks(BenchmarkRunner& runner);
+void registerFileWriterBenchmarks(BenchmarkRunner& runner);
+void registerAudioBufferBenchmarks(BenchmarkRunner& runner);
+void registerResamplerBenchmarks(BenchmarkRunner& runner);
+void registerEffectBenchmarks(BenchmarkRunner& runner);
+void registerWaveformViewBenchmarks(BenchmarkRunner& runner);
+void registerAudioPlayerBenchmarks(BenchmarkRunner& runner);
+
+int main(int argc, char** argv) {
+  BenchmarkRunner runner;
+
+  registerFileLoaderBenchmarks(runner);
+  registerFileWriterBenchmarks(runner);
+  registerAudioBufferBenchmarks(runner);
+  registerResamplerBenchmarks(runner);
+  registerEffectBenchmarks(runner);
+  registerWaveformViewBenchmarks(runner);
+  registerAudioPlayerBenchmarks(runner);
+
+  return runner.run(argc, argv);
+}
@@ -0,0 +1,89 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+#include "audio/CpuFeatures.h"
+#include "audio/Resampler.h"
+#include "audio/ThreadPool.h"
+#include <string>
+#include <vector>
+
+namespace {
+  const size_t kChannels = 2;
+  const size_t kBlockFrames = 512;
+  const size_t kConvertFrames = 1 << 20;
+
+  const SimdLevel kLevels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+
+  const size_t kRates[][2] = { { 44100, 48000 }, { 48000, 44100 }, { 96000, 44100 } };
+
+  std::string getRateName(const size_t* rates) {
+    return std::to_string(rates[0]) + "to" + std::to_string(rates[1]);
+  }
+
+  // One playback block at a time, as in the audio callback
+  void runStreaming(BenchmarkState& state, const size_t* rates, SimdLevel level) {
+    if (level > CpuFeatures::getSupportedLevel()) {
+      state.skip(std::string(CpuFeatures::getLevelName(level)) + " not supported");
+      return;
+    }
+
+    CpuFeatures::setLevelOverride(level);
+
+    std::shared_ptr<AudioBuffer> input = makeNoiseBuffer(kConvertFrames, kChannels);
+    Resampler resampler(rates[0], rates[1], kChannels, kBlockFrames);
+    std::vector<float> output(kBlockFrames * kChannels);
+    const float* samples = input->getData();
+    size_t position = 0;
+
+    // Wraps around the input so the benchmark never runs dry
+    auto read = [&](float* dest, size_t frames) {
+      if (position + frames > kConvertFrames) position = 0;
+
+      std::copy(samples + position * kChannels, samples + (position + frames) * kChannels, dest);
+      position += frames;
+      return frames;
+    };
+
+    while (state.keepRunning()) {
+      resampler.pull(output.data(), kBlockFrames, read);
+      doNotOptimize(output.data());
+    }
+
+    CpuFeatures::clearLevelOverride();
+    state.setItemsPerIteration(kBlockFrames);
+  }
+
+  void runConvert(BenchmarkState& state, const size_t* rates, ThreadPool* pool) {
+    std::shared_ptr<AudioBuffer> input = makeNoiseBuffer(kConvertFrames, kChannels, SampleLayout::Interleaved, rates[0]);
+
+    while (state.keepRunning()) {
+      AudioBuffer output = Resampler::convert(*input, rates[1], pool);
+      doNotOptimize(output.getFrameCount());
+    }
+
+    state.setItemsPerIteration(kConvertFrames);
+  }
+}
+
+void registerResamplerBenchmarks(BenchmarkRunner& runner) {
+  auto pool = std::make_shared<ThreadPool>();
+
+  for (const auto& rates : kRates) {
+    const size_t* rate = rates;
+
+    for (SimdLevel level : kLevels) {
+      runner.add("Resampler/Stream/" + getRateName(rate) + "/" + CpuFeatures::getLevelName(level),
+                 [rate, level](BenchmarkState& state) {
+        runStreaming(state, rate, level);
+      });
+    }
+
+    runner.add("Resampler/Convert/" + getRateName(rate), [rate](BenchmarkState& state) {
+      runConvert(state, rate, nullptr);
+    });
+
+    runner.add("Resampler/Convert/" + getRateName(rate) + "/threads:" + std::to_string(pool->getThreadCount() + 1),
+               [rate, pool](BenchmarkState& state) {
+      runConvert(state, rate, pool.get());
+    });
+  }
+}
@@ -0,0 +1,41 @@
+#include "Benchmark.h"
+#include "BenchmarkData.h"
+#include "ui/WaveformView.h"
+#include <string>
+
+namespace {
+  // About 95 seconds of stereo; wide enough that every pyramid level is used
+  const size_t kBufferFrames = 1 << 22;
+
+  // Frames per pixel: below the pyramid's base bucket (raw scan), and at
+  // two pyramid levels
+  const size_t kFramesPerPixel[] = { 64, 1024, 16384 };
+
+  std::shared_ptr<AudioBuffer> getSharedBuffer() {
+    static std::shared_ptr<AudioBuffer> buffer = makeNoiseBuffer(kBufferFrames, 2);
+    return buffer;
+  }
+}
+
+void registerWaveformViewBenchmarks(BenchmarkRunner& runner) {
+  for (size_t framesPerPixel : kFramesPerPixel) {
+    int width = static_cast<int>(kBufferFrames / framesPerPixel);
+    std::string name = "WaveformView/Update/framesPerPixel:" + std::to_string(framesPerPixel);
+
+    runner.add(name, [width](BenchmarkState& state) {
+      std::shared_ptr<AudioBuffer> buffer = getSharedBuffer();
+      WaveformView view(0, 0, width, 300);
+      uint64_t iteration = 0;
+
+      view.setAudioBuffer(*buffer);
+
+      while (state.keepRunning()) {
+        // Any view change invalidates the per-pixel data
+        view.setZoom(iteration++ % 2 ? 1.0f : 2.0f);
+        view.updateWaveformData();
+      }
+
+      state.setItemsPerIteration(width);
+    });
+  }
+}
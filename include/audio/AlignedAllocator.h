@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+// Cache-line alignment for sample storage, which also satisfies every SIMD
+// load width the kernels use
+constexpr size_t kSampleAlignment = 64;
+
+// Standard allocator returning storage aligned to `Alignment` bytes, so
+// vectors of samples start on a cache line
+template <typename T, size_t Alignment = kSampleAlignment>
+class AlignedAllocator {
+public:
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() noexcept = default;
+
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+  T* allocate(size_t count) {
+    return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+  }
+
+  void deallocate(T* pointer, size_t) noexcept {
+    ::operator delete(pointer, std::align_val_t(Alignment));
+  }
+
+  friend bool operator==(const AlignedAllocator&, const AlignedAllocator&) { return true; }
+  friend bool operator!=(const AlignedAllocator&, const AlignedAllocator&) { return false; }
+};
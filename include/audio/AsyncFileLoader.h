@@ -0,0 +1,75 @@
+#pragma once
+
+#include "AudioBuffer.h"
+#include "AudioFileLoader.h"
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Loads a WAV file on a worker thread. start() reads the header and
+// allocates the whole buffer up front; the worker then converts the data
+// chunk into it block by block and publishes how many frames are ready, so
+// the loaded part can be drawn and played while the rest arrives.
+//
+// Frames below getLoadedFrames() are final. Frames above it are still being
+// written and must not be read, and the buffer must not be modified until
+// the load has ended.
+class AsyncFileLoader {
+public:
+  enum class State { Idle, Loading, Finished, Failed, Cancelled };
+
+  // Called on the worker thread after each block
+  using ProgressCallback = std::function<void(size_t loadedFrames, size_t totalFrames)>;
+
+  AsyncFileLoader();
+  ~AsyncFileLoader();
+
+  AsyncFileLoader(const AsyncFileLoader&) = delete;
+  AsyncFileLoader& operator=(const AsyncFileLoader&) = delete;
+
+  // Fails without disturbing the current load if the file cannot be opened
+  // or parsed; otherwise cancels the current load and starts this one
+  bool start(const std::string& filename, ProgressCallback progress = nullptr);
+
+  // Same, with the header already parsed (e.g. by AudioFileLoader::getWavInfo)
+  bool start(const std::string& filename, const WavInfo& info, ProgressCallback progress = nullptr);
+
+  // Stop the worker and wait for it. The frames loaded so far stay valid.
+  void cancel();
+
+  // Block until the worker has finished, failed or been cancelled
+  void wait();
+
+  State getState() const { return state_.load(std::memory_order_acquire); }
+  bool isLoading() const { return getState() == State::Loading; }
+
+  const std::string& getFilename() const { return filename_; }
+  const WavInfo& getInfo() const { return info_; }
+  std::shared_ptr<AudioBuffer> getBuffer() const { return buffer_; }
+
+  size_t getTotalFrames() const { return buffer_ ? buffer_->getFrameCount() : 0; }
+  size_t getLoadedFrames() const { return loadedFrames_ ? loadedFrames_->load(std::memory_order_acquire) : 0; }
+  float getProgress() const;
+
+  // Shared with consumers such as AudioPlayer so they can follow the load
+  // without holding on to the loader
+  std::shared_ptr<const std::atomic<size_t>> getLoadedFrameCounter() const { return loadedFrames_; }
+
+private:
+  // Fails if the file is shorter than the header claims
+  bool begin(std::unique_ptr<std::ifstream> file, const std::string& filename, const WavInfo& info,
+             ProgressCallback progress);
+  void run(std::unique_ptr<std::ifstream> file, float* output, ProgressCallback progress);
+
+  std::shared_ptr<AudioBuffer> buffer_;
+  std::shared_ptr<std::atomic<size_t>> loadedFrames_;
+  WavInfo info_;
+  std::string filename_;
+  std::atomic<State> state_;
+  std::atomic<bool> cancelRequested_;
+  std::thread worker_;
+};
@@ -1,14 +1,35 @@
 #pragma once
 
+#include "AlignedAllocator.h"
+#include "AudioBufferView.h"
+#include "SampleConversion.h"
 #include <vector>
 #include <cstdint>
 #include <memory>
 
+class MappedFile;
+class ThreadPool;
+
+// Interleaved keeps each frame's channels together, which is what the audio
+// device consumes. Planar keeps one aligned contiguous array per channel so
+// per-channel kernels run over unit-stride data.
+enum class SampleLayout {
+  Interleaved,
+  Planar
+};
+
+// Copies share their sample storage until one of them is modified
+// (copy-on-write), so handing a buffer from the loader to the player or an
+// effect costs a reference count rather than a second copy of the samples.
 class AudioBuffer {
 public:
-  AudioBuffer(size_t sampleRate = 44100, size_t channels = 2);
+  using SampleStorage = std::vector<float, AlignedAllocator<float>>;
+
+  AudioBuffer(size_t sampleRate = 44100, size_t channels = 2, SampleLayout layout = SampleLayout::Interleaved);
   AudioBuffer(const AudioBuffer& other);
+  AudioBuffer(AudioBuffer&& other) noexcept;
   AudioBuffer& operator=(const AudioBuffer& other);
+  AudioBuffer& operator=(AudioBuffer&& other) noexcept;
 
   // Buffer management
   void resize(size_t frames);
@@ -17,22 +38,77 @@ public:
   size_t getSampleRate() const;
   size_t getChannelCount() const;
 
+  // Sample layout of owned storage; mapped storage is always interleaved.
+  // setLayout rearranges the samples in place.
+  SampleLayout getLayout() const { return layout_; }
+  void setLayout(SampleLayout layout);
+
   // Audio data access
   float getSample(size_t frame, size_t channel) const;
   void setSample(size_t frame, size_t channel, float value);
 
-  // Audio operations
-  void normalize();
-  void applyGain(float gain);
-  void mix(const AudioBuffer& other, float mixLevel = 0.5f);
+  // Raw samples for bulk kernels, in the buffer's layout: planar channels
+  // start getChannelStride() samples apart, each on an aligned boundary. The
+  // mutable accessor converts mapped storage and detaches shared storage
+  // first, so the pointer is only valid until the buffer is next copied; the
+  // const accessor returns nullptr while mapped.
+  float* getData();
+  const float* getData() const;
+  size_t getChannelStride() const;
+
+  // Views over the same samples, following the getData() rules. They
+  // describe either layout, so copyFrames() converts to and from interleaved.
+  AudioBufferView getView();
+  ConstAudioBufferView getView() const;
+  AudioBufferView getView(size_t startFrame, size_t frames);
+  ConstAudioBufferView getView(size_t startFrame, size_t frames) const;
+
+  // Shared storage: true while another buffer references the same samples.
+  // makeUnique() takes a private copy up front, e.g. before handing the
+  // buffer's data pointer to another thread.
+  bool isShared() const;
+  void makeUnique();
+
+  // Mapped storage: interleaved samples of `format` referenced straight from
+  // a mapped file. Reads convert on the fly, so only touched pages become
+  // resident; the first modification converts everything into owned storage.
+  void attachMapped(std::shared_ptr<const MappedFile> file, const uint8_t* samples, size_t frames,
+                    SampleFormat format);
+  bool isMapped() const { return mappedSamples_ != nullptr; }
+  void materialize();
+
+  // Audio operations. These and the measurements below run SIMD kernels;
+  // with a pool, large buffers are also split across its threads.
+  void normalize(ThreadPool* pool = nullptr);
+  void applyGain(float gain, ThreadPool* pool = nullptr);
+  void mix(const AudioBuffer& other, float mixLevel = 0.5f, ThreadPool* pool = nullptr);
 
   // Utility
-  float getPeakAmplitude() const;
-  float getRMSAmplitude() const;
+  float getPeakAmplitude(ThreadPool* pool = nullptr) const;
+  float getRMSAmplitude(ThreadPool* pool = nullptr) const;
+
+  // Both of the above; mapped storage is converted once for the two
+  void getLevels(float& peak, float& rms, ThreadPool* pool = nullptr) const;
+  float getDCOffset(size_t channel, ThreadPool* pool = nullptr) const;
+
+  // Peak over RMS (linear); 0 for silence
+  float getCrestFactor(ThreadPool* pool = nullptr) const;
 
 private:
-  std::vector<float> data_;
+  float getMappedSample(size_t index) const;
+  void detachMapping();
+  SampleStorage& mutableData();
+  size_t getIndex(size_t frame, size_t channel) const;
+  std::shared_ptr<SampleStorage> makeStorage(SampleLayout layout, size_t frames, size_t& channelStride) const;
+
+  std::shared_ptr<SampleStorage> data_;
   size_t sampleRate_;
   size_t channels_;
   size_t frameCount_;
+  SampleLayout layout_;
+  size_t planarStride_;
+
+  std::shared_ptr<const MappedFile> mappedFile_;
+  const uint8_t* mappedSamples_;
+  SampleFormat mappedFormat_;
 };
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+// Non-owning window onto samples: a range of frames and a range of channels.
+// Sample (frame, channel) lives at data[frame * frameStride + channel *
+// channelStride], so the same view type covers interleaved storage
+// (frameStride = channels, channelStride = 1), planar storage
+// (frameStride = 1, channelStride = samples per channel) and channel subsets
+// of either without copying. Views never allocate and are cheap to pass by
+// value; the caller keeps the underlying storage alive.
+template <typename Sample>
+class BasicAudioBufferView {
+public:
+  BasicAudioBufferView() : data_(nullptr), frames_(0), channels_(0), frameStride_(0), channelStride_(0) {}
+
+  // Interleaved frames by default
+  BasicAudioBufferView(Sample* data, size_t frames, size_t channels, size_t frameStride = 0, size_t channelStride = 1)
+    : data_(data), frames_(frames), channels_(channels),
+    frameStride_(frameStride ? frameStride : channels), channelStride_(channelStride) {}
+
+  // One contiguous run of `channelStride` samples per channel
+  static BasicAudioBufferView planar(Sample* data, size_t frames, size_t channels, size_t channelStride) {
+    return BasicAudioBufferView(data, frames, channels, 1, channelStride);
+  }
+
+  // A mutable view converts implicitly to a read-only one
+  template <typename Other, typename = typename std::enable_if<std::is_same<const Other, Sample>::value>::type>
+  BasicAudioBufferView(const BasicAudioBufferView<Other>& other)
+    : data_(other.getData()), frames_(other.getFrameCount()), channels_(other.getChannelCount()),
+    frameStride_(other.getFrameStride()), channelStride_(other.getChannelStride()) {}
+
+  Sample* getData() const { return data_; }
+  size_t getFrameCount() const { return frames_; }
+  size_t getChannelCount() const { return channels_; }
+  size_t getFrameStride() const { return frameStride_; }
+  size_t getChannelStride() const { return channelStride_; }
+
+  bool isEmpty() const { return frames_ == 0 || channels_ == 0; }
+
+  // Frames packed back to back, so the view can be handed to block kernels
+  // as a plain interleaved array
+  bool isContiguous() const { return frameStride_ == channels_ && (channelStride_ == 1 || channels_ == 1); }
+
+  // Each channel is a contiguous run of samples
+  bool isPlanar() const { return frameStride_ == 1; }
+
+  Sample& at(size_t frame, size_t channel) const {
+    return data_[frame * frameStride_ + channel * channelStride_];
+  }
+
+  // First sample of `channel`; with a planar view the channel's samples follow it
+  Sample* getChannelData(size_t channel) const { return data_ + channel * channelStride_; }
+
+  // Frames [startFrame, startFrame + frames), clamped to this view
+  BasicAudioBufferView getFrames(size_t startFrame, size_t frames) const {
+    startFrame = std::min(startFrame, frames_);
+    frames = std::min(frames, frames_ - startFrame);
+    return BasicAudioBufferView(data_ + startFrame * frameStride_, frames, channels_, frameStride_, channelStride_);
+  }
+
+  // Channels [firstChannel, firstChannel + channels), clamped to this view
+  BasicAudioBufferView getChannels(size_t firstChannel, size_t channels) const {
+    firstChannel = std::min(firstChannel, channels_);
+    channels = std::min(channels, channels_ - firstChannel);
+    return BasicAudioBufferView(data_ + firstChannel * channelStride_, frames_, channels, frameStride_, channelStride_);
+  }
+
+  BasicAudioBufferView getChannel(size_t channel) const { return getChannels(channel, 1); }
+
+private:
+  Sample* data_;
+  size_t frames_;
+  size_t channels_;
+  size_t frameStride_;
+  size_t channelStride_;
+};
+
+using AudioBufferView = BasicAudioBufferView<float>;
+using ConstAudioBufferView = BasicAudioBufferView<const float>;
+
+// Copies the overlapping frames and channels of `source` into `destination`,
+// scaled by `gain` and converting between layouts on the way. Packed
+// interleaved pairs are a single pass; everything else walks one channel at
+// a time so planar sides are read or written sequentially.
+inline void copyFrames(ConstAudioBufferView source, AudioBufferView destination, float gain = 1.0f) {
+  size_t frames = std::min(source.getFrameCount(), destination.getFrameCount());
+  size_t channels = std::min(source.getChannelCount(), destination.getChannelCount());
+
+  if (frames == 0 || channels == 0) return;
+
+  if (source.isContiguous() && destination.isContiguous() &&
+      source.getChannelCount() == destination.getChannelCount()) {
+    const float* input = source.getData();
+    float* output = destination.getData();
+    size_t count = frames * channels;
+
+    if (gain == 1.0f) {
+      std::memcpy(output, input, count * sizeof(float));
+      return;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      output[i] = input[i] * gain;
+    }
+    return;
+  }
+
+  for (size_t channel = 0; channel < channels; ++channel) {
+    const float* input = source.getChannelData(channel);
+    float* output = destination.getChannelData(channel);
+    size_t inputStride = source.getFrameStride();
+    size_t outputStride = destination.getFrameStride();
+
+    for (size_t frame = 0; frame < frames; ++frame) {
+      output[frame * outputStride] = input[frame * inputStride] * gain;
+    }
+  }
+}
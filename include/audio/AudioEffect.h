@@ -1,12 +1,23 @@
 #pragma once
 
 #include "AudioBuffer.h"
+#include <atomic>
+#include <cstddef>
 
 class AudioEffect {
 public:
   virtual ~AudioEffect() = default;
 
-  virtual void process(AudioBuffer& buffer) = 0;
+  // Called off the audio thread before processing starts and whenever the
+  // stream format changes. May allocate; processBlock() must not.
+  virtual void prepare(size_t sampleRate, size_t maxBlockFrames, size_t channels);
+
+  // Process `frames` interleaved frames in place, frames <= maxBlockFrames.
+  // Runs on the audio thread: no allocation, locking or blocking I/O.
+  virtual void processBlock(float* samples, size_t frames) = 0;
+
+  // Offline processing of a whole buffer in consecutive blocks
+  virtual void process(AudioBuffer& buffer);
 
   void setEnabled(bool enabled) { enabled_ = enabled; }
   bool isEnabled() const { return enabled_; }
@@ -14,5 +25,9 @@ public:
   virtual const char* getName() const = 0;
 
 protected:
-  bool enabled_ = true;
-};
\ No newline at end of file
+  std::atomic<bool> enabled_{ true };
+
+  size_t sampleRate_ = 44100;
+  size_t maxBlockFrames_ = 0;
+  size_t channels_ = 2;
+};
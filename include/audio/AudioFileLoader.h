@@ -1,23 +1,86 @@
 #pragma once
 
 #include "AudioBuffer.h"
+#include "SampleConversion.h"
+#include "WavChunkIndex.h"
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
 #include <string>
+#include <utility>
+
+class ThreadPool;
+class WavIndexCache;
 
 class AudioFileLoader {
 public:
+    enum class LoadMode {
+        Buffered,   // Read and convert the data chunk into owned storage
+        Mapped      // Map the file and let the buffer reference its pages
+    };
+
     AudioFileLoader();
-    
+
     // Load audio file into buffer
     bool loadWavFile(const std::string& filename, AudioBuffer& buffer);
-    
+
     // Check if file can be loaded
     bool canLoadFile(const std::string& filename) const;
-    
+
     // Get file info without loading
     bool getFileInfo(const std::string& filename, int& sampleRate, int& channels, int& frameCount) const;
+    bool getWavInfo(const std::string& filename, WavInfo& info) const;
+
+    // Chunk locations from one pass over the file, or from the cache
+    bool getChunkIndex(const std::string& filename, WavChunkIndex& index) const;
+
+    // Share parsed headers between loaders: files seen before, and not
+    // changed since, are neither opened nor parsed again for their info
+    void setIndexCache(std::shared_ptr<WavIndexCache> cache) { indexCache_ = std::move(cache); }
+    const std::shared_ptr<WavIndexCache>& getIndexCache() const { return indexCache_; }
+
+    // Loading strategy
+    void setLoadMode(LoadMode mode) { loadMode_ = mode; }
+    LoadMode getLoadMode() const { return loadMode_; }
+
+    // Progress messages on stdout for each load; errors are always reported
+    void setVerbose(bool verbose) { verbose_ = verbose; }
+
+    // Convert loaded files to this rate (0 keeps the file's rate). The
+    // conversion is split across the pool's threads when one is given, and
+    // replaces mapped storage with owned samples.
+    void setTargetSampleRate(size_t sampleRate, ThreadPool* pool = nullptr) {
+        targetSampleRate_ = sampleRate;
+        resamplePool_ = pool;
+    }
+    size_t getTargetSampleRate() const { return targetSampleRate_; }
+
+    using ReadAtFunction = WavChunkIndex::ReadAtFunction;
+
+    // Walk the RIFF chunk list once and fill in the format and data location.
+    // Accepts 16-, 24- and 32-bit PCM and 32-bit float, with plain or
+    // WAVE_FORMAT_EXTENSIBLE format chunks, in RIFF, RF64 or BW64 files.
+    static bool parseWavChunks(const ReadAtFunction& readAt, WavInfo& info);
+    static bool parseWavChunks(std::istream& file, WavInfo& info);
+
+    // Whether a file of `fileSize` bytes holds the whole data chunk `info`
+    // describes. The header's sizes are not trusted (an RF64 ds64 chunk may
+    // claim terabytes), so loaders check before allocating for the samples.
+    static bool checkDataSize(const WavInfo& info, uint64_t fileSize);
+    static bool checkDataSize(const WavInfo& info, std::istream& file);
 
 private:
     // WAV file structure helpers
-    bool readWavHeader(const std::string& filename, int& sampleRate, int& channels, int& frameCount) const;
-    bool readWavData(const std::string& filename, AudioBuffer& buffer) const;
-}; 
\ No newline at end of file
+    bool findIndex(const std::string& filename, WavChunkIndex& index) const;
+    void rememberIndex(const std::string& filename, const WavChunkIndex& index) const;
+    bool loadBuffered(const std::string& filename, AudioBuffer& buffer) const;
+    bool loadMapped(const std::string& filename, AudioBuffer& buffer) const;
+    bool readWavData(std::istream& file, const WavInfo& info, AudioBuffer& buffer) const;
+
+    LoadMode loadMode_;
+    bool verbose_;
+    size_t targetSampleRate_;
+    ThreadPool* resamplePool_;
+    std::shared_ptr<WavIndexCache> indexCache_;
+};
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "AlignedAllocator.h"
+#include "AudioBuffer.h"
+#include "SampleConversion.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Writes WAV files from float samples, either a whole AudioBuffer at once or
+// streamed with open()/write()/close() while a render is still running.
+// Samples are clipped to full scale, converted with the SampleConversion
+// kernels into one large aligned buffer and written a full buffer at a time.
+//
+// The header reserves a JUNK chunk ahead of "fmt ". If the data grows past
+// the 4 GiB RIFF limit, close() turns the file into RF64 (EBU Tech 3306,
+// also read as BW64) by rewriting that chunk as "ds64", so the final size
+// never has to be known up front.
+class AudioFileWriter {
+public:
+  AudioFileWriter();
+  ~AudioFileWriter();
+
+  AudioFileWriter(const AudioFileWriter&) = delete;
+  AudioFileWriter& operator=(const AudioFileWriter&) = delete;
+
+  // Settings take effect at the next open()
+  void setSampleFormat(SampleFormat format) { format_ = format; }
+  SampleFormat getSampleFormat() const { return format_; }
+
+  // TPDF dither before 16- and 24-bit quantization (on by default)
+  void setDither(bool dither) { dither_ = dither; }
+  bool getDither() const { return dither_; }
+
+  // Bytes converted between writes, rounded up to whole 4 KiB blocks
+  void setBufferSize(size_t bytes);
+  size_t getBufferSize() const { return bufferSize_; }
+
+  // Bypass the page cache (O_DIRECT, or F_NOCACHE on macOS) so long renders
+  // do not evict everything else from memory. Falls back to buffered writes
+  // where the platform or filesystem does not support it.
+  void setDirectIo(bool direct) { directIo_ = direct; }
+  bool getDirectIo() const { return directIo_; }
+
+  // Streaming
+  bool open(const std::string& filename, size_t sampleRate, size_t channels);
+  bool write(const float* samples, size_t frames);    // Interleaved frames
+  bool write(ConstAudioBufferView frames);
+  bool close();                                        // Flushes and fills in the header sizes
+  bool isOpen() const { return open_; }
+
+  uint64_t getFramesWritten() const { return framesWritten_; }
+
+  // Whether the last file written needed RF64; known after close()
+  bool isRF64() const { return rf64_; }
+
+  // open(), write() and close() for a whole buffer, in either layout
+  bool writeWavFile(const std::string& filename, const AudioBuffer& buffer);
+
+  // Header for the open file holding `dataSize` bytes of samples, as
+  // close() writes it; RF64 once the sizes no longer fit in 32 bits
+  std::vector<uint8_t> buildHeader(uint64_t dataSize) const;
+
+private:
+  bool writeBlocks();      // Writes the whole 4 KiB blocks of the buffer
+  bool fail(const char* message);
+
+  // Platform file access
+  bool openFile(const std::string& filename);
+  bool writeAt(uint64_t offset, const uint8_t* data, size_t bytes);
+  void disableDirectIo();
+  bool closeFile();
+
+  SampleFormat format_;
+  bool dither_;
+  bool directIo_;
+  size_t bufferSize_;
+
+  // Current file
+  std::string filename_;
+  size_t sampleRate_;
+  size_t channels_;
+  size_t headerBytes_;
+  uint64_t framesWritten_;
+  uint64_t fileOffset_;     // Where buffer_[0] goes in the file
+  bool open_;
+  bool rf64_;
+  bool failed_;
+
+  // Encoded bytes waiting to be written, with room for one partial block
+  // carried over between writes
+  std::vector<uint8_t, AlignedAllocator<uint8_t, 4096>> buffer_;
+  size_t buffered_;
+
+  // Interleaved floats being dithered and converted
+  std::vector<float, AlignedAllocator<float>> staging_;
+  SampleConversion::DitherState ditherState_;
+
+#ifdef _WIN32
+  void* fileHandle_;
+#else
+  int fd_;
+#endif
+};
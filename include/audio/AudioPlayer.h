@@ -1,27 +1,82 @@
 #pragma once
 
 #include "AudioBuffer.h"
+#include "AudioEffect.h"
+#include "CallbackStats.h"
+#include "ChannelMixer.h"
+#include "Resampler.h"
+#include "SampleConversion.h"
+#include "SpscQueue.h"
+#include "StreamPrefetcher.h"
+#include "WavStreamReader.h"
 #include <SDL2/SDL.h>
 #include <atomic>
+#include <memory>
+#include <string>
 #include <vector>
 
+// Plays an AudioBuffer or WavStreamReader through an SDL audio device.
+// Control methods are called from one UI thread and only enqueue commands;
+// the audio callback applies them at the top of each block, so the
+// real-time path never takes a lock and never frees a source.
 class AudioPlayer {
 public:
+    // Requested device format. SDL may change anything named in
+    // allowedChanges; the player then adapts to the format it actually got.
+    struct DeviceConfig {
+        int sampleRate = 44100;
+        int channels = 2;
+        size_t periodFrames = 1024;         // Rounded up to a power of two
+        SDL_AudioFormat format = AUDIO_F32;
+        int allowedChanges = 0;             // SDL_AUDIO_ALLOW_* flags
+        std::string deviceName;             // Empty for the system default
+
+        // Short periods without SDL rebuffering or format conversion in
+        // between. The sample rate stays fixed so sources play at pitch.
+        static DeviceConfig lowLatency(size_t periodFrames = 128);
+    };
+
+    static constexpr size_t kMinLowLatencyFrames = 64;
+    static constexpr size_t kMaxLowLatencyFrames = 256;
+
     AudioPlayer();
     ~AudioPlayer();
     
-    // Audio device management
+    // Audio device management. Reinitializing reopens the device and
+    // prepares the current effects for the new format.
     bool initialize(int sampleRate = 44100, int channels = 2);
+    bool initialize(const DeviceConfig& config);
     void shutdown();
+
+    static std::vector<std::string> getOutputDevices();
+
+    // Format the device was actually opened with
+    int getSampleRate() const { return sampleRate_; }
+    int getChannels() const { return channels_; }
+    size_t getPeriodFrames() const { return blockFrames_; }
+    SDL_AudioFormat getDeviceFormat() const { return format_; }
+    double getPeriodLatency() const; // Seconds of audio per callback
+
+    // Offline mode opens no device: renderBlock() runs the callback path on
+    // the calling thread, e.g. to render to a file or to time one block
+    void initializeOffline(int sampleRate = 44100, int channels = 2, size_t blockFrames = 1024);
+    void renderBlock(float* output, size_t frames);
+    bool isOffline() const { return offline_; }
     
-    // Playback control
+    // Playback control. Shared sources stay alive until the audio thread has
+    // swapped them out; plain references must outlive their playback.
+    void play(std::shared_ptr<const AudioBuffer> buffer);
+    void play(std::shared_ptr<const AudioBuffer> buffer, std::shared_ptr<const std::atomic<size_t>> loadedFrames);
+    void play(std::shared_ptr<WavStreamReader> stream);
     void play(const AudioBuffer& buffer);
+    void play(WavStreamReader& stream);
     void pause();
     void resume();
     void stop();
+    void seek(size_t frame);
     
     // Playback state
-    bool isPlaying() const { return playing_; }
+    bool isPlaying() const;
     bool isPaused() const { return paused_; }
     float getPlaybackPosition() const; // 0.0 to 1.0
     float getDuration() const { return duration_; }
@@ -30,26 +85,147 @@ public:
     void setVolume(float volume); // 0.0 to 1.0
     float getVolume() const { return volume_; }
     
-    // Audio buffer management
+    // Audio buffer management. Swapping the buffer during playback keeps the
+    // current position, so an edited copy can replace the playing one.
+    void setAudioBuffer(std::shared_ptr<const AudioBuffer> buffer);
     void setAudioBuffer(const AudioBuffer& buffer);
-    const AudioBuffer* getAudioBuffer() const { return audioBuffer_; }
+    const AudioBuffer* getAudioBuffer() const { return uiSource_.buffer.get(); }
+
+    // Buffer a background load is still filling (see AsyncFileLoader):
+    // playback reads only frames below loadedFrames, and waits there in
+    // silence instead of ending if it catches up with the load
+    void setAudioBuffer(std::shared_ptr<const AudioBuffer> buffer,
+                        std::shared_ptr<const std::atomic<size_t>> loadedFrames);
+
+    // Streaming source: a StreamPrefetcher opens the reader's file again and
+    // reads ahead on its own thread, so the audio callback only copies frames
+    // that are already in memory and plays silence if the disk falls behind.
+    // Offline rendering waits for the frames instead.
+    void setAudioStream(std::shared_ptr<WavStreamReader> stream);
+    void setAudioStream(WavStreamReader& stream);
+    bool isStreaming() const { return uiSource_.stream != nullptr; }
+
+    // Sources whose sample rate differs from the device are converted while
+    // playing. Takes effect for the next source.
+    void setResamplerQuality(Resampler::Quality quality) { resamplerQuality_ = quality; }
+    bool isResampling() const { return uiSource_.resampler != nullptr; }
+
+    // Sources with another channel count than the device are mixed with the
+    // default matrix, or with this one when its channel counts match the
+    // source and device. Pass nullptr to go back to the default.
+    void setChannelMixer(std::shared_ptr<const ChannelMixer> mixer);
+    const ChannelMixer* getChannelMixer() const { return uiSource_.mixer.get(); }
+
+    // Effects run in order on every callback block. They are prepared for
+    // the device format here, then swapped in by the audio thread. An
+    // effect is prepared only the first time it is passed in after the
+    // device opens: passing it again, e.g. to reorder the list while it
+    // plays, leaves its state alone since the audio thread may be running it.
+    using EffectList = std::vector<std::shared_ptr<AudioEffect>>;
+    void setEffects(EffectList effects);
+
+    // Release sources and effect lists the audio thread has swapped out.
+    // Called by every control method; call it periodically (e.g. once per
+    // UI frame) too.
+    void collectRetiredSources();
+
+    // Callback timing against the buffer period, readable from any thread.
+    // Counters restart whenever the device is (re)opened.
+    const CallbackStats& getCallbackStats() const { return stats_; }
+    void resetCallbackStats();
+
+    // Write a timing report to this file when the device is shut down
+    void setCallbackStatsReport(const std::string& filename) { statsReportFile_ = filename; }
 
 private:
+    // Sources at another rate or channel count than the device play
+    // through a resampler and a channel mixer
+    struct Source {
+        std::shared_ptr<const AudioBuffer> buffer;
+        std::shared_ptr<WavStreamReader> stream;
+        std::shared_ptr<StreamPrefetcher> prefetcher;   // Reads `stream`'s file ahead
+        std::shared_ptr<Resampler> resampler;
+        std::shared_ptr<const ChannelMixer> mixer;
+        std::shared_ptr<const std::atomic<size_t>> loadedFrames;
+    };
+
+    struct Command {
+        enum class Type { None, SetSource, SetEffects, Play, Pause, Resume, Stop, Seek, SetVolume };
+
+        Type type = Type::None;
+        Source source;
+        std::shared_ptr<const EffectList> effects;
+        size_t frame = 0;
+        float volume = 0.0f;
+        uint32_t generation = 0;
+    };
+
+    // Objects the audio thread has let go of, released on the UI thread
+    struct Retired {
+        Source source;
+        std::shared_ptr<const EffectList> effects;
+    };
+
+    static const size_t kCommandCapacity = 64;
+
     static void audioCallback(void* userdata, Uint8* stream, int len);
     void fillAudioBuffer(Uint8* stream, int len);
+    void renderFrames(float* output, size_t frames);
+    size_t readSource(float* output, size_t frames);
+    size_t readResampled(float* output, size_t frames, size_t channelCount);
+    void processCommands();
+    size_t fillFromBuffer(float* output, size_t frames, size_t channelCount);
+    size_t fillFromStream(float* output, size_t frames, size_t channelCount);
+    void startPlayback();
+    void setSource(Source source);
+    void resetResampler();
+    void seekStream();
+    void sendSource();
+    void retire(Retired retired);
+    bool sendCommand(Command command);
     
     SDL_AudioDeviceID deviceId_;
-    const AudioBuffer* audioBuffer_;
-    
-    std::atomic<bool> playing_;
-    std::atomic<bool> paused_;
-    std::atomic<size_t> currentFrame_;
-    
+    bool offline_;
+
+    // UI thread state
+    Source uiSource_;
+    EffectList uiEffects_;
+    std::vector<std::weak_ptr<AudioEffect>> uiPreparedEffects_;
+    Resampler::Quality resamplerQuality_;
+    std::shared_ptr<const ChannelMixer> uiChannelMixer_;
+    size_t sourceFrameCount_;
+    uint32_t playGeneration_;
+    bool playing_;
+    bool paused_;
     float volume_;
     float duration_;
+
+    // Audio thread state, only touched inside the callback
+    Source rtSource_;
+    std::shared_ptr<const EffectList> rtEffects_;
+    bool rtPlaying_;
+    bool rtPaused_;
+    float rtVolume_;
+    uint32_t rtGeneration_;
+    uint64_t rtLastCallbackStart_;
+
+    // Preallocated per device format: float blocks for devices that take
+    // another sample format, and source frames whose channel count differs
+    std::vector<float> rtDeviceBlock_;
+    std::vector<float> rtSourceBlock_;
+
+    // Shared between the two threads
+    SpscQueue<Command, kCommandCapacity> commands_;
+    SpscQueue<Retired, 2 * kCommandCapacity> retired_;
+    std::atomic<size_t> currentFrame_;
+    std::atomic<uint32_t> finishedGeneration_;
+    CallbackStats stats_;
+    std::string statsReportFile_;
     
     // Audio format
     int sampleRate_;
     int channels_;
+    size_t blockFrames_;
     SDL_AudioFormat format_;
+    SampleFormat deviceSampleFormat_;
 }; 
\ No newline at end of file
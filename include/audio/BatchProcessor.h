@@ -0,0 +1,87 @@
+#pragma once
+
+#include "AudioBuffer.h"
+#include "SampleConversion.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class WavIndexCache;
+
+// Runs one effect chain over many WAV files without a window or audio
+// device. Files are spread over a ThreadPool, largest first, and a memory
+// budget bounds the decoded buffers alive at once, so batch size never
+// changes peak memory. Results are written next to a temporary name and
+// renamed, so a crashed or failed run never leaves half-written outputs.
+class BatchProcessor {
+public:
+  // One step of the chain, applied to the whole file
+  struct Step {
+    enum class Type { Gain, Normalize };
+
+    Type type = Type::Gain;
+    float value = 1.0f;     // Linear gain, or the peak level Normalize scales to
+  };
+
+  struct Result {
+    std::string input;
+    std::string output;
+    bool success = false;
+    std::string error;
+    uint64_t frames = 0;
+    double seconds = 0.0;
+  };
+
+  struct Options {
+    std::vector<Step> steps;
+    std::string outputDirectory;        // Empty writes next to each input
+    std::string suffix = "_processed";  // Appended to each output's file name
+    size_t threads = 0;                 // 0 uses every hardware thread
+    uint64_t memoryBudget = 1ULL << 30; // Bytes of decoded audio in flight
+    bool keepInputFormat = true;        // Write each output in its input's sample format...
+    SampleFormat format = SampleFormat::Int16;  // ...or in this one
+    bool directIo = false;              // See AudioFileWriter::setDirectIo()
+
+    // Called once per file as it finishes, one call at a time
+    std::function<void(const Result&)> onFileDone;
+  };
+
+  explicit BatchProcessor(Options options);
+
+  // Comma-separated steps: "gain=0.5", "gain=-6dB", "normalize" (to full
+  // scale) or "normalize=-1dB". Returns false and describes the first bad
+  // step in `error`.
+  static bool parseChain(const std::string& spec, std::vector<Step>& steps, std::string& error);
+
+  // Expand plain files, directories (every .wav below them) and patterns
+  // with * and ? in the file name, e.g. "takes/*.wav". The result is sorted
+  // and free of duplicates; patterns that match nothing are skipped.
+  static std::vector<std::string> expandInputs(const std::vector<std::string>& arguments);
+
+  std::string getOutputPath(const std::string& input) const;
+
+  // Process every input; results are in input order
+  std::vector<Result> run(const std::vector<std::string>& inputs);
+
+  // Apply the chain to a buffer in memory
+  void apply(AudioBuffer& buffer) const;
+
+private:
+  void processFile(Result& result);
+  void acquireMemory(uint64_t bytes);
+  void releaseMemory(uint64_t bytes);
+
+  Options options_;
+  std::shared_ptr<WavIndexCache> indexCache_;   // Header read for the info is reused by the load
+
+  std::mutex memoryMutex_;
+  std::condition_variable memoryAvailable_;
+  uint64_t memoryInFlight_;
+
+  std::mutex reportMutex_;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+// Timing of the audio callback against its deadline. The audio thread is the
+// only writer and updates plain relaxed atomics, so recording never blocks;
+// any other thread can take a snapshot at any time. Counters taken while a
+// callback is recording may be off by that one callback.
+class CallbackStats {
+public:
+  // Durations are bucketed as a fraction of the buffer period: each bucket
+  // covers 1/kBucketsPerPeriod of it, the last one everything beyond
+  static const size_t kBucketsPerPeriod = 20;
+  static const size_t kBucketCount = 2 * kBucketsPerPeriod + 1;
+
+  // A callback starting this many periods after the previous one means the
+  // device ran dry in between. After an overrun that gap is the overrun
+  // itself, so it is not counted again as a late callback.
+  static constexpr double kLateCallbackPeriods = 1.5;
+
+  struct Snapshot {
+    uint64_t periodNs = 0;
+    uint64_t callbacks = 0;
+    uint64_t overruns = 0;       // callback took longer than the period
+    uint64_t lateCallbacks = 0;  // callback started too late, not after an overrun
+    uint64_t totalDurationNs = 0;
+    uint64_t maxDurationNs = 0;
+    uint64_t maxIntervalNs = 0;
+    std::array<uint64_t, kBucketCount> histogram{};
+
+    // Each dropout once: the two counters never count the same one
+    uint64_t getXruns() const { return overruns + lateCallbacks; }
+
+    // Loads are durations divided by the period; headroom is 1 - load
+    double getAverageLoad() const;
+    double getMaxLoad() const;
+    double getMinHeadroom() const { return 1.0 - getMaxLoad(); }
+
+    // Upper bound of the bucket holding the given percentile (0 to 100)
+    double getLoadPercentile(double percentile) const;
+
+    void write(std::ostream& out) const;
+  };
+
+  CallbackStats();
+
+  CallbackStats(const CallbackStats&) = delete;
+  CallbackStats& operator=(const CallbackStats&) = delete;
+
+  // Clears every counter and sets the deadline for later callbacks
+  void reset(uint64_t periodNs);
+  void reset(size_t blockFrames, int sampleRate);
+
+  // Audio thread. intervalNs is the time since the previous callback
+  // started, or 0 when unknown (first callback, offline rendering).
+  void record(uint64_t durationNs, uint64_t intervalNs);
+
+  Snapshot getSnapshot() const;
+
+  // Human-readable report; false if the file could not be written
+  bool writeReport(const std::string& filename) const;
+
+  // Monotonic clock used for the measurements
+  static uint64_t now();
+
+private:
+  std::atomic<uint64_t> periodNs_;
+  std::atomic<uint64_t> callbacks_;
+  std::atomic<uint64_t> overruns_;
+  std::atomic<uint64_t> lateCallbacks_;
+  std::atomic<uint64_t> totalDurationNs_;
+  std::atomic<uint64_t> maxDurationNs_;
+  std::atomic<uint64_t> maxIntervalNs_;
+  std::array<std::atomic<uint64_t>, kBucketCount> histogram_;
+  std::atomic<bool> previousOverrun_;
+};
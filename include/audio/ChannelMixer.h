@@ -0,0 +1,53 @@
+#pragma once
+
+#include "AlignedAllocator.h"
+#include <cstddef>
+#include <vector>
+
+// Maps interleaved frames from one channel count to another through a gain
+// matrix, e.g. to play a mono or 5.1 source on a stereo device without
+// converting the whole file. process() does not allocate, so it can run in
+// the audio callback; stereo output uses SIMD kernels picked from
+// CpuFeatures::getActiveLevel() when the matrix is set.
+//
+// Channels follow the WAV order: FL, FR, FC, LFE, BL, BR, SL, SR. Four
+// channels are taken as quad (FL, FR, BL, BR) and five as FL, FR, FC, BL,
+// BR.
+class ChannelMixer {
+public:
+  // Default matrix: identity when the counts match; mono goes to both
+  // sides of stereo (or the centre of larger layouts); missing speakers
+  // fold into their neighbours at -3 dB (ITU-R BS.775); LFE is dropped
+  // when there is no LFE output
+  ChannelMixer(size_t inputChannels, size_t outputChannels);
+
+  // Row-major matrix: matrix[output * inputChannels + input]
+  ChannelMixer(size_t inputChannels, size_t outputChannels, const std::vector<float>& matrix);
+
+  size_t getInputChannels() const { return inputChannels_; }
+  size_t getOutputChannels() const { return outputChannels_; }
+  bool isIdentity() const { return kernel_ == Kernel::Identity; }
+
+  float getGain(size_t output, size_t input) const { return matrix_[output * inputChannels_ + input]; }
+  void setGain(size_t output, size_t input, float gain);
+
+  // Writes `frames` frames of getOutputChannels() channels; input and
+  // output must not overlap
+  void process(const float* input, float* output, size_t frames) const;
+
+  static std::vector<float> getDefaultMatrix(size_t inputChannels, size_t outputChannels);
+
+private:
+  enum class Kernel { Identity, Scalar, StereoSSE2, StereoAVX2 };
+
+  void selectKernel();
+
+  size_t inputChannels_;
+  size_t outputChannels_;
+  std::vector<float> matrix_;
+  Kernel kernel_;
+
+  // Stereo kernels: the two gains of each input repeated across a vector,
+  // one vector of kLanes floats per input channel
+  std::vector<float, AlignedAllocator<float>> stereoGains_;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+// Instruction set levels that SIMD kernels can be dispatched to at runtime
+enum class SimdLevel {
+  Scalar,
+  SSE2,
+  AVX2
+};
+
+namespace CpuFeatures {
+  // Highest level supported by the running CPU
+  SimdLevel getSupportedLevel();
+
+  // Level kernels should use: the supported level unless overridden
+  SimdLevel getActiveLevel();
+
+  // Force a lower level (e.g. to compare kernels in tests or benchmarks);
+  // requests above the supported level are clamped
+  void setLevelOverride(SimdLevel level);
+  void clearLevelOverride();
+
+  const char* getLevelName(SimdLevel level);
+}
+
+// Compile-time support for x86 kernels. Functions using instructions beyond
+// the compiler's baseline are tagged with the matching target attribute so
+// they can live next to scalar code and be selected at runtime.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AUDIO_SIMD_X86 1
+#endif
+
+#if defined(AUDIO_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define AUDIO_TARGET_SSE2 __attribute__((target("sse2")))
+#define AUDIO_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define AUDIO_TARGET_SSE2
+#define AUDIO_TARGET_AVX2
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "AudioBuffer.h"
+#include "AudioEffect.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Non-destructive edit model: the timeline is a list of segments referencing
+// immutable, shared sample blocks (a piece table). Edits rearrange segments
+// and only render new blocks for the frames an effect touches, so each undo
+// step costs memory proportional to the segment count, not the file size.
+class EditTimeline {
+public:
+  // Immutable interleaved samples shared between segments, clips and undo
+  // states
+  using SampleBlock = std::vector<float>;
+
+  struct Segment {
+    std::shared_ptr<const SampleBlock> block;
+    size_t offset;    // First frame within the block
+    size_t frames;
+  };
+
+  // Segments lifted out of a timeline by copy() or cut(); pasting one
+  // shares its blocks instead of copying samples
+  struct Clip {
+    std::vector<Segment> segments;
+    size_t frames = 0;
+    size_t channels = 0;    // Of the timeline it came from; paste() requires a match
+  };
+
+  EditTimeline(size_t sampleRate = 44100, size_t channels = 2);
+
+  // Start a new history from a buffer's contents (one copy into a block)
+  void load(const AudioBuffer& buffer);
+
+  size_t getFrameCount() const { return state_->frameCount; }
+  size_t getSampleRate() const { return sampleRate_; }
+  size_t getChannelCount() const { return channels_; }
+  size_t getSegmentCount() const { return state_->segments.size(); }
+
+  // Reading
+  float getSample(size_t frame, size_t channel) const;
+  size_t readFrames(size_t start, size_t frames, float* dest) const;
+  AudioBuffer render() const;
+
+  // Editing. Ranges are clamped to the timeline; each call that changes
+  // something is one undo step.
+  Clip copy(size_t start, size_t frames) const;
+  Clip cut(size_t start, size_t frames);
+  void erase(size_t start, size_t frames);
+  void paste(size_t position, const Clip& clip);
+  void insert(size_t position, const AudioBuffer& buffer);
+
+  // Render the effect over a range into a new block that replaces it
+  void applyEffect(size_t start, size_t frames, AudioEffect& effect);
+
+  // History
+  bool canUndo() const { return !undoStack_.empty(); }
+  bool canRedo() const { return !redoStack_.empty(); }
+  bool undo();
+  bool redo();
+  void clearHistory();
+
+private:
+  struct State {
+    std::vector<Segment> segments;
+    std::vector<size_t> starts;   // Timeline frame of each segment
+    size_t frameCount = 0;
+  };
+
+  using StatePtr = std::shared_ptr<const State>;
+
+  static StatePtr makeState(std::vector<Segment> segments);
+  size_t findSegment(size_t frame) const;
+  std::vector<Segment> slice(size_t start, size_t frames) const;
+  std::shared_ptr<const SampleBlock> makeBlock(const AudioBuffer& buffer) const;
+  void commit(std::vector<Segment> segments);
+
+  size_t sampleRate_;
+  size_t channels_;
+  StatePtr state_;
+  std::vector<StatePtr> undoStack_;
+  std::vector<StatePtr> redoStack_;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "AudioEffect.h"
+#include <memory>
+#include <vector>
+
+// Effects applied one after another. A chain is itself an effect, so chains
+// can be nested and used as branches of a ParallelEffects node.
+class EffectChain : public AudioEffect {
+public:
+  // Build the chain before prepare(); it must not change while processing
+  void addEffect(std::shared_ptr<AudioEffect> effect);
+  size_t getEffectCount() const { return effects_.size(); }
+  AudioEffect* getEffect(size_t index) const { return effects_[index].get(); }
+
+  void prepare(size_t sampleRate, size_t maxBlockFrames, size_t channels) override;
+  void processBlock(float* samples, size_t frames) override;
+  const char* getName() const override { return "Chain"; }
+
+private:
+  std::vector<std::shared_ptr<AudioEffect>> effects_;
+};
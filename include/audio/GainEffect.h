@@ -1,17 +1,24 @@
 #pragma once
 
 #include "AudioEffect.h"
+#include "SmoothedParameter.h"
 
 class GainEffect : public AudioEffect {
 public:
   GainEffect(float gain = 1.0f);
 
-  void process(AudioBuffer& buffer) override;
+  void prepare(size_t sampleRate, size_t maxBlockFrames, size_t channels) override;
+  void processBlock(float* samples, size_t frames) override;
   const char* getName() const override { return "Gain"; }
 
+  // Safe to call while the effect runs on the audio thread; the gain ramps
+  // to the new value instead of stepping
   void setGain(float gain);
-  float getGain() const { return gain_; }
+  float getGain() const { return gain_.getTarget(); }
+
+  // Ramp shape and automation
+  SmoothedParameter& getGainParameter() { return gain_; }
 
 private:
-  float gain_;
-};
\ No newline at end of file
+  SmoothedParameter gain_;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file. Pages are only brought into
+// memory when they are touched, so large files can be referenced without
+// reading them up front.
+class MappedFile {
+public:
+  MappedFile();
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Mapping management
+  bool open(const std::string& filename);
+  void close();
+  bool isOpen() const { return data_ != nullptr; }
+
+  // Mapped contents
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  // Paging hints for the given byte range
+  void adviseSequential(size_t offset, size_t length) const;
+  void adviseWillNeed(size_t offset, size_t length) const;
+
+private:
+  const uint8_t* data_;
+  size_t size_;
+
+#ifdef _WIN32
+  void* fileHandle_;
+  void* mappingHandle_;
+#endif
+};
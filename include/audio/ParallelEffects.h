@@ -0,0 +1,46 @@
+#pragma once
+
+#include "AudioEffect.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Splits the input into parallel branches (sends) and sums their outputs
+// with the dry signal on a mix bus:
+//   out = dry * dryLevel + sum(branch_i(in) * level_i)
+// Branches run one after another on the audio thread. With a thread pool
+// attached, for offline renders, independent branches run concurrently.
+class ParallelEffects : public AudioEffect {
+public:
+  ParallelEffects(float dryLevel = 1.0f);
+
+  // Build the graph before prepare(); levels may change while processing
+  size_t addBranch(std::shared_ptr<AudioEffect> effect, float level = 1.0f);
+  size_t getBranchCount() const { return branches_.size(); }
+  void setBranchLevel(size_t branch, float level);
+  float getBranchLevel(size_t branch) const { return branches_[branch]->level; }
+
+  void setDryLevel(float level) { dryLevel_ = level; }
+  float getDryLevel() const { return dryLevel_; }
+
+  // Pool used to run branches concurrently; nullptr for the audio thread
+  void setThreadPool(ThreadPool* pool) { threadPool_ = pool; }
+
+  void prepare(size_t sampleRate, size_t maxBlockFrames, size_t channels) override;
+  void processBlock(float* samples, size_t frames) override;
+  const char* getName() const override { return "Parallel"; }
+
+private:
+  struct Branch {
+    std::shared_ptr<AudioEffect> effect;
+    std::atomic<float> level;
+    std::vector<float> scratch;
+  };
+
+  void runBranch(Branch& branch, const float* input, size_t samples);
+
+  std::vector<std::unique_ptr<Branch>> branches_;
+  std::atomic<float> dryLevel_;
+  ThreadPool* threadPool_;
+};
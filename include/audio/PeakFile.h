@@ -0,0 +1,36 @@
+#pragma once
+
+#include "PeakPyramid.h"
+#include <cstdint>
+#include <string>
+
+// Identity of the audio file a sidecar was built from. The content hash
+// covers the head and tail of the file, so it is cheap even for huge files
+// while still catching rewrites that keep size and mtime.
+struct PeakFileKey {
+  uint64_t fileSize = 0;
+  int64_t modifiedTime = 0;
+  uint64_t contentHash = 0;
+
+  bool operator==(const PeakFileKey& other) const {
+    return fileSize == other.fileSize && modifiedTime == other.modifiedTime &&
+           contentHash == other.contentHash;
+  }
+  bool operator!=(const PeakFileKey& other) const { return !(*this == other); }
+};
+
+// Versioned ".peak" sidecar files holding a PeakPyramid next to its audio
+// file, so reopening a file shows its waveform without rescanning samples.
+namespace PeakFile {
+  const uint32_t kVersion = 1;
+
+  std::string getSidecarPath(const std::string& audioFilename);
+
+  bool computeKey(const std::string& audioFilename, PeakFileKey& key);
+
+  // Fails on a missing, stale (key mismatch) or incompatible sidecar
+  bool load(const std::string& sidecarFilename, const PeakFileKey& key, PeakPyramid& peaks);
+
+  // Written to a temporary file and renamed, so readers never see a partial file
+  bool save(const std::string& sidecarFilename, const PeakFileKey& key, const PeakPyramid& peaks);
+}
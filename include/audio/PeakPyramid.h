@@ -0,0 +1,75 @@
+#pragma once
+
+#include "AudioBuffer.h"
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+// Min/max/RMS of a range of frames, all channels combined
+struct PeakSummary {
+  float min = 0.0f;
+  float max = 0.0f;
+  float rms = 0.0f;
+};
+
+// Precomputed min/max/RMS mipmap of an AudioBuffer. Level 0 summarizes
+// 256-frame buckets and each level above groups 16 buckets of the one below
+// (256, 4096, 65536 frames), so summarizing any range reads a bounded number
+// of buckets regardless of buffer length.
+class PeakPyramid {
+public:
+  static const size_t kBaseBucketFrames = 256;
+  static const size_t kLevelRatio = 16;
+  static const size_t kLevelCount = 3;
+
+  PeakPyramid();
+
+  // Scan the whole buffer
+  void build(const AudioBuffer& buffer);
+
+  // Rescan the buckets covering an edited range and their parents. Falls
+  // back to a full build if the buffer's shape has changed.
+  void update(const AudioBuffer& buffer, size_t startFrame, size_t frames);
+
+  // Size the levels for a buffer of this shape with every bucket silent,
+  // so update() can fill them in as the audio arrives
+  void reset(size_t frameCount, size_t channels);
+
+  // Copy the pyramid of a piece of the source, built separately, into place
+  // at `startFrame`, so a file too large to load can be scanned in chunks.
+  // Pieces cover whole coarsest-level buckets (except the one that ends the
+  // source) so every level lines up; anything else fails.
+  bool insertPiece(const PeakPyramid& piece, size_t startFrame);
+
+  void clear();
+  bool isEmpty() const { return frameCount_ == 0; }
+
+  size_t getFrameCount() const { return frameCount_; }
+  size_t getChannelCount() const { return channels_; }
+  size_t getBucketFrames(size_t level) const;
+  size_t getBucketCount(size_t level) const;
+
+  // Summary of [startFrame, startFrame + frames) from the coarsest level
+  // whose buckets fit in the range. Range edges are rounded to that level's
+  // bucket boundaries.
+  PeakSummary query(size_t startFrame, size_t frames) const;
+
+  // Binary serialization of the bucket levels in host byte order.
+  // read() fails if the stored bucket geometry differs from this build's.
+  bool write(std::ostream& out) const;
+  bool read(std::istream& in);
+
+private:
+  struct Bucket {
+    float min;
+    float max;
+    float sumSquares;
+  };
+
+  void computeBase(const AudioBuffer& buffer, size_t firstBucket, size_t lastBucket);
+  void computeLevel(size_t level, size_t firstBucket, size_t lastBucket);
+
+  std::vector<Bucket> levels_[kLevelCount];
+  size_t frameCount_;
+  size_t channels_;
+};
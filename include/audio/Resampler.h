@@ -0,0 +1,104 @@
+#pragma once
+
+#include "AudioBuffer.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class ThreadPool;
+
+// Polyphase windowed-sinc (Kaiser) sample-rate converter. The rate ratio is
+// reduced to L/M and one filter phase per output position is precomputed,
+// so the inner loop is a dot product run by the SIMD level active when the
+// resampler was created. Ratios whose numerator exceeds kMaxPhases use
+// kMaxPhases phases and interpolate between neighbouring ones.
+//
+// Output frame j lies at input time j * inputRate / outputRate: there is no
+// added delay, only a lookahead of half the filter length.
+class Resampler {
+public:
+  enum class Quality {
+    Fast,       // 16 taps per phase when upsampling
+    Standard,   // 32 taps
+    High        // 64 taps
+  };
+
+  static constexpr size_t kMaxPhases = 1024;
+
+  // Streaming state is allocated here for process() calls of at most
+  // maxOutputFrames frames, so process() itself never allocates
+  Resampler(size_t inputRate, size_t outputRate, size_t channels, size_t maxOutputFrames,
+            Quality quality = Quality::Standard);
+
+  size_t getInputRate() const { return inputRate_; }
+  size_t getOutputRate() const { return outputRate_; }
+  size_t getChannelCount() const { return channels_; }
+  size_t getMaxOutputFrames() const { return maxOutputFrames_; }
+  size_t getTapCount() const { return taps_; }
+
+  // Input frames process() consumes to produce the next `outputFrames`
+  size_t getInputFramesFor(size_t outputFrames) const;
+
+  // Output frames that lie inside the next `inputFrames` input frames; when
+  // the input ends after them, later output is only filter ringing
+  size_t getOutputFramesFor(size_t inputFrames) const;
+
+  // Consume getInputFramesFor(outputFrames) interleaved input frames and
+  // write `outputFrames` interleaved frames. Real-time safe.
+  void process(const float* input, float* output, size_t outputFrames);
+
+  // Pull up to `outputFrames` frames, reading input on demand through
+  // read(float* dest, size_t frames) -> frames read. A short read marks the
+  // end of the input: the rest is zero-padded and the number of frames
+  // that still carry input is returned.
+  template <typename ReadFunction>
+  size_t pull(float* output, size_t outputFrames, ReadFunction&& read);
+
+  // Forget the history, e.g. after a seek
+  void reset();
+
+  // Convert a whole buffer, splitting the output across the pool's threads.
+  // The result keeps the input's layout.
+  static AudioBuffer convert(const AudioBuffer& input, size_t outputRate, ThreadPool* pool = nullptr,
+                             Quality quality = Quality::Standard);
+
+private:
+  struct FilterBank;
+  using DotFunction = float (*)(const float*, const float*, size_t);
+
+  float filter(const float* samples, uint64_t phase) const;
+
+  size_t inputRate_;
+  size_t outputRate_;
+  size_t channels_;
+  size_t maxOutputFrames_;
+  size_t taps_;
+
+  std::shared_ptr<const FilterBank> bank_;
+  DotFunction dot_;
+
+  // Planar history, one run of historyCapacity_ frames per channel
+  std::vector<float> history_;
+  std::vector<float> inputBlock_;
+  size_t historyCapacity_;
+  size_t buffered_;     // Frames held in the history
+  size_t index_;        // History frame at or before the next output
+  uint64_t phase_;      // Position past index_, in 1/L input frames
+};
+
+template <typename ReadFunction>
+size_t Resampler::pull(float* output, size_t outputFrames, ReadFunction&& read) {
+  size_t needed = getInputFramesFor(outputFrames);
+  size_t framesRead = needed > 0 ? read(inputBlock_.data(), needed) : 0;
+  size_t produced = outputFrames;
+
+  if (framesRead < needed) {
+    std::fill(inputBlock_.begin() + framesRead * channels_, inputBlock_.begin() + needed * channels_, 0.0f);
+    produced = std::min(outputFrames, getOutputFramesFor(framesRead));
+  }
+
+  process(inputBlock_.data(), output, outputFrames);
+  return produced;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Storage formats for PCM samples in files and device streams
+enum class SampleFormat {
+  Int16,
+  Int24,      // Packed 3-byte little-endian
+  Int32,
+  Float32
+};
+
+// Conversion between stored sample formats and normalized float samples
+// (-1.0 to 1.0). Sample data is little-endian and may be unaligned. Kernels
+// are selected at runtime from CpuFeatures::getActiveLevel().
+namespace SampleConversion {
+  size_t getBytesPerSample(SampleFormat format);
+  const char* getFormatName(SampleFormat format);
+
+  // Convert `count` samples of `format` into floats
+  void toFloat(SampleFormat format, const void* src, float* dest, size_t count);
+
+  // Convert `count` floats into `format`, clipping to full scale and
+  // rounding to nearest
+  void fromFloat(SampleFormat format, const float* src, void* dest, size_t count);
+
+  // Noise generator state for addDither(), one xorshift generator per SIMD
+  // lane. Keep one per stream so consecutive blocks continue the sequence.
+  struct DitherState {
+    static constexpr size_t kLanes = 8;
+    uint32_t lanes[kLanes];
+
+    explicit DitherState(uint32_t seed = 1);
+  };
+
+  // Add triangular (TPDF) noise of up to +-1 LSB of `format` to `count`
+  // samples ahead of fromFloat(), so requantization error becomes a steady
+  // noise floor instead of distortion that follows the signal. Int32 and
+  // Float32 are left unchanged: their LSB is below float precision.
+  // Every kernel produces the same output for the same state.
+  void addDither(SampleFormat format, float* samples, size_t count, DitherState& state);
+}
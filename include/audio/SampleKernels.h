@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+class ThreadPool;
+
+// Bulk float sample kernels behind the AudioBuffer analysis and processing
+// calls. Kernels are selected at runtime from CpuFeatures::getActiveLevel().
+// Sums accumulate in double, so results do not drift on long files. Given a
+// pool, inputs of at least kParallelThreshold samples are split across its
+// threads; partial results are combined in a fixed order, so the outcome
+// does not depend on scheduling.
+namespace SampleKernels {
+  const size_t kParallelThreshold = size_t(1) << 20;
+
+  // Largest absolute sample value; NaNs are ignored
+  float peak(const float* samples, size_t count, ThreadPool* pool = nullptr);
+
+  // Sum of squared samples
+  double sumSquares(const float* samples, size_t count, ThreadPool* pool = nullptr);
+
+  // Adds the sum of each channel of `frames` interleaved frames to
+  // sums[0, channels)
+  void sumChannels(const float* samples, size_t frames, size_t channels, double* sums, ThreadPool* pool = nullptr);
+
+  void applyGain(float* samples, size_t count, float gain, ThreadPool* pool = nullptr);
+
+  // dest = dest * destLevel + src * srcLevel
+  void mix(float* dest, const float* src, size_t count, float destLevel, float srcLevel, ThreadPool* pool = nullptr);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "SampleConversion.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Catalogue of the WAV files below a set of directories: header info plus
+// peak and RMS levels, kept in a compact index file so browsing a large
+// library never touches the audio files. Rescans only re-read files whose
+// size or modification time changed since they were catalogued.
+class SampleLibrary {
+public:
+  struct Entry {
+    std::string path;
+    uint64_t fileSize = 0;
+    int64_t modifiedTime = 0;
+    uint32_t sampleRate = 0;
+    uint16_t channels = 0;        // 0 for a file that could not be read
+    SampleFormat sampleFormat = SampleFormat::Int16;
+    uint64_t frameCount = 0;
+    float peak = 0.0f;            // Largest absolute sample (linear)
+    float rms = 0.0f;             // Over all channels (linear)
+
+    bool isReadable() const { return channels > 0; }
+    double getDuration() const { return sampleRate > 0 ? static_cast<double>(frameCount) / sampleRate : 0.0; }
+  };
+
+  struct ScanStats {
+    size_t files = 0;             // WAV files found
+    size_t unchanged = 0;         // Kept from the previous scan
+    size_t analyzed = 0;          // New or changed, read again
+    size_t failed = 0;            // Of those, not readable
+    size_t removed = 0;           // Gone since the previous scan
+    bool cancelled = false;
+    double seconds = 0.0;
+  };
+
+  static const uint32_t kIndexVersion = 1;
+
+  // Index file kept at the top of a library directory
+  static std::string getIndexPath(const std::string& root);
+
+  // Bring the catalogue up to date with every .wav file below `roots`.
+  // Directories are walked and files analyzed on the pool's threads (the
+  // calling thread only, without a pool). Setting `cancel` stops the scan
+  // early and leaves the catalogue as it was.
+  ScanStats scan(const std::vector<std::string>& roots, ThreadPool* pool = nullptr,
+                 const std::atomic<bool>* cancel = nullptr);
+
+  // Fails on a missing, damaged or older index and leaves the catalogue empty
+  bool load(const std::string& indexFilename);
+
+  // Written to a temporary file and renamed, so readers never see a partial index
+  bool save(const std::string& indexFilename) const;
+
+  // Sorted by path
+  const std::vector<Entry>& getEntries() const { return entries_; }
+  size_t size() const { return entries_.size(); }
+  bool isEmpty() const { return entries_.empty(); }
+
+  // Position of `path` in getEntries(), or size() if it is not catalogued
+  size_t find(const std::string& path) const;
+
+  void clear() { entries_.clear(); }
+
+private:
+  std::vector<Entry> entries_;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// An effect parameter that moves to new values over a short ramp instead
+// of jumping, and can follow a breakpoint envelope. The target can be set
+// from any thread; everything else belongs to the thread running the
+// effect. Values are produced a block at a time so effects can apply them
+// per frame.
+class SmoothedParameter {
+public:
+  enum class Ramp {
+    Linear,         // Constant slope, reaches the target after the ramp time
+    Exponential     // One-pole approach, ~99% of the way after the ramp time
+  };
+
+  struct Breakpoint {
+    uint64_t frame;
+    float value;
+  };
+
+  SmoothedParameter(float initial = 0.0f, Ramp ramp = Ramp::Linear, float rampSeconds = 0.02f);
+
+  // Thread-safe; starts a ramp from the current value
+  void setTarget(float value);
+  float getTarget() const { return target_; }
+
+  // Configuration; takes effect on the next prepare()
+  void setRamp(Ramp ramp, float rampSeconds);
+
+  // Sample-accurate envelope that replaces the target while set. Points are
+  // sorted by frame and interpolated linearly; before the first point and
+  // after the last the nearest value holds. Not for use while processing.
+  void setAutomation(std::vector<Breakpoint> points);
+  void clearAutomation();
+  bool hasAutomation() const { return !automation_.empty(); }
+
+  // Sizes the value buffer (may allocate) and jumps to the target
+  void prepare(size_t sampleRate, size_t maxBlockFrames);
+  void reset();
+
+  // Envelope position, in frames since prepare() unless set explicitly
+  void setPosition(uint64_t frame) { position_ = frame; }
+  uint64_t getPosition() const { return position_; }
+
+  // Advance by `frames` (<= maxBlockFrames). Returns true if the values
+  // vary across the block, in which case getValues() holds one per frame;
+  // otherwise the whole block is at getCurrentValue(). An empty block
+  // does nothing.
+  bool processBlock(size_t frames);
+  const float* getValues() const { return values_.data(); }
+  float getCurrentValue() const { return current_; }
+
+private:
+  bool processRamp(size_t frames);
+  bool processAutomation(size_t frames);
+  float getAutomationValue(uint64_t frame) const;
+
+  std::atomic<float> target_;
+  Ramp ramp_;
+  float rampSeconds_;
+
+  std::vector<Breakpoint> automation_;
+  std::vector<float> values_;
+
+  size_t rampFrames_;
+  float current_;
+  float rampTarget_;
+  float step_;
+  size_t stepsRemaining_;
+  float coefficient_;
+  uint64_t position_;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Neither side blocks or allocates, so it is safe to use from the
+// audio callback. Popped slots are reset on the consumer side, so the
+// consumer decides where any resources held by an element are released.
+template <typename T, size_t Capacity>
+class SpscQueue {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+  SpscQueue() : head_(0), tail_(0) {}
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  // Producer side; false if the queue is full, in which case `value` is
+  // left untouched
+  bool tryPush(T&& value) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+
+    if (tail - head_.load(std::memory_order_acquire) == Capacity) return false;
+
+    slots_[tail & (Capacity - 1)] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side; false if the queue is empty
+  bool tryPop(T& value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+
+    if (head == tail_.load(std::memory_order_acquire)) return false;
+
+    T& slot = slots_[head & (Capacity - 1)];
+    value = std::move(slot);
+    slot = T();
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool isEmpty() const {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+  }
+
+  static constexpr size_t capacity() { return Capacity; }
+
+private:
+  std::array<T, Capacity> slots_;
+
+  // Separate cache lines so producer and consumer do not false-share
+  alignas(64) std::atomic<size_t> head_;
+  alignas(64) std::atomic<size_t> tail_;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "PeakPyramid.h"
+#include "SpscQueue.h"
+#include "WavStreamReader.h"
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+// Builds the peak pyramid of a streamed file on a worker thread. The file is
+// read through its own reader in chunks; each chunk's pyramid is handed to
+// the consumer as a Piece to be placed with PeakPyramid::insertPiece(), so
+// the consumer's pyramid is only ever touched on its own thread and the
+// overview can be drawn while it fills in.
+class StreamPeakScanner {
+public:
+  enum class State { Idle, Scanning, Finished, Failed, Cancelled };
+
+  struct Piece {
+    size_t startFrame = 0;
+    PeakPyramid peaks;
+  };
+
+  StreamPeakScanner();
+  ~StreamPeakScanner();
+
+  StreamPeakScanner(const StreamPeakScanner&) = delete;
+  StreamPeakScanner& operator=(const StreamPeakScanner&) = delete;
+
+  // Fails without disturbing the current scan if the file cannot be opened;
+  // otherwise cancels the current scan and starts this one
+  bool start(const std::string& filename);
+
+  // Stop the worker and wait for it. Pieces not yet taken are dropped, so
+  // call it from the consumer's thread.
+  void cancel();
+
+  // Consumer side. Read the state before taking pieces: once it is
+  // Finished, every piece has been queued.
+  State getState() const { return state_.load(std::memory_order_acquire); }
+  bool takePiece(Piece& piece) { return pieces_.tryPop(piece); }
+
+  const std::string& getFilename() const { return filename_; }
+  size_t getFrameCount() const { return reader_.getFrameCount(); }
+  size_t getChannelCount() const { return reader_.getChannelCount(); }
+
+private:
+  void run();
+
+  WavStreamReader reader_;
+  std::string filename_;
+  SpscQueue<Piece, 16> pieces_;
+  std::atomic<State> state_;
+  std::atomic<bool> cancelRequested_;
+  std::thread worker_;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "WavStreamReader.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Reads a WAV file ahead of playback on its own thread into a preallocated
+// ring of interleaved frames. The consumer (the audio callback) only copies
+// frames out and posts seeks, so a disk stall costs an underrun instead of
+// blocking the callback.
+//
+// Seeks are numbered: the reader thread answers the latest one by seeking
+// its file and marking where the new frames start in the ring, and the
+// consumer drops everything before that mark.
+class StreamPrefetcher {
+public:
+  static constexpr size_t kDefaultCapacityFrames = 64 * 1024;
+
+  // With `blocking`, read() waits for the frames instead of underrunning,
+  // for offline rendering where there is no deadline
+  StreamPrefetcher(size_t capacityFrames = kDefaultCapacityFrames, bool blocking = false);
+  ~StreamPrefetcher();
+
+  StreamPrefetcher(const StreamPrefetcher&) = delete;
+  StreamPrefetcher& operator=(const StreamPrefetcher&) = delete;
+
+  // Opens its own reader, so no other thread ever shares its file position.
+  // Call before the consumer starts.
+  bool open(const std::string& filename);
+
+  size_t getFrameCount() const { return frameCount_; }
+  size_t getSampleRate() const { return reader_.getSampleRate(); }
+  size_t getChannelCount() const { return channels_; }
+
+  // Consumer side; never allocates, and never blocks unless `blocking`.
+  // Copies up to `frames` frames from the current position and returns how
+  // many; fewer than asked before the end means an underrun.
+  size_t read(float* dest, size_t frames);
+  void seek(size_t frame);
+  size_t getPosition() const { return position_; }
+
+  // Frames before which the stream ends: the frame count, or less if the
+  // file turned out shorter than its header
+  size_t getEndFrame() const { return endFrame_.load(std::memory_order_acquire); }
+
+  // Frames ready for the consumer at its current position
+  size_t getBufferedFrames() const;
+
+  uint64_t getUnderruns() const { return underruns_.load(std::memory_order_relaxed); }
+
+private:
+  void readerLoop();
+  size_t available();
+  void copyOut(float* dest, size_t frames);
+  void stop();
+
+  WavStreamReader reader_;
+  std::vector<float> ring_;
+  size_t capacityFrames_;
+  size_t channels_;
+  size_t frameCount_;
+  bool blocking_;
+
+  // Ring indices count frames and only grow; the slot is index % capacity
+  std::atomic<uint64_t> writeIndex_;    // Reader thread
+  std::atomic<uint64_t> readIndex_;     // Consumer
+
+  // Seek handshake: the consumer posts a target and bumps the request, the
+  // reader thread answers with the ring index the target's frames start at
+  std::atomic<size_t> seekTarget_;
+  std::atomic<uint32_t> seekRequest_;
+  std::atomic<uint32_t> seekAnswered_;
+  std::atomic<uint64_t> seekStart_;
+  std::atomic<size_t> endFrame_;
+
+  // Consumer only
+  size_t position_;
+  uint32_t requested_;
+  uint32_t synced_;
+
+  std::atomic<uint64_t> underruns_;
+  std::atomic<bool> stopping_;
+  std::mutex wakeMutex_;
+  std::condition_variable wake_;        // Reader thread: stop, or blocking consumer waiting
+  std::condition_variable ready_;       // Blocking consumer: frames arrived
+  std::thread thread_;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for offline work. Not for the audio callback:
+// parallelFor() blocks until every task has finished.
+class ThreadPool {
+public:
+  // 0 threads runs every task on the calling thread
+  explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t getThreadCount() const { return workers_.size(); }
+
+  // Run task(i) for every i in [0, count) and wait for all of them. The
+  // calling thread takes tasks too, so nested calls from inside a task
+  // cannot deadlock.
+  void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+private:
+  struct Job;
+
+  void workerLoop();
+  static void runTasks(Job& job);
+
+  std::vector<std::thread> workers_;
+  std::deque<std::shared_ptr<Job>> queue_;
+  std::mutex mutex_;
+  std::condition_variable available_;
+  bool stopping_;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "SampleConversion.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+
+// Layout of a WAV file as found by a single pass over its RIFF chunks
+struct WavInfo {
+  uint16_t audioFormat = 0;   // Format tag: 1 PCM, 3 IEEE float, 0xFFFE extensible
+  uint16_t channels = 0;
+  uint32_t sampleRate = 0;
+  uint16_t bitsPerSample = 0;
+  uint16_t blockAlign = 0;
+  SampleFormat sampleFormat = SampleFormat::Int16;
+  uint32_t channelMask = 0;   // Speaker positions of an extensible header; 0 if absent
+  bool isRF64 = false;        // RF64/BW64 with 64-bit sizes in a ds64 chunk
+  uint64_t dataOffset = 0;    // Byte offset of the first sample in the file
+  uint64_t dataSize = 0;      // Size of the data chunk in bytes
+  uint64_t frameCount = 0;
+};
+
+// Payload of one chunk: `offset` is its first byte in the file, 0 if the
+// chunk is absent
+struct ChunkLocation {
+  uint64_t offset = 0;
+  uint64_t size = 0;
+
+  bool isPresent() const { return offset != 0; }
+};
+
+// Where the chunks of interest in a WAVE file are, from one walk over the
+// whole chunk list. Metadata (LIST tags, the broadcast extension, cue
+// points) often follows the samples, so the walk does not stop at "data";
+// each chunk header is read exactly once, and headers within the first
+// 4 KiB of a stream come from a single read.
+struct WavChunkIndex {
+  // Reads `bytes` bytes at absolute file offset `offset`, false on short read
+  using ReadAtFunction = std::function<bool(uint64_t offset, void* dest, size_t bytes)>;
+
+  WavInfo info;
+  ChunkLocation format;
+  ChunkLocation data;
+  ChunkLocation list;     // First LIST chunk (usually INFO tags)
+  ChunkLocation bext;     // Broadcast Wave extension
+  ChunkLocation cue;
+
+  // Fails (with a message on stderr) unless the file has a supported format
+  // chunk and a data chunk
+  static bool build(const ReadAtFunction& readAt, WavChunkIndex& index);
+  static bool build(std::istream& file, WavChunkIndex& index);
+};
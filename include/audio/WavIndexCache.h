@@ -0,0 +1,57 @@
+#pragma once
+
+#include "WavChunkIndex.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Chunk indices of recently opened WAV files, keyed by path. An entry is
+// only returned while the file's size and modification time still match the
+// ones it was indexed with, so one stat replaces the open and header reads.
+// Shared between loaders and threads; the least recently used entry is
+// dropped once the capacity is reached.
+class WavIndexCache {
+public:
+  explicit WavIndexCache(size_t capacity = 4096);
+
+  // False if the path is unknown or the file changed since it was stored
+  bool lookup(const std::string& filename, WavChunkIndex& index);
+
+  // Remember the index of a file as it is on disk now
+  void store(const std::string& filename, const WavChunkIndex& index);
+
+  void clear();
+  size_t size() const;
+  size_t getCapacity() const { return capacity_; }
+
+  uint64_t getHits() const;
+  uint64_t getMisses() const;
+
+private:
+  // Size and modification time; a rewritten file differs in at least one
+  struct FileStamp {
+    uint64_t size = 0;
+    int64_t modified = 0;
+
+    bool operator==(const FileStamp& other) const { return size == other.size && modified == other.modified; }
+  };
+
+  struct Entry {
+    std::string filename;
+    FileStamp stamp;
+    WavChunkIndex index;
+  };
+
+  static bool getStamp(const std::string& filename, FileStamp& stamp);
+
+  size_t capacity_;
+
+  mutable std::mutex mutex_;
+  std::list<Entry> entries_;     // Most recently used first
+  std::unordered_map<std::string, std::list<Entry>::iterator> byName_;
+  uint64_t hits_;
+  uint64_t misses_;
+};
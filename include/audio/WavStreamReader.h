@@ -0,0 +1,49 @@
+#pragma once
+
+#include "AudioFileLoader.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Reads a WAV file in fixed-size frame blocks on demand, so playback and
+// browsing use constant memory regardless of file length.
+class WavStreamReader {
+public:
+  WavStreamReader(size_t blockFrames = 4096);
+
+  // Stream management
+  bool open(const std::string& filename);
+  void close();
+  bool isOpen() const { return file_.is_open(); }
+
+  // Stream properties
+  size_t getFrameCount() const { return static_cast<size_t>(info_.frameCount); }
+  size_t getSampleRate() const { return info_.sampleRate; }
+  size_t getChannelCount() const { return info_.channels; }
+  size_t getBlockFrames() const { return blockFrames_; }
+  const WavInfo& getInfo() const { return info_; }
+  const std::string& getFilename() const { return filename_; }
+
+  // Positioning
+  bool seek(size_t frame);
+  size_t tell() const { return position_; }
+
+  // Reads up to `frames` interleaved float frames from the current position
+  // and advances it. Returns the number of frames read (0 at end of stream).
+  size_t readFrames(float* dest, size_t frames);
+
+  // Reads the block starting at the current position into `block`, which is
+  // resized to hold at most getBlockFrames() frames
+  size_t readBlock(std::vector<float>& block);
+
+private:
+  std::ifstream file_;
+  std::string filename_;
+  WavInfo info_;
+
+  size_t blockFrames_;
+  size_t position_;
+  bool filePositionValid_;
+  std::vector<uint8_t> rawBlock_;
+};
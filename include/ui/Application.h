@@ -6,7 +6,12 @@
 #include "audio/GainEffect.h"
 #include "audio/AudioPlayer.h"
 #include "audio/AudioFileLoader.h"
+#include "audio/AsyncFileLoader.h"
+#include "audio/SampleLibrary.h"
+#include "audio/StreamPeakScanner.h"
+#include <atomic>
 #include <memory>
+#include <thread>
 
 class Application {
 public:
@@ -19,7 +24,14 @@ public:
 
   void loadTestAudio();
   void loadAudioFile(const std::string& filename);
+  void openAudioStream(const std::string& filename);
   void applyGainEffect(float gain);
+  void exportAudio(const std::string& filename);
+
+  // Sample library browsing
+  void scanLibrary();
+  void selectLibraryEntry(long offset);
+  void loadSelectedEntry();
   void togglePlayback();
   void stopPlayback();
 
@@ -31,17 +43,74 @@ public:
   void quit() { running_ = false; }
 
 private:
+  // Feed a background load's progress to the view; finish up when it ends
+  void updateLoading();
+
+  // Feed a stream's background peak scan to the view; save the sidecar
+  // when it ends
+  void updateStreamPeaks();
+
+  // Swap in a finished library scan and save its index
+  void finishLibraryScan();
+
+  // Runs on exportThread_: renders `source`, or the stream file if it is
+  // null, through `gain` into `filename`
+  bool writeExport(const std::string& filename, const std::string& streamFilename,
+                   const AudioBuffer* source, float gain);
+
+  // Report a running export's progress; join it when it ends
+  void updateExport();
+
   std::unique_ptr<Window> window_;
   std::unique_ptr<WaveformView> waveformView_;
-  std::unique_ptr<AudioBuffer> audioBuffer_;
-  std::unique_ptr<GainEffect> gainEffect_;
+  std::shared_ptr<AudioBuffer> audioBuffer_;
+  std::shared_ptr<GainEffect> gainEffect_;
   std::unique_ptr<AudioPlayer> audioPlayer_;
   std::unique_ptr<AudioFileLoader> fileLoader_;
+  std::unique_ptr<AsyncFileLoader> asyncLoader_;
+  std::unique_ptr<StreamPeakScanner> peakScanner_;
+
+  // Set while audioBuffer_ is being filled by asyncLoader_
+  std::shared_ptr<const std::atomic<size_t>> loadingFrames_;
+  size_t displayedFrames_;
+  bool peaksFromSidecar_;
+  bool scanningStreamPeaks_;
+
+  // Separate readers so the audio callback and the view never share a file position
+  std::shared_ptr<WavStreamReader> playbackStream_;
+  std::unique_ptr<WavStreamReader> viewStream_;
 
   bool running_;
   bool audioLoaded_;
+  bool streaming_;
 
   float currentGain_;
   bool showWaveform_;
   bool audioPlaying_;
+  bool redrawNeeded_;
+
+  // Audio xruns already reported on the console
+  uint64_t reportedXruns_;
+
+  // Library browsed from the index; rescans fill scannedLibrary_ on
+  // libraryScan_ and never touch library_ while it is shown
+  std::string libraryRoot_;
+  SampleLibrary library_;
+  size_t selectedEntry_;
+  std::thread libraryScan_;
+  std::unique_ptr<SampleLibrary> scannedLibrary_;
+  SampleLibrary::ScanStats scanStats_;
+  std::atomic<bool> libraryScanDone_;
+  std::atomic<bool> cancelLibraryScan_;
+
+  // Export rendered on exportThread_; loads wait until it has finished so
+  // its source stays in place
+  std::thread exportThread_;
+  std::string exportFilename_;
+  size_t exportTotalFrames_;
+  size_t reportedExportPercent_;
+  bool exportOk_;
+  std::atomic<size_t> exportedFrames_;
+  std::atomic<bool> exportDone_;
+  std::atomic<bool> cancelExport_;
 };
\ No newline at end of file
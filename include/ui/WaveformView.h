@@ -2,21 +2,76 @@
 
 #include "Window.h"
 #include "audio/AudioBuffer.h"
+#include "audio/PeakPyramid.h"
+#include "audio/WavStreamReader.h"
 #include <vector>
 
 class WaveformView {
 public:
   WaveformView(int x, int y, int width, int height);
+  ~WaveformView();
 
+  WaveformView(const WaveformView&) = delete;
+  WaveformView& operator=(const WaveformView&) = delete;
+
+  // Builds the buffer's peak pyramid once; zooming and scrolling then cost
+  // O(pixels) regardless of buffer length
   void setAudioBuffer(const AudioBuffer& buffer);
 
+  // Use a pyramid restored from a sidecar file instead of scanning
+  void setAudioBuffer(const AudioBuffer& buffer, const PeakPyramid& peaks);
+
+  // Show a buffer a background load is still filling. Nothing is read
+  // until setLoadedFrames() reports frames; the rest is drawn as silence.
+  void setLoadingBuffer(const AudioBuffer& buffer);
+
+  // Loading buffer whose full pyramid came from a sidecar file
+  void setLoadingBuffer(const AudioBuffer& buffer, const PeakPyramid& peaks);
+
+  // Frames of a loading buffer that are ready. Only the newly loaded range
+  // is scanned into the pyramid.
+  void setLoadedFrames(size_t frames);
+
+  // Refresh the pyramid after the buffer was edited in place
+  void refreshAudioRange(size_t startFrame, size_t frames);
+
+  // Browse a file through a stream instead of a loaded buffer. Each pixel
+  // reads at most a bounded window of frames, so memory stays constant,
+  // until addStreamPeaks() has covered it.
+  void setAudioStream(WavStreamReader& stream);
+
+  // Stream with a precomputed pyramid: wide pixels read the pyramid and
+  // never touch the file
+  void setAudioStream(WavStreamReader& stream, const PeakPyramid& peaks);
+
+  // Place the next piece of a stream's pyramid from a background scan
+  // (StreamPeakScanner); pieces arrive in order
+  void addStreamPeaks(const PeakPyramid& piece, size_t startFrame);
+
+  const PeakPyramid& getPeaks() const { return peaks_; }
+
+  // Recompute the per-pixel levels if the data or view changed. render()
+  // does this on demand; calling it directly lets the cost be measured.
+  void updateWaveformData();
+
+  // Copies a cached texture of the waveform; the texture is only redrawn
+  // when the data or view parameters change
   void render(SDL_Renderer* renderer);
 
+  // Drop the cached texture, e.g. after the renderer reported its targets
+  // or device were reset; the next render() recreates it
+  void releaseTexture();
+
   void setPosition(int x, int y);
   void setSize(int width, int height);
   void setColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255);
 
   void setZoom(float zoom);
+
+  // Scales the drawn levels like a gain applied to the audio, for previewing
+  // one; unlike the zoom it may go down to 0
+  void setDisplayGain(float gain);
+  float getDisplayGain() const { return displayGain_; }
   void setScrollOffset(int offset);
 
   int getX() const { return x_; }
@@ -25,15 +80,31 @@ public:
   int getHeight() const { return height_; }
 
 private:
-  void updateWaveformData();
-  void drawWaveform(SDL_Renderer* renderer);
+  size_t getSourceFrameCount() const;
+  void accumulateBuffer(size_t startFrame, size_t frames, float& sum, size_t& count) const;
+  void accumulateStream(size_t startFrame, size_t frames, float& sum, size_t& count);
+  void drawWaveform(SDL_Renderer* renderer, int originX, int originY);
+  bool renderTexture(SDL_Renderer* renderer);
 
   int x_, y_, width_, height_;
   SDL_Color color_;
   float zoom_;
+  float displayGain_;
   int scrollOffset_;
 
   const AudioBuffer* audioBuffer_;
+  size_t loadedFrames_;   // Buffer frames that may be read
+  size_t scannedFrames_;  // Buffer or stream frames covered by the pyramid
+  PeakPyramid peaks_;
+  WavStreamReader* audioStream_;
+  std::vector<float> streamBlock_;
   std::vector<float> waveformData_;
   bool dataUpdated_;
+
+  std::vector<SDL_Rect> bars_;
+  SDL_Texture* texture_;
+  SDL_Renderer* textureRenderer_;
+  int textureWidth_;
+  int textureHeight_;
+  bool textureValid_;
 };
\ No newline at end of file
@@ -26,6 +26,10 @@ public:
   // Event handling
   bool pollEvent(SDL_Event& event);
 
+  // Block until an event is queued or the timeout expires, without
+  // removing the event from the queue
+  bool waitForEvent(int timeoutMs);
+
 private:
   SDL_Window* window_;
   SDL_Renderer* renderer_;
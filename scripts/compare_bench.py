@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Compare two benchmark JSON files (from `bench --json=...`).
+
+Prints the change in real time per benchmark and exits with status 1 if any
+benchmark present in both files got slower than the threshold allows, so it
+can gate upgrades in CI:
+
+    ./bench --json=current.json
+    scripts/compare_bench.py baseline.json current.json --threshold 10
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    results = {}
+    for entry in data.get("benchmarks", []):
+        if entry.get("run_type", "iteration") == "iteration":
+            results[entry["name"]] = entry
+    return data.get("context", {}), results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent (default: 10)")
+    parser.add_argument("--filter", default="",
+                        help="only compare benchmarks whose name contains this")
+    args = parser.parse_args()
+
+    baseline_context, baseline = load(args.baseline)
+    current_context, current = load(args.current)
+
+    for key in ("simd_level", "num_cpus", "library_build_type"):
+        if baseline_context.get(key) != current_context.get(key):
+            print("warning: %s differs (baseline %s, current %s)"
+                  % (key, baseline_context.get(key), current_context.get(key)))
+
+    names = [name for name in current if name in baseline and args.filter in name]
+    regressions = []
+
+    print("%-48s %12s %12s %9s" % ("Benchmark", "Baseline", "Current", "Change"))
+    print("-" * 84)
+
+    for name in names:
+        before = baseline[name]["real_time"]
+        after = current[name]["real_time"]
+        change = (after - before) / before * 100.0 if before > 0 else 0.0
+        marker = ""
+
+        if change > args.threshold:
+            regressions.append(name)
+            marker = "  REGRESSION"
+
+        print("%-48s %10.0fns %10.0fns %+8.1f%%%s" % (name, before, after, change, marker))
+
+    for name in sorted(set(baseline) - set(current)):
+        if args.filter in name:
+            print("%-48s missing from current run" % name)
+
+    for name in sorted(set(current) - set(baseline)):
+        if args.filter in name:
+            print("%-48s new (no baseline)" % name)
+
+    if regressions:
+        print("\n%d benchmark(s) slower than %.1f%%:" % (len(regressions), args.threshold))
+        for name in regressions:
+            print("  " + name)
+        return 1
+
+    print("\nNo regressions beyond %.1f%%" % args.threshold)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
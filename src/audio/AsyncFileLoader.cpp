@@ -0,0 +1,132 @@
+#include "audio/AsyncFileLoader.h"
+#include "audio/SampleConversion.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+  // Frames converted and published per step. Large enough to keep reads
+  // sequential, small enough that progress updates several times a second.
+  const size_t kBlockFrames = 64 * 1024;
+}
+
+AsyncFileLoader::AsyncFileLoader()
+  : state_(State::Idle), cancelRequested_(false) {}
+
+AsyncFileLoader::~AsyncFileLoader() {
+  cancel();
+}
+
+bool AsyncFileLoader::start(const std::string& filename, ProgressCallback progress) {
+  auto file = std::make_unique<std::ifstream>(filename, std::ios::binary);
+
+  if (!file->is_open()) {
+    std::cerr << "Cannot open file: " << filename << std::endl;
+    return false;
+  }
+
+  WavInfo info;
+
+  if (!AudioFileLoader::parseWavChunks(*file, info)) {
+    return false;
+  }
+
+  return begin(std::move(file), filename, info, std::move(progress));
+}
+
+bool AsyncFileLoader::start(const std::string& filename, const WavInfo& info, ProgressCallback progress) {
+  auto file = std::make_unique<std::ifstream>(filename, std::ios::binary);
+
+  if (!file->is_open()) {
+    std::cerr << "Cannot open file: " << filename << std::endl;
+    return false;
+  }
+
+  return begin(std::move(file), filename, info, std::move(progress));
+}
+
+bool AsyncFileLoader::begin(std::unique_ptr<std::ifstream> file, const std::string& filename, const WavInfo& info,
+                            ProgressCallback progress) {
+  if (!AudioFileLoader::checkDataSize(info, *file)) {
+    return false;
+  }
+
+  cancel();
+
+  // Allocated here so the worker only ever writes sample memory and never
+  // touches the buffer object that readers use
+  auto buffer = std::make_shared<AudioBuffer>(info.sampleRate, info.channels);
+  buffer->resize(info.frameCount);
+  float* output = buffer->getData();
+
+  buffer_ = std::move(buffer);
+  loadedFrames_ = std::make_shared<std::atomic<size_t>>(0);
+  info_ = info;
+  filename_ = filename;
+  cancelRequested_.store(false, std::memory_order_relaxed);
+  state_.store(State::Loading, std::memory_order_release);
+
+  worker_ = std::thread(&AsyncFileLoader::run, this, std::move(file), output, std::move(progress));
+  return true;
+}
+
+void AsyncFileLoader::cancel() {
+  cancelRequested_.store(true, std::memory_order_relaxed);
+  wait();
+}
+
+void AsyncFileLoader::wait() {
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+float AsyncFileLoader::getProgress() const {
+  size_t total = getTotalFrames();
+  return total > 0 ? static_cast<float>(getLoadedFrames()) / total : 0.0f;
+}
+
+void AsyncFileLoader::run(std::unique_ptr<std::ifstream> file, float* output, ProgressCallback progress) {
+  size_t channelCount = info_.channels;
+  size_t totalFrames = info_.frameCount;
+  size_t bytesPerFrame = info_.blockAlign;
+  std::atomic<size_t>& loadedFrames = *loadedFrames_;
+
+  std::vector<uint8_t> rawFrames(std::min(totalFrames, kBlockFrames) * bytesPerFrame);
+  size_t framesDone = 0;
+
+  file->clear();
+  file->seekg(static_cast<std::streamoff>(info_.dataOffset), std::ios::beg);
+
+  while (framesDone < totalFrames) {
+    if (cancelRequested_.load(std::memory_order_relaxed)) {
+      state_.store(State::Cancelled, std::memory_order_release);
+      return;
+    }
+
+    size_t framesToRead = std::min(kBlockFrames, totalFrames - framesDone);
+    size_t bytesToRead = framesToRead * bytesPerFrame;
+
+    file->read(reinterpret_cast<char*>(rawFrames.data()), static_cast<std::streamsize>(bytesToRead));
+
+    if (static_cast<size_t>(file->gcount()) != bytesToRead) {
+      std::cerr << "Failed to read all audio data: " << filename_ << std::endl;
+      state_.store(State::Failed, std::memory_order_release);
+      return;
+    }
+
+    SampleConversion::toFloat(info_.sampleFormat, rawFrames.data(), output + framesDone * channelCount,
+                              framesToRead * channelCount);
+    framesDone += framesToRead;
+
+    // Release: readers that see the new count also see the samples
+    loadedFrames.store(framesDone, std::memory_order_release);
+
+    if (progress) {
+      progress(framesDone, totalFrames);
+    }
+  }
+
+  state_.store(State::Finished, std::memory_order_release);
+}
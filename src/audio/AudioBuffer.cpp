@@ -1,10 +1,42 @@
 #include "audio/AudioBuffer.h"
+#include "audio/MappedFile.h"
+#include "audio/SampleConversion.h"
+#include "audio/SampleKernels.h"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
+#include <utility>
 
-AudioBuffer::AudioBuffer(size_t sampleRate, size_t channels)
-  : sampleRate_(sampleRate), channels_(channels), frameCount_(0) {
+namespace {
+  // Planar channels are padded to whole cache lines so each one starts aligned
+  const size_t kPlanarAlignFrames = kSampleAlignment / sizeof(float);
+
+  size_t alignFrames(size_t frames) {
+    return (frames + kPlanarAlignFrames - 1) / kPlanarAlignFrames * kPlanarAlignFrames;
+  }
+
+  // Mapped storage is measured in converted blocks of whole frames
+  const size_t kMappedBlockSamples = 4096;
+
+  template <typename Function>
+  void forEachMappedBlock(const uint8_t* mapped, SampleFormat format, size_t count, size_t channels, Function fn) {
+    size_t blockSamples = std::max(channels, kMappedBlockSamples / channels * channels);
+    size_t bytesPerSample = SampleConversion::getBytesPerSample(format);
+    std::vector<float> block(blockSamples);
+
+    for (size_t done = 0; done < count; done += blockSamples) {
+      size_t samples = std::min(blockSamples, count - done);
+      SampleConversion::toFloat(format, mapped + done * bytesPerSample, block.data(), samples);
+      fn(block.data(), samples);
+    }
+  }
+}
+
+AudioBuffer::AudioBuffer(size_t sampleRate, size_t channels, SampleLayout layout)
+  : data_(std::make_shared<SampleStorage>()), sampleRate_(sampleRate),
+  channels_(channels), frameCount_(0), layout_(layout), planarStride_(0),
+  mappedSamples_(nullptr), mappedFormat_(SampleFormat::Int16) {
   if (channels == 0) {
     throw std::invalid_argument("Channel count must be greater than 0");
   }
@@ -12,7 +44,21 @@ AudioBuffer::AudioBuffer(size_t sampleRate, size_t channels)
 
 AudioBuffer::AudioBuffer(const AudioBuffer& other)
   : data_(other.data_), sampleRate_(other.sampleRate_),
-  channels_(other.channels_), frameCount_(other.frameCount_) {}
+  channels_(other.channels_), frameCount_(other.frameCount_),
+  layout_(other.layout_), planarStride_(other.planarStride_),
+  mappedFile_(other.mappedFile_), mappedSamples_(other.mappedSamples_), mappedFormat_(other.mappedFormat_) {}
+
+AudioBuffer::AudioBuffer(AudioBuffer&& other) noexcept
+  : data_(std::move(other.data_)), sampleRate_(other.sampleRate_),
+  channels_(other.channels_), frameCount_(other.frameCount_),
+  layout_(other.layout_), planarStride_(other.planarStride_),
+  mappedFile_(std::move(other.mappedFile_)), mappedSamples_(other.mappedSamples_),
+  mappedFormat_(other.mappedFormat_) {
+  // Leave the source as a valid empty buffer
+  other.frameCount_ = 0;
+  other.planarStride_ = 0;
+  other.mappedSamples_ = nullptr;
+}
 
 AudioBuffer& AudioBuffer::operator=(const AudioBuffer& other) {
   if (this != &other) {
@@ -20,17 +66,93 @@ AudioBuffer& AudioBuffer::operator=(const AudioBuffer& other) {
     sampleRate_ = other.sampleRate_;
     channels_ = other.channels_;
     frameCount_ = other.frameCount_;
+    layout_ = other.layout_;
+    planarStride_ = other.planarStride_;
+    mappedFile_ = other.mappedFile_;
+    mappedSamples_ = other.mappedSamples_;
+    mappedFormat_ = other.mappedFormat_;
+  }
+  return *this;
+}
+
+AudioBuffer& AudioBuffer::operator=(AudioBuffer&& other) noexcept {
+  if (this != &other) {
+    data_ = std::move(other.data_);
+    sampleRate_ = other.sampleRate_;
+    channels_ = other.channels_;
+    frameCount_ = other.frameCount_;
+    layout_ = other.layout_;
+    planarStride_ = other.planarStride_;
+    mappedFile_ = std::move(other.mappedFile_);
+    mappedSamples_ = other.mappedSamples_;
+    mappedFormat_ = other.mappedFormat_;
+
+    other.frameCount_ = 0;
+    other.planarStride_ = 0;
+    other.mappedSamples_ = nullptr;
   }
   return *this;
 }
 
 void AudioBuffer::resize(size_t frames) {
+  if (layout_ == SampleLayout::Interleaved) {
+    mutableData().resize(frames * channels_);
+    frameCount_ = frames;
+    return;
+  }
+
+  // Planar channels move when the stride changes; the new storage starts
+  // zeroed, which keeps the padding after each channel silent
+  if (mappedSamples_) materialize();
+
+  size_t stride;
+  auto storage = makeStorage(layout_, frames, stride);
+  copyFrames(std::as_const(*this).getView(),
+             AudioBufferView::planar(storage->data(), frames, channels_, stride));
+
+  data_ = std::move(storage);
+  planarStride_ = stride;
   frameCount_ = frames;
-  data_.resize(frames * channels_);
+}
+
+void AudioBuffer::setLayout(SampleLayout layout) {
+  if (layout == layout_) return;
+
+  // Mapped storage is interleaved; bring it in before rearranging
+  if (mappedSamples_) materialize();
+
+  size_t stride;
+  auto storage = makeStorage(layout, frameCount_, stride);
+  AudioBufferView target = layout == SampleLayout::Planar
+    ? AudioBufferView::planar(storage->data(), frameCount_, channels_, stride)
+    : AudioBufferView(storage->data(), frameCount_, channels_);
+
+  copyFrames(std::as_const(*this).getView(), target);
+
+  data_ = std::move(storage);
+  layout_ = layout;
+  planarStride_ = stride;
+}
+
+std::shared_ptr<AudioBuffer::SampleStorage> AudioBuffer::makeStorage(SampleLayout layout, size_t frames, size_t& channelStride) const {
+  if (layout == SampleLayout::Planar) {
+    channelStride = alignFrames(frames);
+    return std::make_shared<SampleStorage>(channelStride * channels_, 0.0f);
+  }
+
+  channelStride = 0;
+  return std::make_shared<SampleStorage>(frames * channels_, 0.0f);
 }
 
 void AudioBuffer::clear() {
-  std::fill(data_.begin(), data_.end(), 0.0f);
+  if (mappedSamples_ || isShared() || !data_) {
+    // Nothing worth copying: start from fresh zeroed storage
+    detachMapping();
+    data_ = makeStorage(layout_, frameCount_, planarStride_);
+    return;
+  }
+
+  std::fill(data_->begin(), data_->end(), 0.0f);
 }
 
 size_t AudioBuffer::getFrameCount() const {
@@ -49,61 +171,271 @@ float AudioBuffer::getSample(size_t frame, size_t channel) const {
   if (frame >= frameCount_ || channel >= channels_) {
     return 0.0f;
   }
-  return data_[frame * channels_ + channel];
+
+  if (mappedSamples_) {
+    return getMappedSample(frame * channels_ + channel);
+  }
+  return (*data_)[getIndex(frame, channel)];
 }
 
 void AudioBuffer::setSample(size_t frame, size_t channel, float value) {
   if (frame >= frameCount_ || channel >= channels_) {
     return;
   }
-  data_[frame * channels_ + channel] = value;
+
+  mutableData()[getIndex(frame, channel)] = value;
 }
 
-void AudioBuffer::normalize() {
-  float peak = getPeakAmplitude();
+size_t AudioBuffer::getIndex(size_t frame, size_t channel) const {
+  return layout_ == SampleLayout::Planar ? channel * planarStride_ + frame : frame * channels_ + channel;
+}
 
-  if (peak > 0.0f) {
-    applyGain(1.0f / peak);
+float* AudioBuffer::getData() {
+  return mutableData().data();
+}
+
+const float* AudioBuffer::getData() const {
+  return mappedSamples_ || !data_ ? nullptr : data_->data();
+}
+
+size_t AudioBuffer::getChannelStride() const {
+  return layout_ == SampleLayout::Planar ? planarStride_ : 1;
+}
+
+AudioBufferView AudioBuffer::getView() {
+  float* data = getData();
+
+  if (layout_ == SampleLayout::Planar) {
+    return AudioBufferView::planar(data, frameCount_, channels_, planarStride_);
+  }
+  return AudioBufferView(data, frameCount_, channels_);
+}
+
+ConstAudioBufferView AudioBuffer::getView() const {
+  const float* data = getData();
+
+  if (!data) return ConstAudioBufferView();
+
+  if (layout_ == SampleLayout::Planar) {
+    return ConstAudioBufferView::planar(data, frameCount_, channels_, planarStride_);
+  }
+  return ConstAudioBufferView(data, frameCount_, channels_);
+}
+
+AudioBufferView AudioBuffer::getView(size_t startFrame, size_t frames) {
+  return getView().getFrames(startFrame, frames);
+}
+
+ConstAudioBufferView AudioBuffer::getView(size_t startFrame, size_t frames) const {
+  return getView().getFrames(startFrame, frames);
+}
+
+bool AudioBuffer::isShared() const {
+  return data_ && data_.use_count() > 1;
+}
+
+void AudioBuffer::makeUnique() {
+  if (!data_) {
+    data_ = std::make_shared<SampleStorage>();
+  }
+  else if (data_.use_count() > 1) {
+    data_ = std::make_shared<SampleStorage>(*data_);
   }
 }
 
-void AudioBuffer::applyGain(float gain) {
-  for (auto& sample : data_) {
-    sample *= gain;
+AudioBuffer::SampleStorage& AudioBuffer::mutableData() {
+  if (mappedSamples_) materialize();
+
+  makeUnique();
+  return *data_;
+}
+
+void AudioBuffer::attachMapped(std::shared_ptr<const MappedFile> file, const uint8_t* samples, size_t frames,
+                               SampleFormat format) {
+  data_ = std::make_shared<SampleStorage>();
+  layout_ = SampleLayout::Interleaved;
+  planarStride_ = 0;
+
+  mappedFile_ = std::move(file);
+  mappedSamples_ = samples;
+  mappedFormat_ = format;
+  frameCount_ = frames;
+}
+
+void AudioBuffer::materialize() {
+  if (!mappedSamples_) return;
+
+  // Convert into new storage; copies sharing the mapping keep reading it
+  auto samples = std::make_shared<SampleStorage>(frameCount_ * channels_);
+  SampleConversion::toFloat(mappedFormat_, mappedSamples_, samples->data(), samples->size());
+  data_ = std::move(samples);
+
+  detachMapping();
+}
+
+float AudioBuffer::getMappedSample(size_t index) const {
+  // The data chunk is not guaranteed to be aligned within the file
+  const uint8_t* p = mappedSamples_ + index * SampleConversion::getBytesPerSample(mappedFormat_);
+
+  switch (mappedFormat_) {
+    case SampleFormat::Int16: {
+      int16_t value;
+      std::memcpy(&value, p, sizeof(value));
+      return static_cast<float>(value) / 32768.0f;
+    }
+
+    case SampleFormat::Int24: {
+      uint32_t bits = static_cast<uint32_t>(p[0]) << 8 | static_cast<uint32_t>(p[1]) << 16 |
+                      static_cast<uint32_t>(p[2]) << 24;
+      return static_cast<float>(static_cast<int32_t>(bits) >> 8) / 8388608.0f;
+    }
+
+    case SampleFormat::Int32: {
+      int32_t value;
+      std::memcpy(&value, p, sizeof(value));
+      return static_cast<float>(value) / 2147483648.0f;
+    }
+
+    case SampleFormat::Float32: {
+      float value;
+      std::memcpy(&value, p, sizeof(value));
+      return value;
+    }
   }
+  return 0.0f;
 }
 
-void AudioBuffer::mix(const AudioBuffer& other, float mixLevel) {
+void AudioBuffer::detachMapping() {
+  mappedFile_.reset();
+  mappedSamples_ = nullptr;
+}
+
+void AudioBuffer::normalize(ThreadPool* pool) {
+  float peak = getPeakAmplitude(pool);
+
+  if (peak > 0.0f) {
+    applyGain(1.0f / peak, pool);
+  }
+}
+
+void AudioBuffer::applyGain(float gain, ThreadPool* pool) {
+  // Planar padding is zero and stays zero
+  SampleStorage& samples = mutableData();
+  SampleKernels::applyGain(samples.data(), samples.size(), gain, pool);
+}
+
+void AudioBuffer::mix(const AudioBuffer& other, float mixLevel, ThreadPool* pool) {
   size_t minFrames = std::min(frameCount_, other.frameCount_);
   size_t minChannels = std::min(channels_, other.channels_);
 
-  for (size_t frame = 0; frame < minFrames; ++frame) {
-    for (size_t channel = 0; channel < minChannels; ++channel) {
-      float currentSample = getSample(frame, channel);
-      float otherSample = other.getSample(frame, channel);
-      setSample(frame, channel, currentSample * (1.0f - mixLevel) + otherSample * mixLevel);
+  if (minFrames == 0) return;
+
+  // Detach once up front; `other` keeps its own view if it shared our storage
+  AudioBufferView target = getView();
+  ConstAudioBufferView source = other.getView();
+
+  // Matching layouts mix whole runs with the block kernel
+  if (!source.isEmpty() && layout_ == other.layout_) {
+    if (layout_ == SampleLayout::Planar) {
+      for (size_t channel = 0; channel < minChannels; ++channel) {
+        SampleKernels::mix(target.getChannelData(channel), source.getChannelData(channel), minFrames,
+                           1.0f - mixLevel, mixLevel, pool);
+      }
+      return;
+    }
+
+    if (channels_ == other.channels_) {
+      SampleKernels::mix(target.getData(), source.getData(), minFrames * channels_, 1.0f - mixLevel, mixLevel, pool);
+      return;
     }
   }
+
+  // Channel by channel, so planar buffers are walked with unit stride
+  for (size_t channel = 0; channel < minChannels; ++channel) {
+    float* output = target.getChannelData(channel);
+    size_t outputStride = target.getFrameStride();
+
+    for (size_t frame = 0; frame < minFrames; ++frame) {
+      float otherSample = source.isEmpty() ? other.getSample(frame, channel) : source.at(frame, channel);
+      float& currentSample = output[frame * outputStride];
+      currentSample = currentSample * (1.0f - mixLevel) + otherSample * mixLevel;
+    }
+  }
+}
+
+float AudioBuffer::getPeakAmplitude(ThreadPool* pool) const {
+  if (frameCount_ == 0) return 0.0f;
+
+  if (mappedSamples_) {
+    float peak = 0.0f;
+
+    forEachMappedBlock(mappedSamples_, mappedFormat_, frameCount_ * channels_, channels_, [&](const float* block, size_t count) {
+      peak = std::max(peak, SampleKernels::peak(block, count));
+    });
+    return peak;
+  }
+
+  return SampleKernels::peak(data_->data(), data_->size(), pool);
 }
 
-float AudioBuffer::getPeakAmplitude() const {
-  if (data_.empty()) return 0.0f;
+float AudioBuffer::getRMSAmplitude(ThreadPool* pool) const {
+  if (frameCount_ == 0) return 0.0f;
 
-  float peak = 0.0f;
+  double sum = 0.0;
 
-  for (float sample : data_) {
-    peak = std::max(peak, std::abs(sample));
+  if (mappedSamples_) {
+    forEachMappedBlock(mappedSamples_, mappedFormat_, frameCount_ * channels_, channels_, [&](const float* block, size_t count) {
+      sum += SampleKernels::sumSquares(block, count);
+    });
   }
-  return peak;
+  else {
+    sum = SampleKernels::sumSquares(data_->data(), data_->size(), pool);
+  }
+
+  // Planar padding is zero, so only real samples count towards the mean
+  return static_cast<float>(std::sqrt(sum / (frameCount_ * channels_)));
 }
 
-float AudioBuffer::getRMSAmplitude() const {
-  if (data_.empty()) return 0.0f;
+void AudioBuffer::getLevels(float& peak, float& rms, ThreadPool* pool) const {
+  if (!mappedSamples_) {
+    peak = getPeakAmplitude(pool);
+    rms = getRMSAmplitude(pool);
+    return;
+  }
+
+  peak = 0.0f;
+  double sum = 0.0;
+
+  forEachMappedBlock(mappedSamples_, mappedFormat_, frameCount_ * channels_, channels_, [&](const float* block, size_t count) {
+    peak = std::max(peak, SampleKernels::peak(block, count));
+    sum += SampleKernels::sumSquares(block, count);
+  });
+
+  rms = frameCount_ > 0 ? static_cast<float>(std::sqrt(sum / (frameCount_ * channels_))) : 0.0f;
+}
 
-  float sum = 0.0f;
+float AudioBuffer::getDCOffset(size_t channel, ThreadPool* pool) const {
+  if (frameCount_ == 0 || channel >= channels_) return 0.0f;
 
-  for (float sample : data_) {
-    sum += sample * sample;
+  std::vector<double> sums(channels_, 0.0);
+
+  if (mappedSamples_) {
+    forEachMappedBlock(mappedSamples_, mappedFormat_, frameCount_ * channels_, channels_, [&](const float* block, size_t count) {
+      SampleKernels::sumChannels(block, count / channels_, channels_, sums.data());
+    });
+  }
+  else if (layout_ == SampleLayout::Planar) {
+    SampleKernels::sumChannels(data_->data() + channel * planarStride_, frameCount_, 1, &sums[channel], pool);
   }
-  return std::sqrt(sum / data_.size());
-}
\ No newline at end of file
+  else {
+    SampleKernels::sumChannels(data_->data(), frameCount_, channels_, sums.data(), pool);
+  }
+
+  return static_cast<float>(sums[channel] / frameCount_);
+}
+
+float AudioBuffer::getCrestFactor(ThreadPool* pool) const {
+  float peak, rms;
+  getLevels(peak, rms, pool);
+  return rms > 0.0f ? peak / rms : 0.0f;
+}
@@ -0,0 +1,46 @@
+#include "audio/AudioEffect.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+  // Frames per block when processing a whole buffer offline
+  const size_t kOfflineBlockFrames = 64 * 1024;
+}
+
+void AudioEffect::prepare(size_t sampleRate, size_t maxBlockFrames, size_t channels) {
+  sampleRate_ = sampleRate;
+  maxBlockFrames_ = maxBlockFrames;
+  channels_ = channels;
+}
+
+void AudioEffect::process(AudioBuffer& buffer) {
+  if (!enabled_) return;
+
+  size_t frameCount = buffer.getFrameCount();
+  size_t channels = buffer.getChannelCount();
+
+  prepare(buffer.getSampleRate(), std::min(frameCount, kOfflineBlockFrames), channels);
+
+  if (buffer.getLayout() == SampleLayout::Interleaved) {
+    float* samples = buffer.getData();
+
+    for (size_t frame = 0; frame < frameCount; frame += kOfflineBlockFrames) {
+      size_t frames = std::min(kOfflineBlockFrames, frameCount - frame);
+      processBlock(samples + frame * channels, frames);
+    }
+    return;
+  }
+
+  // Blocks are interleaved, so planar buffers go through a staging block
+  AudioBufferView view = buffer.getView();
+  std::vector<float> block(std::min(frameCount, kOfflineBlockFrames) * channels);
+
+  for (size_t frame = 0; frame < frameCount; frame += kOfflineBlockFrames) {
+    size_t frames = std::min(kOfflineBlockFrames, frameCount - frame);
+    AudioBufferView staging(block.data(), frames, channels);
+
+    copyFrames(view.getFrames(frame, frames), staging);
+    processBlock(block.data(), frames);
+    copyFrames(staging, view.getFrames(frame, frames));
+  }
+}
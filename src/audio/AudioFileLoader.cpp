@@ -1,65 +1,89 @@
 #include "audio/AudioFileLoader.h"
+#include "audio/MappedFile.h"
+#include "audio/Resampler.h"
+#include "audio/SampleConversion.h"
+#include "audio/WavIndexCache.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <cstring>
+#include <vector>
 
-AudioFileLoader::AudioFileLoader() {}
+namespace {
+  // Samples converted per read when streaming the data chunk into a buffer
+  const size_t kReadChunkSamples = 64 * 1024;
+}
 
-bool AudioFileLoader::loadWavFile(const std::string& filename, AudioBuffer& buffer) {
-  std::cout << "Starting to load WAV file: " << filename << std::endl;
+AudioFileLoader::AudioFileLoader()
+  : loadMode_(LoadMode::Buffered), verbose_(true), targetSampleRate_(0), resamplePool_(nullptr) {}
 
-  int sampleRate, channels, frameCount;
+bool AudioFileLoader::loadWavFile(const std::string& filename, AudioBuffer& buffer) {
+  if (verbose_) {
+    std::cout << "Starting to load WAV file: " << filename
+              << (loadMode_ == LoadMode::Mapped ? " (mapped)" : "") << std::endl;
+  }
 
-  std::cout << "Reading WAV header..." << std::endl;
+  bool loaded = loadMode_ == LoadMode::Mapped
+    ? loadMapped(filename, buffer)
+    : loadBuffered(filename, buffer);
 
-  if (!readWavHeader(filename, sampleRate, channels, frameCount)) {
-    std::cerr << "Failed to read WAV header from: " << filename << std::endl;
+  if (!loaded) {
+    std::cerr << "Failed to load WAV file: " << filename << std::endl;
     return false;
   }
 
-  std::cout << "Header read successfully:" << std::endl;
-  std::cout << "  Sample Rate: " << sampleRate << " Hz" << std::endl;
-  std::cout << "  Channels: " << channels << std::endl;
-  std::cout << "  Frame Count: " << frameCount << std::endl;
-  std::cout << "  Duration: " << (float) frameCount / sampleRate << " seconds" << std::endl;
-
-  // Initialize buffer with file parameters
-  std::cout << "Initializing audio buffer..." << std::endl;
-  buffer = AudioBuffer(sampleRate, channels);
-  buffer.resize(frameCount);
-
-  std::cout << "Reading WAV data..." << std::endl;
-
-  if (!readWavData(filename, buffer)) {
-    std::cerr << "Failed to read WAV data from: " << filename << std::endl;
-    return false;
+  if (targetSampleRate_ > 0 && buffer.getSampleRate() != targetSampleRate_) {
+    if (verbose_) {
+      std::cout << "Resampling " << buffer.getSampleRate() << " Hz to " << targetSampleRate_ << " Hz" << std::endl;
+    }
+    buffer = Resampler::convert(buffer, targetSampleRate_, resamplePool_);
   }
 
+  if (!verbose_) return true;
+
   std::cout << "WAV file loaded successfully!" << std::endl;
+  std::cout << "  Sample Rate: " << buffer.getSampleRate() << " Hz" << std::endl;
+  std::cout << "  Channels: " << buffer.getChannelCount() << std::endl;
+  std::cout << "  Frame Count: " << buffer.getFrameCount() << std::endl;
+  std::cout << "  Duration: " << (float) buffer.getFrameCount() / buffer.getSampleRate() << " seconds" << std::endl;
 
   return true;
 }
 
 bool AudioFileLoader::canLoadFile(const std::string& filename) const {
-  std::ifstream file(filename, std::ios::binary);
+  WavChunkIndex index;
+  return getChunkIndex(filename, index);
+}
 
-  if (!file.is_open()) {
+bool AudioFileLoader::getFileInfo(const std::string& filename, int& sampleRate, int& channels, int& frameCount) const {
+  WavInfo info;
+
+  if (!getWavInfo(filename, info)) {
     return false;
   }
 
-  char header[12];
-  file.read(header, 12);
-  file.close();
-
-  // Check for "RIFF" and "WAVE" identifiers
-  return (strncmp(header, "RIFF", 4) == 0 && strncmp(header + 8, "WAVE", 4) == 0);
+  sampleRate = static_cast<int>(info.sampleRate);
+  channels = info.channels;
+  frameCount = static_cast<int>(info.frameCount);
+  return true;
 }
 
-bool AudioFileLoader::getFileInfo(const std::string& filename, int& sampleRate, int& channels, int& frameCount) const {
-  return readWavHeader(filename, sampleRate, channels, frameCount);
+bool AudioFileLoader::getWavInfo(const std::string& filename, WavInfo& info) const {
+  WavChunkIndex index;
+
+  if (!getChunkIndex(filename, index)) {
+    return false;
+  }
+
+  info = index.info;
+  return true;
 }
 
-bool AudioFileLoader::readWavHeader(const std::string& filename, int& sampleRate, int& channels, int& frameCount) const {
+bool AudioFileLoader::getChunkIndex(const std::string& filename, WavChunkIndex& index) const {
+  if (findIndex(filename, index)) {
+    return true;
+  }
+
   std::ifstream file(filename, std::ios::binary);
 
   if (!file.is_open()) {
@@ -67,173 +91,160 @@ bool AudioFileLoader::readWavHeader(const std::string& filename, int& sampleRate
     return false;
   }
 
-  // Read RIFF header
-  char riffHeader[12];
-  file.read(riffHeader, 12);
-
-  if (strncmp(riffHeader, "RIFF", 4) != 0 || strncmp(riffHeader + 8, "WAVE", 4) != 0) {
-    std::cerr << "Not a valid WAV file: " << filename << std::endl;
+  if (!WavChunkIndex::build(file, index)) {
     return false;
   }
 
-  std::cout << "WAV file header valid" << std::endl;
+  rememberIndex(filename, index);
+  return true;
+}
 
-  // Parse chunks sequentially
-  char chunkId[4];
-  uint32_t chunkSize;
-  bool formatFound = false;
-  bool dataFound = false;
+bool AudioFileLoader::parseWavChunks(const ReadAtFunction& readAt, WavInfo& info) {
+  WavChunkIndex index;
 
-  while (!file.eof() && (!formatFound || !dataFound)) {
-    if (file.read(chunkId, 4).gcount() != 4) break;
+  if (!WavChunkIndex::build(readAt, index)) {
+    return false;
+  }
 
-    if (file.read(reinterpret_cast<char*>(&chunkSize), 4).gcount() != 4) break;
+  info = index.info;
+  return true;
+}
 
-    std::cout << "Found chunk: " << std::string(chunkId, 4) << " (size: " << chunkSize << ")" << std::endl;
+bool AudioFileLoader::parseWavChunks(std::istream& file, WavInfo& info) {
+  WavChunkIndex index;
 
-    if (strncmp(chunkId, "fmt ", 4) == 0) {
-      formatFound = true;
+  if (!WavChunkIndex::build(file, index)) {
+    return false;
+  }
 
-      uint16_t audioFormat, numChannels, bitsPerSample;
-      uint32_t sampleRateValue, byteRate;
-      uint16_t blockAlign;
+  info = index.info;
+  return true;
+}
 
-      file.read(reinterpret_cast<char*>(&audioFormat), 2);
-      file.read(reinterpret_cast<char*>(&numChannels), 2);
-      file.read(reinterpret_cast<char*>(&sampleRateValue), 4);
-      file.read(reinterpret_cast<char*>(&byteRate), 4);
-      file.read(reinterpret_cast<char*>(&blockAlign), 2);
-      file.read(reinterpret_cast<char*>(&bitsPerSample), 2);
+bool AudioFileLoader::checkDataSize(const WavInfo& info, uint64_t fileSize) {
+  uint64_t availableFrames = (fileSize - std::min(info.dataOffset, fileSize)) / info.blockAlign;
 
-      std::cout << "Format chunk: format=" << audioFormat << ", channels=" << numChannels
-                << ", sampleRate=" << sampleRateValue << ", bitsPerSample=" << bitsPerSample << std::endl;
+  if (availableFrames < info.frameCount) {
+    std::cerr << "Data chunk is truncated: " << availableFrames << " of "
+              << info.frameCount << " frames present" << std::endl;
+    return false;
+  }
+  return true;
+}
 
-      if (audioFormat != 1) {       // PCM format
-        std::cerr << "Unsupported audio format (not PCM): " << audioFormat << std::endl;
-        return false;
-      }
+bool AudioFileLoader::checkDataSize(const WavInfo& info, std::istream& file) {
+  file.clear();
+  file.seekg(0, std::ios::end);
+  std::streamoff fileSize = file.tellg();
 
-      if (bitsPerSample != 16) {
-        std::cerr << "Unsupported bit depth (not 16-bit): " << bitsPerSample << std::endl;
-        return false;
-      }
+  return fileSize >= 0 && checkDataSize(info, static_cast<uint64_t>(fileSize));
+}
 
-      sampleRate = sampleRateValue;
-      channels = numChannels;
+bool AudioFileLoader::findIndex(const std::string& filename, WavChunkIndex& index) const {
+  return indexCache_ && indexCache_->lookup(filename, index);
+}
 
-      // Skip remaining format chunk data
-      if (chunkSize > 16) {
-        file.seekg(chunkSize - 16, std::ios::cur);
-      }
-    }
-    else if (strncmp(chunkId, "data", 4) == 0) {
-      dataFound = true;
-      frameCount = chunkSize / (channels * sizeof(int16_t));       // 16-bit PCM
-      std::cout << "Data chunk found. Frame count: " << frameCount << std::endl;
-      break;       // Found data chunk, we can stop
-    }
-    else {
-      // Skip this chunk
-      file.seekg(chunkSize, std::ios::cur);
-    }
+void AudioFileLoader::rememberIndex(const std::string& filename, const WavChunkIndex& index) const {
+  if (indexCache_) {
+    indexCache_->store(filename, index);
   }
-
-  file.close();
-  return formatFound && dataFound;
 }
 
-bool AudioFileLoader::readWavData(const std::string& filename, AudioBuffer& buffer) const {
+bool AudioFileLoader::loadBuffered(const std::string& filename, AudioBuffer& buffer) const {
   std::ifstream file(filename, std::ios::binary);
 
   if (!file.is_open()) {
+    std::cerr << "Cannot open file: " << filename << std::endl;
     return false;
   }
 
-  // Read RIFF header
-  char riffHeader[12];
-  file.read(riffHeader, 12);
+  // The file is open either way, so a cache miss is indexed from it
+  WavChunkIndex index;
+
+  if (!findIndex(filename, index)) {
+    if (!WavChunkIndex::build(file, index)) {
+      return false;
+    }
+    rememberIndex(filename, index);
+  }
 
-  if (strncmp(riffHeader, "RIFF", 4) != 0 || strncmp(riffHeader + 8, "WAVE", 4) != 0) {
-    std::cerr << "Not a valid WAV file" << std::endl;
+  if (!checkDataSize(index.info, file)) {
     return false;
   }
 
-  // Parse chunks sequentially
-  char chunkId[4];
-  uint32_t chunkSize;
-  bool formatFound = false;
-  bool dataFound = false;
+  // Initialize buffer with file parameters
+  buffer = AudioBuffer(index.info.sampleRate, index.info.channels);
+  buffer.resize(index.info.frameCount);
+
+  return readWavData(file, index.info, buffer);
+}
+
+bool AudioFileLoader::loadMapped(const std::string& filename, AudioBuffer& buffer) const {
+  auto mapping = std::make_shared<MappedFile>();
 
-  while (!file.eof() && (!formatFound || !dataFound)) {
-    if (file.read(chunkId, 4).gcount() != 4) break;
+  if (!mapping->open(filename)) {
+    return false;
+  }
 
-    if (file.read(reinterpret_cast<char*>(&chunkSize), 4).gcount() != 4) break;
+  const uint8_t* base = mapping->data();
+  size_t size = mapping->size();
 
-    if (strncmp(chunkId, "fmt ", 4) == 0) {
-      formatFound = true;
+  auto readAt = [base, size](uint64_t offset, void* dest, size_t bytes) {
+    if (offset > size || bytes > size - offset) return false;
 
-      uint16_t audioFormat, numChannels, bitsPerSample;
-      uint32_t sampleRateValue, byteRate;
-      uint16_t blockAlign;
+    std::memcpy(dest, base + offset, bytes);
+    return true;
+  };
 
-      file.read(reinterpret_cast<char*>(&audioFormat), 2);
-      file.read(reinterpret_cast<char*>(&numChannels), 2);
-      file.read(reinterpret_cast<char*>(&sampleRateValue), 4);
-      file.read(reinterpret_cast<char*>(&byteRate), 4);
-      file.read(reinterpret_cast<char*>(&blockAlign), 2);
-      file.read(reinterpret_cast<char*>(&bitsPerSample), 2);
+  WavChunkIndex index;
 
-      // Skip remaining format chunk data
-      if (chunkSize > 16) {
-        file.seekg(chunkSize - 16, std::ios::cur);
-      }
+  if (!findIndex(filename, index)) {
+    if (!WavChunkIndex::build(readAt, index)) {
+      return false;
     }
-    else if (strncmp(chunkId, "data", 4) == 0) {
-      dataFound = true;
+    rememberIndex(filename, index);
+  }
 
-      // Read audio data
-      size_t frameCount = buffer.getFrameCount();
-      size_t channelCount = buffer.getChannelCount();
+  const WavInfo& info = index.info;
 
-      std::cout << "Reading " << frameCount << " frames with " << channelCount << " channels..." << std::endl;
-      std::cout << "Total samples to read: " << frameCount * channelCount << std::endl;
+  if (!checkDataSize(info, size)) {
+    return false;
+  }
 
-      // Read all data at once for better performance
-      size_t totalSamples = frameCount * channelCount;
-      std::vector<int16_t> rawSamples(totalSamples);
+  buffer = AudioBuffer(info.sampleRate, info.channels);
+  buffer.attachMapped(std::move(mapping), base + info.dataOffset, info.frameCount, info.sampleFormat);
+  return true;
+}
 
-      std::cout << "Allocating " << totalSamples * sizeof(int16_t) << " bytes..." << std::endl;
+bool AudioFileLoader::readWavData(std::istream& file, const WavInfo& info, AudioBuffer& buffer) const {
+  size_t channelCount = buffer.getChannelCount();
+  size_t totalSamples = buffer.getFrameCount() * channelCount;
 
-      std::cout << "Starting file read..." << std::endl;
-      file.read(reinterpret_cast<char*>(rawSamples.data()), totalSamples * sizeof(int16_t));
-      std::cout << "File read completed. Bytes read: " << file.gcount() << std::endl;
+  file.clear();
+  file.seekg(static_cast<std::streamoff>(info.dataOffset), std::ios::beg);
 
-      if (static_cast<size_t>(file.gcount()) != totalSamples * sizeof(int16_t)) {
-        std::cerr << "Failed to read all audio data" << std::endl;
-        return false;
-      }
+  // Convert through a fixed-size staging block instead of holding the whole
+  // raw data chunk next to the converted buffer
+  const size_t bytesPerSample = SampleConversion::getBytesPerSample(info.sampleFormat);
+  std::vector<uint8_t> rawSamples(std::min(totalSamples, kReadChunkSamples) * bytesPerSample);
+  float* output = buffer.getData();
+  size_t samplesDone = 0;
 
-      std::cout << "Loading progress: 50% - Data read, converting to float..." << std::endl;
+  while (samplesDone < totalSamples) {
+    size_t samplesToRead = std::min(rawSamples.size() / bytesPerSample, totalSamples - samplesDone);
+    size_t bytesToRead = samplesToRead * bytesPerSample;
 
-      // Convert 16-bit PCM to float and copy to buffer
-      for (size_t frame = 0; frame < frameCount; ++frame) {
-        for (size_t channel = 0; channel < channelCount; ++channel) {
-          size_t sampleIndex = frame * channelCount + channel;
-          // Convert 16-bit PCM to float (-1.0 to 1.0 range)
-          float sample = static_cast<float>(rawSamples[sampleIndex]) / 32768.0f;
-          buffer.setSample(frame, channel, sample);
-        }
-      }
+    file.read(reinterpret_cast<char*>(rawSamples.data()), bytesToRead);
 
-      std::cout << "Loading progress: 100%" << std::endl;
-      break;       // Found data chunk, we can stop
-    }
-    else {
-      // Skip this chunk
-      file.seekg(chunkSize, std::ios::cur);
+    if (static_cast<size_t>(file.gcount()) != bytesToRead) {
+      std::cerr << "Failed to read all audio data" << std::endl;
+      return false;
     }
+
+    // Convert to float (-1.0 to 1.0 range)
+    SampleConversion::toFloat(info.sampleFormat, rawSamples.data(), output + samplesDone, samplesToRead);
+    samplesDone += samplesToRead;
   }
 
-  file.close();
-  return formatFound && dataFound;
+  return true;
 }
\ No newline at end of file
@@ -0,0 +1,386 @@
+#include "audio/AudioFileWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+  // Unit of every write while direct I/O is on; also the buffer alignment
+  const size_t kBlockBytes = 4096;
+
+  const size_t kDefaultBufferBytes = 4 * 1024 * 1024;
+
+  // Frames dithered and converted per step
+  const size_t kStagingFrames = 4096;
+
+  // RIFF header, JUNK placeholder for ds64, then the fmt chunk
+  const size_t kRiffBytes = 12;
+  const size_t kJunkBytes = 36;
+  const size_t kDs64PayloadBytes = 28;
+
+  const uint32_t kUnknownSize = 0xFFFFFFFFu;
+
+  void putValue(uint8_t* dest, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+      dest[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+  }
+
+  size_t roundUpToBlock(size_t bytes) {
+    return (bytes + kBlockBytes - 1) / kBlockBytes * kBlockBytes;
+  }
+}
+
+AudioFileWriter::AudioFileWriter()
+  : format_(SampleFormat::Int16), dither_(true), directIo_(false), bufferSize_(kDefaultBufferBytes),
+  sampleRate_(0), channels_(0), headerBytes_(0), framesWritten_(0), fileOffset_(0),
+  open_(false), rf64_(false), failed_(false), buffered_(0)
+#ifdef _WIN32
+  , fileHandle_(INVALID_HANDLE_VALUE)
+#else
+  , fd_(-1)
+#endif
+{}
+
+AudioFileWriter::~AudioFileWriter() {
+  if (open_) close();
+}
+
+void AudioFileWriter::setBufferSize(size_t bytes) {
+  bufferSize_ = roundUpToBlock(std::max<size_t>(bytes, 1));
+}
+
+std::vector<uint8_t> AudioFileWriter::buildHeader(uint64_t dataSize) const {
+  bool isFloat = format_ == SampleFormat::Float32;
+  size_t bytesPerSample = SampleConversion::getBytesPerSample(format_);
+  uint32_t blockAlign = static_cast<uint32_t>(channels_ * bytesPerSample);
+  uint64_t frames = blockAlign ? dataSize / blockAlign : 0;
+
+  // The data chunk is padded to an even size
+  uint64_t riffSize = headerBytes_ - 8 + dataSize + (dataSize & 1);
+  bool rf64 = riffSize > std::numeric_limits<uint32_t>::max();
+
+  std::vector<uint8_t> header(headerBytes_, 0);
+  uint8_t* p = header.data();
+
+  std::memcpy(p, rf64 ? "RF64" : "RIFF", 4);
+  putValue(p + 4, rf64 ? kUnknownSize : riffSize, 4);
+  std::memcpy(p + 8, "WAVE", 4);
+  p += kRiffBytes;
+
+  std::memcpy(p, rf64 ? "ds64" : "JUNK", 4);
+  putValue(p + 4, kDs64PayloadBytes, 4);
+
+  if (rf64) {
+    putValue(p + 8, riffSize, 8);
+    putValue(p + 16, dataSize, 8);
+    putValue(p + 24, frames, 8);
+    // Table of other oversized chunks stays empty
+  }
+  p += kJunkBytes;
+
+  // IEEE float carries the cbSize field and a fact chunk, as non-PCM
+  // formats require
+  std::memcpy(p, "fmt ", 4);
+  putValue(p + 4, isFloat ? 18 : 16, 4);
+  putValue(p + 8, isFloat ? 3 : 1, 2);
+  putValue(p + 10, channels_, 2);
+  putValue(p + 12, sampleRate_, 4);
+  putValue(p + 16, sampleRate_ * blockAlign, 4);
+  putValue(p + 20, blockAlign, 2);
+  putValue(p + 22, bytesPerSample * 8, 2);
+  p += isFloat ? 26 : 24;
+
+  if (isFloat) {
+    std::memcpy(p, "fact", 4);
+    putValue(p + 4, 4, 4);
+    putValue(p + 8, std::min<uint64_t>(frames, kUnknownSize), 4);
+    p += 12;
+  }
+
+  std::memcpy(p, "data", 4);
+  putValue(p + 4, rf64 ? kUnknownSize : dataSize, 4);
+  return header;
+}
+
+bool AudioFileWriter::open(const std::string& filename, size_t sampleRate, size_t channels) {
+  if (open_) close();
+
+  if (channels == 0 || channels > 0xFFFF || sampleRate == 0) {
+    std::cerr << "Cannot write WAV file with " << channels << " channels at " << sampleRate << " Hz: "
+              << filename << std::endl;
+    return false;
+  }
+
+  filename_ = filename;
+  sampleRate_ = sampleRate;
+  channels_ = channels;
+  headerBytes_ = kRiffBytes + kJunkBytes + (format_ == SampleFormat::Float32 ? 26 + 12 : 24) + 8;
+  framesWritten_ = 0;
+  fileOffset_ = 0;
+  rf64_ = false;
+  failed_ = false;
+  ditherState_ = SampleConversion::DitherState();
+
+  // Room past a full buffer for the last frame converted and the pad byte
+  size_t frameBytes = channels_ * SampleConversion::getBytesPerSample(format_);
+  buffer_.resize(bufferSize_ + roundUpToBlock(frameBytes + 1));
+  staging_.resize(kStagingFrames * channels_);
+
+  // Sizes stay zero until close(), so an interrupted render reads as empty
+  std::vector<uint8_t> header = buildHeader(0);
+  std::memcpy(buffer_.data(), header.data(), header.size());
+  buffered_ = header.size();
+
+  if (!openFile(filename)) {
+    std::cerr << "Cannot create file: " << filename << std::endl;
+    return false;
+  }
+
+  open_ = true;
+  return true;
+}
+
+bool AudioFileWriter::write(const float* samples, size_t frames) {
+  return write(ConstAudioBufferView(samples, frames, channels_));
+}
+
+bool AudioFileWriter::write(ConstAudioBufferView frames) {
+  if (!open_ || failed_) return false;
+
+  if (frames.getChannelCount() != channels_ && !frames.isEmpty()) {
+    std::cerr << "Cannot write " << frames.getChannelCount() << " channels to a " << channels_
+              << "-channel file: " << filename_ << std::endl;
+    return false;
+  }
+
+  size_t frameBytes = channels_ * SampleConversion::getBytesPerSample(format_);
+  size_t count = frames.getFrameCount();
+  bool dither = dither_ && (format_ == SampleFormat::Int16 || format_ == SampleFormat::Int24);
+
+  for (size_t done = 0; done < count;) {
+    size_t room = (buffer_.size() - buffered_) / frameBytes;
+    size_t step = std::min({ count - done, room, kStagingFrames });
+    size_t samples = step * channels_;
+
+    // Interleave into staging; the caller's samples are never modified
+    copyFrames(frames.getFrames(done, step), AudioBufferView(staging_.data(), step, channels_));
+
+    if (dither) {
+      SampleConversion::addDither(format_, staging_.data(), samples, ditherState_);
+    }
+
+    SampleConversion::fromFloat(format_, staging_.data(), buffer_.data() + buffered_, samples);
+    buffered_ += step * frameBytes;
+    framesWritten_ += step;
+    done += step;
+
+    if (buffered_ >= bufferSize_ && !writeBlocks()) return false;
+  }
+  return true;
+}
+
+bool AudioFileWriter::writeBlocks() {
+  size_t bytes = buffered_ / kBlockBytes * kBlockBytes;
+
+  if (!writeAt(fileOffset_, buffer_.data(), bytes)) {
+    return fail("Failed to write WAV file");
+  }
+
+  // Keep the partial block for the next write, so every write stays aligned
+  fileOffset_ += bytes;
+  buffered_ -= bytes;
+  std::memmove(buffer_.data(), buffer_.data() + bytes, buffered_);
+  return true;
+}
+
+bool AudioFileWriter::close() {
+  if (!open_) return false;
+
+  uint64_t dataSize = framesWritten_ * channels_ * SampleConversion::getBytesPerSample(format_);
+
+  if (dataSize & 1) {
+    buffer_[buffered_++] = 0;
+  }
+
+  bool ok = !failed_;
+
+  // The tail is not a whole block, which direct I/O cannot write
+  if (ok) {
+    disableDirectIo();
+    ok = writeAt(fileOffset_, buffer_.data(), buffered_);
+  }
+
+  if (ok) {
+    std::vector<uint8_t> header = buildHeader(dataSize);
+    rf64_ = std::memcmp(header.data(), "RF64", 4) == 0;
+    ok = writeAt(0, header.data(), header.size());
+  }
+
+  ok = closeFile() && ok;
+  open_ = false;
+  buffered_ = 0;
+
+  if (!ok && !failed_) {
+    std::cerr << "Failed to write WAV file: " << filename_ << std::endl;
+  }
+  return ok;
+}
+
+bool AudioFileWriter::writeWavFile(const std::string& filename, const AudioBuffer& buffer) {
+  size_t channels = buffer.getChannelCount();
+  size_t frameCount = buffer.getFrameCount();
+
+  if (!open(filename, buffer.getSampleRate(), channels)) return false;
+
+  ConstAudioBufferView view = buffer.getView();
+  bool ok = true;
+
+  if (!view.isEmpty()) {
+    ok = write(view);
+  }
+  else {
+    // Mapped storage converts per sample
+    std::vector<float> block(std::min(frameCount, kStagingFrames) * channels);
+
+    for (size_t frame = 0; frame < frameCount && ok; frame += kStagingFrames) {
+      size_t frames = std::min(kStagingFrames, frameCount - frame);
+
+      for (size_t i = 0; i < frames; ++i) {
+        for (size_t channel = 0; channel < channels; ++channel) {
+          block[i * channels + channel] = buffer.getSample(frame + i, channel);
+        }
+      }
+      ok = write(block.data(), frames);
+    }
+  }
+
+  return close() && ok;
+}
+
+bool AudioFileWriter::fail(const char* message) {
+  std::cerr << message << ": " << filename_ << std::endl;
+  failed_ = true;
+  return false;
+}
+
+#ifdef _WIN32
+
+// FILE_FLAG_NO_BUFFERING cannot be dropped for the unaligned tail once a
+// handle is open, so Windows always writes through the cache
+
+bool AudioFileWriter::openFile(const std::string& filename) {
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+  if (file == INVALID_HANDLE_VALUE) return false;
+
+  fileHandle_ = file;
+  return true;
+}
+
+bool AudioFileWriter::writeAt(uint64_t offset, const uint8_t* data, size_t bytes) {
+  while (bytes > 0) {
+    OVERLAPPED position = {};
+    position.Offset = static_cast<DWORD>(offset);
+    position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+    DWORD chunk = static_cast<DWORD>(std::min<size_t>(bytes, 1u << 30));
+    DWORD written = 0;
+
+    if (!WriteFile(fileHandle_, data, chunk, &written, &position) || written == 0) return false;
+
+    data += written;
+    bytes -= written;
+    offset += written;
+  }
+  return true;
+}
+
+void AudioFileWriter::disableDirectIo() {}
+
+bool AudioFileWriter::closeFile() {
+  if (fileHandle_ == INVALID_HANDLE_VALUE) return true;
+
+  bool ok = CloseHandle(fileHandle_) != 0;
+  fileHandle_ = INVALID_HANDLE_VALUE;
+  return ok;
+}
+
+#else
+
+bool AudioFileWriter::openFile(const std::string& filename) {
+  int flags = O_WRONLY | O_CREAT | O_TRUNC;
+
+#ifdef O_DIRECT
+  // Filesystems without direct I/O (e.g. tmpfs) refuse the flag
+  if (directIo_) {
+    fd_ = ::open(filename.c_str(), flags | O_DIRECT, 0644);
+  }
+#endif
+
+  if (fd_ < 0) {
+    fd_ = ::open(filename.c_str(), flags, 0644);
+  }
+
+#ifdef F_NOCACHE
+  if (fd_ >= 0 && directIo_) {
+    fcntl(fd_, F_NOCACHE, 1);
+  }
+#endif
+
+  return fd_ >= 0;
+}
+
+bool AudioFileWriter::writeAt(uint64_t offset, const uint8_t* data, size_t bytes) {
+  while (bytes > 0) {
+    ssize_t written = pwrite(fd_, data, bytes, static_cast<off_t>(offset));
+
+    if (written < 0) {
+      if (errno == EINTR) continue;
+
+#ifdef O_DIRECT
+      // Some filesystems accept O_DIRECT at open but reject the writes
+      if (errno == EINVAL && (fcntl(fd_, F_GETFL) & O_DIRECT)) {
+        disableDirectIo();
+        continue;
+      }
+#endif
+      return false;
+    }
+
+    data += written;
+    bytes -= static_cast<size_t>(written);
+    offset += static_cast<uint64_t>(written);
+  }
+  return true;
+}
+
+void AudioFileWriter::disableDirectIo() {
+#ifdef O_DIRECT
+  int flags = fcntl(fd_, F_GETFL);
+
+  if (flags >= 0 && (flags & O_DIRECT)) {
+    fcntl(fd_, F_SETFL, flags & ~O_DIRECT);
+  }
+#endif
+}
+
+bool AudioFileWriter::closeFile() {
+  if (fd_ < 0) return true;
+
+  bool ok = ::close(fd_) == 0;
+  fd_ = -1;
+  return ok;
+}
+
+#endif
@@ -3,149 +3,722 @@
 #include <algorithm>
 #include <cmath>
 
+namespace {
+  // Shared pointers that reference a caller-owned object without owning it
+  template <typename T>
+  std::shared_ptr<T> borrow(T& object) {
+    return std::shared_ptr<T>(std::shared_ptr<void>(), &object);
+  }
+
+  // Source channels that fit one block of scratch without splitting it
+  const size_t kSourceBlockChannels = 8;
+
+  size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  // Device formats the callback converts to itself (little-endian only)
+  bool toSampleFormat(SDL_AudioFormat format, SampleFormat& sampleFormat) {
+    switch (format) {
+      case AUDIO_F32LSB: sampleFormat = SampleFormat::Float32; return true;
+      case AUDIO_S32LSB: sampleFormat = SampleFormat::Int32; return true;
+      case AUDIO_S16LSB: sampleFormat = SampleFormat::Int16; return true;
+      default: return false;
+    }
+  }
+}
+
 AudioPlayer::AudioPlayer()
-  : deviceId_(0), audioBuffer_(nullptr), playing_(false), paused_(false),
-  currentFrame_(0), volume_(1.0f), duration_(0.0f),
-  sampleRate_(44100), channels_(2), format_(AUDIO_F32) {}
+  : deviceId_(0), offline_(false), resamplerQuality_(Resampler::Quality::Standard), sourceFrameCount_(0), playGeneration_(0), playing_(false), paused_(false),
+  volume_(1.0f), duration_(0.0f),
+  rtPlaying_(false), rtPaused_(false), rtVolume_(1.0f), rtGeneration_(0),
+  rtLastCallbackStart_(0), currentFrame_(0), finishedGeneration_(0),
+  sampleRate_(44100), channels_(2), blockFrames_(1024), format_(AUDIO_F32),
+  deviceSampleFormat_(SampleFormat::Float32) {}
 
 AudioPlayer::~AudioPlayer() {
   shutdown();
 }
 
+AudioPlayer::DeviceConfig AudioPlayer::DeviceConfig::lowLatency(size_t periodFrames) {
+  DeviceConfig config;
+  config.periodFrames = std::max(kMinLowLatencyFrames, std::min(kMaxLowLatencyFrames, periodFrames));
+  config.allowedChanges = SDL_AUDIO_ALLOW_SAMPLES_CHANGE | SDL_AUDIO_ALLOW_FORMAT_CHANGE;
+  return config;
+}
+
 bool AudioPlayer::initialize(int sampleRate, int channels) {
+  DeviceConfig config;
+  config.sampleRate = sampleRate;
+  config.channels = channels;
+  return initialize(config);
+}
+
+bool AudioPlayer::initialize(const DeviceConfig& config) {
+  if (deviceId_ != 0 || offline_) {
+    shutdown();
+  }
+
   if (SDL_Init(SDL_INIT_AUDIO) < 0) {
     std::cerr << "SDL audio could not initialize: " << SDL_GetError() << std::endl;
     return false;
   }
 
-  sampleRate_ = sampleRate;
-  channels_ = channels;
-
   SDL_AudioSpec desired, obtained;
   SDL_zero(desired);
-  desired.freq = sampleRate_;
-  desired.format = format_;
-  desired.channels = channels_;
-  desired.samples = 1024;   // Buffer size
+  desired.freq = config.sampleRate;
+  desired.format = config.format;
+  desired.channels = static_cast<Uint8>(config.channels);
+  desired.samples = static_cast<Uint16>(roundUpToPowerOfTwo(config.periodFrames));
   desired.callback = audioCallback;
   desired.userdata = this;
 
-  deviceId_ = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained, 0);
+  const char* deviceName = config.deviceName.empty() ? nullptr : config.deviceName.c_str();
+  int allowedChanges = config.allowedChanges;
+
+  rtLastCallbackStart_ = 0;
+  deviceId_ = SDL_OpenAudioDevice(deviceName, 0, &desired, &obtained, allowedChanges);
+
+  // A sample format the callback cannot write: let SDL convert instead
+  if (deviceId_ != 0 && !toSampleFormat(obtained.format, deviceSampleFormat_)) {
+    SDL_CloseAudioDevice(deviceId_);
+    desired.format = AUDIO_F32;
+    allowedChanges &= ~SDL_AUDIO_ALLOW_FORMAT_CHANGE;
+    deviceId_ = SDL_OpenAudioDevice(deviceName, 0, &desired, &obtained, allowedChanges);
+  }
 
   if (deviceId_ == 0) {
     std::cerr << "Failed to open audio device: " << SDL_GetError() << std::endl;
     return false;
   }
 
+  // Without an allowed change SDL converts to the requested value, so the
+  // obtained spec is what the callback sees either way
+  sampleRate_ = obtained.freq;
+  channels_ = obtained.channels;
+  blockFrames_ = obtained.samples;
+  format_ = obtained.format;
+  toSampleFormat(format_, deviceSampleFormat_);
+
+  // The device starts paused, so nothing runs the callback yet
+  rtDeviceBlock_.assign(blockFrames_ * channels_, 0.0f);
+  rtSourceBlock_.assign(blockFrames_ * kSourceBlockChannels, 0.0f);
+  resetCallbackStats();
+
+  // Nothing runs the effects yet, so all of them are prepared for the new format
+  uiPreparedEffects_.clear();
+
+  if (!uiEffects_.empty()) {
+    setEffects(uiEffects_);
+  }
+
+  if (uiSource_.buffer || uiSource_.stream) {
+    sendSource();
+  }
+
+  // The device keeps running so queued commands are always drained; the
+  // callback outputs silence while nothing is playing
+  SDL_PauseAudioDevice(deviceId_, 0);
+
   std::cout << "Audio device initialized: " << sampleRate_ << "Hz, "
-            << channels_ << " channels" << std::endl;
+            << channels_ << " channels, " << blockFrames_ << " frames ("
+            << getPeriodLatency() * 1000.0 << " ms), "
+            << SampleConversion::getFormatName(deviceSampleFormat_) << std::endl;
+
+  if (config.periodFrames <= kMaxLowLatencyFrames && blockFrames_ > kMaxLowLatencyFrames) {
+    std::cerr << "Audio device did not accept a low-latency period (requested "
+              << config.periodFrames << " frames)" << std::endl;
+  }
   return true;
 }
 
+void AudioPlayer::initializeOffline(int sampleRate, int channels, size_t blockFrames) {
+  shutdown();
+
+  sampleRate_ = sampleRate;
+  channels_ = channels;
+  blockFrames_ = blockFrames;
+  format_ = AUDIO_F32;
+  deviceSampleFormat_ = SampleFormat::Float32;
+  offline_ = true;
+
+  rtDeviceBlock_.assign(blockFrames_ * channels_, 0.0f);
+  rtSourceBlock_.assign(blockFrames_ * kSourceBlockChannels, 0.0f);
+  resetCallbackStats();
+
+  // Nothing runs the effects yet, so all of them are prepared for the new format
+  uiPreparedEffects_.clear();
+
+  if (!uiEffects_.empty()) {
+    setEffects(uiEffects_);
+  }
+
+  if (uiSource_.buffer || uiSource_.stream) {
+    sendSource();
+  }
+}
+
+std::vector<std::string> AudioPlayer::getOutputDevices() {
+  std::vector<std::string> devices;
+
+  if (SDL_Init(SDL_INIT_AUDIO) < 0) return devices;
+
+  int count = SDL_GetNumAudioDevices(0);
+
+  for (int i = 0; i < count; ++i) {
+    if (const char* name = SDL_GetAudioDeviceName(i, 0)) {
+      devices.push_back(name);
+    }
+  }
+  return devices;
+}
+
+double AudioPlayer::getPeriodLatency() const {
+  return sampleRate_ > 0 ? static_cast<double>(blockFrames_) / sampleRate_ : 0.0;
+}
+
+void AudioPlayer::renderBlock(float* output, size_t frames) {
+  if (!offline_) return;
+
+  // Offline blocks have a duration but no deadline to be late for
+  uint64_t start = CallbackStats::now();
+  fillAudioBuffer(reinterpret_cast<Uint8*>(output), static_cast<int>(frames * channels_ * sizeof(float)));
+  stats_.record(CallbackStats::now() - start, 0);
+}
+
+void AudioPlayer::resetCallbackStats() {
+  stats_.reset(blockFrames_, sampleRate_);
+}
+
 void AudioPlayer::shutdown() {
+  if ((deviceId_ != 0 || offline_) && !statsReportFile_.empty() && stats_.getSnapshot().callbacks > 0) {
+    if (stats_.writeReport(statsReportFile_)) {
+      std::cout << "Audio callback stats written to " << statsReportFile_ << std::endl;
+    }
+    else {
+      std::cerr << "Failed to write audio callback stats to " << statsReportFile_ << std::endl;
+    }
+  }
+
   if (deviceId_ != 0) {
     stop();
     SDL_CloseAudioDevice(deviceId_);
     deviceId_ = 0;
   }
+
+  offline_ = false;
+
+  // No callback can run any more; apply what is left on this thread
+  processCommands();
+  setSource(Source());
+  retire({ Source(), std::move(rtEffects_) });
+  collectRetiredSources();
+}
+
+void AudioPlayer::play(std::shared_ptr<const AudioBuffer> buffer) {
+  setAudioBuffer(std::move(buffer));
+  startPlayback();
+}
+
+void AudioPlayer::play(std::shared_ptr<const AudioBuffer> buffer,
+                       std::shared_ptr<const std::atomic<size_t>> loadedFrames) {
+  setAudioBuffer(std::move(buffer), std::move(loadedFrames));
+  startPlayback();
+}
+
+void AudioPlayer::play(std::shared_ptr<WavStreamReader> stream) {
+  setAudioStream(std::move(stream));
+  startPlayback();
 }
 
 void AudioPlayer::play(const AudioBuffer& buffer) {
-  setAudioBuffer(buffer);
+  play(borrow(buffer));
+}
 
-  if (deviceId_ == 0) {
+void AudioPlayer::play(WavStreamReader& stream) {
+  play(borrow(stream));
+}
+
+void AudioPlayer::startPlayback() {
+  if (deviceId_ == 0 && !offline_) {
     std::cerr << "Audio device not initialized" << std::endl;
     return;
   }
 
-  currentFrame_ = 0;
+  Command command;
+  command.type = Command::Type::Play;
+  command.generation = ++playGeneration_;
+
+  if (!sendCommand(std::move(command))) return;
+
   playing_ = true;
   paused_ = false;
-
-  SDL_PauseAudioDevice(deviceId_, 0);
   std::cout << "Started audio playback" << std::endl;
 }
 
 void AudioPlayer::pause() {
-  if (playing_ && !paused_) {
+  if (isPlaying() && !paused_) {
+    Command command;
+    command.type = Command::Type::Pause;
+
+    if (!sendCommand(std::move(command))) return;
+
     paused_ = true;
-    SDL_PauseAudioDevice(deviceId_, 1);
     std::cout << "Audio paused" << std::endl;
   }
 }
 
 void AudioPlayer::resume() {
-  if (playing_ && paused_) {
+  if (isPlaying() && paused_) {
+    Command command;
+    command.type = Command::Type::Resume;
+
+    if (!sendCommand(std::move(command))) return;
+
     paused_ = false;
-    SDL_PauseAudioDevice(deviceId_, 0);
     std::cout << "Audio resumed" << std::endl;
   }
 }
 
 void AudioPlayer::stop() {
-  if (playing_) {
-    playing_ = false;
-    paused_ = false;
-    currentFrame_ = 0;
-    SDL_PauseAudioDevice(deviceId_, 1);
+  bool wasPlaying = isPlaying();
+
+  Command command;
+  command.type = Command::Type::Stop;
+  sendCommand(std::move(command));
+
+  playing_ = false;
+  paused_ = false;
+
+  if (wasPlaying) {
     std::cout << "Audio stopped" << std::endl;
   }
 }
 
+void AudioPlayer::seek(size_t frame) {
+  Command command;
+  command.type = Command::Type::Seek;
+  command.frame = frame;
+  sendCommand(std::move(command));
+}
+
+bool AudioPlayer::isPlaying() const {
+  // The audio thread reports the generation it finished, so a stale report
+  // from an earlier play() cannot stop a newer one
+  return playing_ && finishedGeneration_.load(std::memory_order_acquire) != playGeneration_;
+}
+
 float AudioPlayer::getPlaybackPosition() const {
-  if (!audioBuffer_ || audioBuffer_->getFrameCount() == 0) {
+  if (sourceFrameCount_ == 0) {
     return 0.0f;
   }
 
-  return static_cast<float>(currentFrame_) / audioBuffer_->getFrameCount();
+  return static_cast<float>(currentFrame_.load(std::memory_order_relaxed)) / sourceFrameCount_;
 }
 
 void AudioPlayer::setVolume(float volume) {
   volume_ = std::max(0.0f, std::min(1.0f, volume));
+
+  Command command;
+  command.type = Command::Type::SetVolume;
+  command.volume = volume_;
+  sendCommand(std::move(command));
+}
+
+void AudioPlayer::setAudioBuffer(std::shared_ptr<const AudioBuffer> buffer) {
+  setAudioBuffer(std::move(buffer), nullptr);
+}
+
+void AudioPlayer::setAudioBuffer(std::shared_ptr<const AudioBuffer> buffer,
+                                 std::shared_ptr<const std::atomic<size_t>> loadedFrames) {
+  uiSource_ = { std::move(buffer), nullptr, nullptr, nullptr, nullptr, std::move(loadedFrames) };
+  sourceFrameCount_ = uiSource_.buffer ? uiSource_.buffer->getFrameCount() : 0;
+  duration_ = uiSource_.buffer && uiSource_.buffer->getSampleRate() > 0
+    ? static_cast<float>(sourceFrameCount_) / uiSource_.buffer->getSampleRate()
+    : 0.0f;
+
+  sendSource();
 }
 
 void AudioPlayer::setAudioBuffer(const AudioBuffer& buffer) {
-  audioBuffer_ = &buffer;
-  duration_ = static_cast<float>(buffer.getFrameCount()) / buffer.getSampleRate();
+  setAudioBuffer(borrow(buffer));
+}
+
+void AudioPlayer::setAudioStream(std::shared_ptr<WavStreamReader> stream) {
+  uiSource_ = { nullptr, std::move(stream), nullptr, nullptr, nullptr, nullptr };
+  sourceFrameCount_ = uiSource_.stream ? uiSource_.stream->getFrameCount() : 0;
+  duration_ = uiSource_.stream && uiSource_.stream->getSampleRate() > 0
+    ? static_cast<float>(sourceFrameCount_) / uiSource_.stream->getSampleRate()
+    : 0.0f;
+
+  sendSource();
+}
+
+void AudioPlayer::sendSource() {
+  size_t sourceRate = uiSource_.stream ? uiSource_.stream->getSampleRate()
+    : uiSource_.buffer ? uiSource_.buffer->getSampleRate() : 0;
+  size_t sourceChannels = uiSource_.stream ? uiSource_.stream->getChannelCount()
+    : uiSource_.buffer ? uiSource_.buffer->getChannelCount() : 0;
+
+  // Built here so the audio thread never opens files or allocates filter
+  // tables and history. Each send gets a fresh prefetcher; the previous one
+  // is stopped when the audio thread retires it.
+  uiSource_.prefetcher.reset();
+
+  if (uiSource_.stream && uiSource_.stream->isOpen()) {
+    auto prefetcher = std::make_shared<StreamPrefetcher>(StreamPrefetcher::kDefaultCapacityFrames, offline_);
+
+    if (prefetcher->open(uiSource_.stream->getFilename())) {
+      uiSource_.prefetcher = std::move(prefetcher);
+    }
+    else {
+      std::cerr << "Failed to open audio stream for playback" << std::endl;
+    }
+  }
+
+  uiSource_.resampler.reset();
+
+  if (sourceRate > 0 && sourceRate != static_cast<size_t>(sampleRate_)) {
+    uiSource_.resampler = std::make_shared<Resampler>(sourceRate, sampleRate_, sourceChannels, blockFrames_,
+                                                      resamplerQuality_);
+  }
+
+  uiSource_.mixer.reset();
+
+  if (uiChannelMixer_ && uiChannelMixer_->getInputChannels() == sourceChannels &&
+      uiChannelMixer_->getOutputChannels() == static_cast<size_t>(channels_)) {
+    uiSource_.mixer = uiChannelMixer_;
+  }
+  else if (sourceChannels > 0 && sourceChannels != static_cast<size_t>(channels_)) {
+    uiSource_.mixer = std::make_shared<const ChannelMixer>(sourceChannels, channels_);
+  }
+
+  Command command;
+  command.type = Command::Type::SetSource;
+  command.source = uiSource_;
+  sendCommand(std::move(command));
+}
+
+void AudioPlayer::setAudioStream(WavStreamReader& stream) {
+  setAudioStream(borrow(stream));
+}
+
+void AudioPlayer::setChannelMixer(std::shared_ptr<const ChannelMixer> mixer) {
+  uiChannelMixer_ = std::move(mixer);
+  sendSource();
+}
+
+void AudioPlayer::setEffects(EffectList effects) {
+  uiEffects_ = effects;
+
+  // Drop effects that are gone, then prepare only the ones new since the
+  // device opened; the others may be live on the audio thread
+  uiPreparedEffects_.erase(std::remove_if(uiPreparedEffects_.begin(), uiPreparedEffects_.end(),
+                                          [](const std::weak_ptr<AudioEffect>& prepared) { return prepared.expired(); }),
+                           uiPreparedEffects_.end());
+
+  for (const auto& effect : effects) {
+    bool prepared = std::any_of(uiPreparedEffects_.begin(), uiPreparedEffects_.end(),
+                                [&](const std::weak_ptr<AudioEffect>& other) { return other.lock() == effect; });
+
+    if (!prepared) {
+      effect->prepare(sampleRate_, blockFrames_, channels_);
+      uiPreparedEffects_.push_back(effect);
+    }
+  }
+
+  Command command;
+  command.type = Command::Type::SetEffects;
+  command.effects = std::make_shared<const EffectList>(std::move(effects));
+  sendCommand(std::move(command));
+}
+
+void AudioPlayer::collectRetiredSources() {
+  Retired retired;
+
+  while (retired_.tryPop(retired)) {
+    retired = Retired();
+  }
+}
+
+bool AudioPlayer::sendCommand(Command command) {
+  collectRetiredSources();
+
+  if (!commands_.tryPush(std::move(command))) {
+    std::cerr << "Audio command queue full, command dropped" << std::endl;
+    return false;
+  }
+
+  // Without a device there is no audio thread to consume the queue
+  if (deviceId_ == 0) {
+    processCommands();
+    collectRetiredSources();
+  }
+  return true;
 }
 
 void AudioPlayer::audioCallback(void* userdata, Uint8* stream, int len) {
   AudioPlayer* player = static_cast<AudioPlayer*>(userdata);
 
+  uint64_t start = CallbackStats::now();
   player->fillAudioBuffer(stream, len);
+  uint64_t end = CallbackStats::now();
+
+  uint64_t interval = player->rtLastCallbackStart_ ? start - player->rtLastCallbackStart_ : 0;
+  player->rtLastCallbackStart_ = start;
+  player->stats_.record(end - start, interval);
+}
+
+void AudioPlayer::processCommands() {
+  Command command;
+
+  while (commands_.tryPop(command)) {
+    switch (command.type) {
+      case Command::Type::SetSource:
+        // The position is kept so an edited copy can replace the playing buffer
+        setSource(std::move(command.source));
+        break;
+
+      case Command::Type::SetEffects:
+        retire({ Source(), std::move(rtEffects_) });
+        rtEffects_ = std::move(command.effects);
+        break;
+
+      case Command::Type::Play:
+        rtPlaying_ = true;
+        rtPaused_ = false;
+        rtGeneration_ = command.generation;
+        currentFrame_ = 0;
+        resetResampler();
+        seekStream();
+        break;
+
+      case Command::Type::Pause:
+        rtPaused_ = true;
+        break;
+
+      case Command::Type::Resume:
+        rtPaused_ = false;
+        break;
+
+      case Command::Type::Stop:
+        rtPlaying_ = false;
+        rtPaused_ = false;
+        currentFrame_ = 0;
+        resetResampler();
+        seekStream();
+        break;
+
+      case Command::Type::Seek:
+        currentFrame_ = command.frame;
+        resetResampler();
+        seekStream();
+        break;
+
+      case Command::Type::SetVolume:
+        rtVolume_ = command.volume;
+        break;
+
+      case Command::Type::None:
+        break;
+    }
+  }
+}
+
+void AudioPlayer::resetResampler() {
+  if (rtSource_.resampler) {
+    rtSource_.resampler->reset();
+  }
+}
+
+void AudioPlayer::seekStream() {
+  // The reader thread picks the seek up; until then reads underrun
+  if (rtSource_.prefetcher) {
+    rtSource_.prefetcher->seek(currentFrame_.load(std::memory_order_relaxed));
+  }
+}
+
+void AudioPlayer::setSource(Source source) {
+  Source previous = std::move(rtSource_);
+  rtSource_ = std::move(source);
+  seekStream();
+
+  retire({ std::move(previous), nullptr });
+}
+
+void AudioPlayer::retire(Retired retired) {
+  // Hand old objects back to the UI thread so their memory is never freed
+  // here. Every command is preceded by a collection on the UI side, so the
+  // retired queue cannot fill up in practice.
+  if (retired.source.buffer || retired.source.stream || retired.source.prefetcher || retired.effects) {
+    retired_.tryPush(std::move(retired));
+  }
 }
 
 void AudioPlayer::fillAudioBuffer(Uint8* stream, int len) {
-  if (!audioBuffer_ || !playing_ || paused_) {
-    SDL_memset(stream, 0, len);
+  processCommands();
+
+  size_t sampleBytes = SampleConversion::getBytesPerSample(deviceSampleFormat_);
+  size_t frames = len / (sampleBytes * channels_);
+  bool direct = deviceSampleFormat_ == SampleFormat::Float32;
+
+  // Effects are prepared for blocks of at most one period, so a longer
+  // request is rendered in several
+  for (size_t done = 0; done < frames; ) {
+    size_t chunk = std::min(frames - done, blockFrames_);
+    Uint8* dest = stream + done * channels_ * sampleBytes;
+
+    if (direct) {
+      renderFrames(reinterpret_cast<float*>(dest), chunk);
+    }
+    else {
+      renderFrames(rtDeviceBlock_.data(), chunk);
+      SampleConversion::fromFloat(deviceSampleFormat_, rtDeviceBlock_.data(), dest, chunk * channels_);
+    }
+    done += chunk;
+  }
+
+  size_t written = frames * channels_ * sampleBytes;
+  SDL_memset(stream + written, 0, len - written);
+}
+
+void AudioPlayer::renderFrames(float* output, size_t frames) {
+  size_t totalSamples = frames * channels_;
+
+  if ((!rtSource_.buffer && !rtSource_.prefetcher) || !rtPlaying_ || rtPaused_) {
+    std::fill(output, output + totalSamples, 0.0f);
     return;
   }
 
-  size_t frameCount = audioBuffer_->getFrameCount();
-  size_t channelCount = audioBuffer_->getChannelCount();
-  int bytesPerFrame = channelCount * sizeof(float);
-  int framesToWrite = len / bytesPerFrame;
+  size_t framesWritten = readSource(output, frames);
 
-  float* output = reinterpret_cast<float*>(stream);
+  // Fill remaining buffer with silence
+  std::fill(output + framesWritten * channels_, output + totalSamples, 0.0f);
 
-  for (int i = 0; i < framesToWrite; ++i) {
-    if (currentFrame_ >= frameCount) {
-      // End of audio reached
-      playing_ = false;
-      currentFrame_ = 0;
-      break;
+  if (rtEffects_) {
+    for (const auto& effect : *rtEffects_) {
+      if (effect->isEnabled()) {
+        effect->processBlock(output, frames);
+      }
     }
+  }
+
+  if (framesWritten < frames) {
+    // End of audio reached
+    rtPlaying_ = false;
+    currentFrame_ = 0;
+    finishedGeneration_.store(rtGeneration_, std::memory_order_release);
+  }
+}
+
+size_t AudioPlayer::readSource(float* output, size_t frames) {
+  size_t sourceChannels = rtSource_.prefetcher ? rtSource_.prefetcher->getChannelCount() : rtSource_.buffer->getChannelCount();
+  const ChannelMixer* mixer = rtSource_.mixer.get();
+
+  if (!mixer) {
+    return readResampled(output, frames, sourceChannels);
+  }
+
+  // Read source frames into scratch, then mix them into the device channels
+  size_t blockFrames = sourceChannels > 0 ? rtSourceBlock_.size() / sourceChannels : 0;
+  size_t framesRead = 0;
+
+  while (blockFrames > 0 && framesRead < frames) {
+    size_t chunk = std::min(frames - framesRead, blockFrames);
+    size_t got = readResampled(rtSourceBlock_.data(), chunk, sourceChannels);
+
+    mixer->process(rtSourceBlock_.data(), output + framesRead * channels_, got);
+    framesRead += got;
 
-    for (size_t channel = 0; channel < channelCount; ++channel) {
-      float sample = audioBuffer_->getSample(currentFrame_, channel);
-      output[i * channelCount + channel] = sample * volume_;
+    if (got < chunk) break;
+  }
+  return framesRead;
+}
+
+size_t AudioPlayer::readResampled(float* output, size_t frames, size_t channelCount) {
+  auto read = [this, channelCount](float* dest, size_t count) {
+    return rtSource_.prefetcher
+      ? fillFromStream(dest, count, channelCount)
+      : fillFromBuffer(dest, count, channelCount);
+  };
+
+  Resampler* resampler = rtSource_.resampler.get();
+
+  if (!resampler) return read(output, frames);
+
+  size_t framesWritten = 0;
+
+  while (framesWritten < frames) {
+    size_t chunk = std::min(frames - framesWritten, resampler->getMaxOutputFrames());
+    size_t got = resampler->pull(output + framesWritten * channelCount, chunk, read);
+
+    framesWritten += got;
+
+    if (got < chunk) break;
+  }
+  return framesWritten;
+}
+
+size_t AudioPlayer::fillFromBuffer(float* output, size_t frames, size_t channelCount) {
+  const AudioBuffer& buffer = *rtSource_.buffer;
+  size_t frameCount = buffer.getFrameCount();
+  size_t position = currentFrame_.load(std::memory_order_relaxed);
+  bool loading = false;
+
+  if (rtSource_.loadedFrames) {
+    // Acquire pairs with the loader's release, so the samples are visible
+    size_t loadedFrames = rtSource_.loadedFrames->load(std::memory_order_acquire);
+    loading = loadedFrames < frameCount;
+    frameCount = std::min(frameCount, loadedFrames);
+  }
+
+  size_t framesToCopy = position < frameCount ? std::min(frames, frameCount - position) : 0;
+
+  ConstAudioBufferView source = buffer.getView(position, framesToCopy);
+
+  if (!source.isEmpty()) {
+    // Either layout is written straight into the interleaved device buffer
+    copyFrames(source, AudioBufferView(output, framesToCopy, channelCount), rtVolume_);
+  }
+  else {
+    for (size_t i = 0; i < framesToCopy; ++i) {
+      for (size_t channel = 0; channel < channelCount; ++channel) {
+        float sample = buffer.getSample(position + i, channel);
+        output[i * channelCount + channel] = sample * rtVolume_;
+      }
     }
+  }
+
+  currentFrame_.store(position + framesToCopy, std::memory_order_relaxed);
 
-    currentFrame_++;
+  // Caught up with a load in progress: hold the position in silence
+  if (loading && framesToCopy < frames) {
+    std::fill(output + framesToCopy * channelCount, output + frames * channelCount, 0.0f);
+    return frames;
   }
+  return framesToCopy;
+}
 
-  // Fill remaining buffer with silence
-  for (int i = framesToWrite; i < len / (int) sizeof(float); ++i) {
-    output[i] = 0.0f;
+size_t AudioPlayer::fillFromStream(float* output, size_t frames, size_t channelCount) {
+  // Only copies what the reader thread has buffered; no file access here
+  StreamPrefetcher& prefetcher = *rtSource_.prefetcher;
+  size_t framesRead = prefetcher.read(output, frames);
+
+  for (size_t i = 0; i < framesRead * channelCount; ++i) {
+    output[i] *= rtVolume_;
+  }
+
+  currentFrame_.store(prefetcher.getPosition(), std::memory_order_relaxed);
+
+  // Underrun before the end: hold the position in silence
+  if (framesRead < frames && prefetcher.getPosition() < prefetcher.getEndFrame()) {
+    std::fill(output + framesRead * channelCount, output + frames * channelCount, 0.0f);
+    return frames;
   }
-}
\ No newline at end of file
+  return framesRead;
+}
@@ -0,0 +1,315 @@
+#include "audio/BatchProcessor.h"
+#include "audio/AudioFileLoader.h"
+#include "audio/AudioFileWriter.h"
+#include "audio/GainEffect.h"
+#include "audio/ThreadPool.h"
+#include "audio/WavIndexCache.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+  bool isWavFile(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".wav";
+  }
+
+  // Shell-style match of * and ? against a whole file name
+  bool matchPattern(const std::string& pattern, const std::string& name) {
+    size_t p = 0, n = 0;
+    size_t starPattern = std::string::npos, starName = 0;
+
+    while (n < name.size()) {
+      if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+        ++p;
+        ++n;
+      }
+      else if (p < pattern.size() && pattern[p] == '*') {
+        starPattern = p++;
+        starName = n;
+      }
+      else if (starPattern != std::string::npos) {
+        p = starPattern + 1;
+        n = ++starName;
+      }
+      else {
+        return false;
+      }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+  }
+
+  // "0.5", "-6dB" or "-6 dB" as a linear gain
+  bool parseLevel(const std::string& text, float& value) {
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    double number = std::strtod(begin, &end);
+
+    if (end == begin) return false;
+
+    std::string unit(end);
+    unit.erase(std::remove(unit.begin(), unit.end(), ' '), unit.end());
+
+    if (unit.empty()) {
+      value = static_cast<float>(number);
+      return value >= 0.0f;
+    }
+
+    if (unit == "dB" || unit == "db") {
+      value = static_cast<float>(std::pow(10.0, number / 20.0));
+      return true;
+    }
+    return false;
+  }
+}
+
+BatchProcessor::BatchProcessor(Options options)
+  : options_(std::move(options)), indexCache_(std::make_shared<WavIndexCache>()), memoryInFlight_(0) {}
+
+bool BatchProcessor::parseChain(const std::string& spec, std::vector<Step>& steps, std::string& error) {
+  steps.clear();
+
+  std::stringstream stream(spec);
+  std::string item;
+
+  while (std::getline(stream, item, ',')) {
+    size_t equals = item.find('=');
+    std::string name = item.substr(0, equals);
+    std::string argument = equals == std::string::npos ? "" : item.substr(equals + 1);
+    Step step;
+
+    if (name == "gain") {
+      step.type = Step::Type::Gain;
+
+      if (!parseLevel(argument, step.value)) {
+        error = "gain needs a linear factor or a level in dB: " + item;
+        return false;
+      }
+    }
+    else if (name == "normalize") {
+      step.type = Step::Type::Normalize;
+
+      if (!argument.empty() && !parseLevel(argument, step.value)) {
+        error = "normalize takes a peak level, e.g. normalize=-1dB: " + item;
+        return false;
+      }
+    }
+    else {
+      error = "unknown step: " + item;
+      return false;
+    }
+
+    steps.push_back(step);
+  }
+
+  if (steps.empty()) {
+    error = "empty effect chain";
+    return false;
+  }
+  return true;
+}
+
+std::vector<std::string> BatchProcessor::expandInputs(const std::vector<std::string>& arguments) {
+  std::set<std::string> files;
+  std::error_code error;
+
+  for (const std::string& argument : arguments) {
+    fs::path path(argument);
+
+    if (fs::is_directory(path, error)) {
+      for (fs::recursive_directory_iterator it(path, error), end; !error && it != end; it.increment(error)) {
+        if (it->is_regular_file(error) && isWavFile(it->path())) {
+          files.insert(it->path().string());
+        }
+      }
+      continue;
+    }
+
+    std::string name = path.filename().string();
+
+    if (name.find_first_of("*?") == std::string::npos) {
+      files.insert(argument);
+      continue;
+    }
+
+    fs::path directory = path.has_parent_path() ? path.parent_path() : fs::path(".");
+
+    for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+      if (it->is_regular_file(error) && matchPattern(name, it->path().filename().string())) {
+        files.insert((path.has_parent_path() ? directory / it->path().filename() : it->path().filename()).string());
+      }
+    }
+  }
+
+  return std::vector<std::string>(files.begin(), files.end());
+}
+
+std::string BatchProcessor::getOutputPath(const std::string& input) const {
+  fs::path source(input);
+  fs::path directory = options_.outputDirectory.empty() ? source.parent_path() : fs::path(options_.outputDirectory);
+
+  return (directory / (source.stem().string() + options_.suffix + ".wav")).string();
+}
+
+void BatchProcessor::apply(AudioBuffer& buffer) const {
+  for (const Step& step : options_.steps) {
+    switch (step.type) {
+      case Step::Type::Gain: {
+        GainEffect gain(step.value);
+        gain.process(buffer);
+        break;
+      }
+
+      case Step::Type::Normalize: {
+        float peak = buffer.getPeakAmplitude();
+
+        if (peak > 0.0f) {
+          buffer.applyGain(step.value / peak);
+        }
+        break;
+      }
+    }
+  }
+}
+
+std::vector<BatchProcessor::Result> BatchProcessor::run(const std::vector<std::string>& inputs) {
+  std::vector<Result> results(inputs.size());
+  std::set<std::string> outputs;
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    results[i].input = inputs[i];
+    results[i].output = getOutputPath(inputs[i]);
+
+    if (!outputs.insert(results[i].output).second) {
+      results[i].error = "output name collides with another input's";
+    }
+    else if (fs::path(results[i].output) == fs::path(inputs[i])) {
+      results[i].error = "output would overwrite the input";
+    }
+  }
+
+  // Largest files first, so a long file never starts last and holds up the
+  // end of the batch
+  std::vector<size_t> order(inputs.size());
+  std::vector<uintmax_t> sizes(inputs.size());
+  std::iota(order.begin(), order.end(), 0);
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    std::error_code error;
+    uintmax_t size = fs::file_size(inputs[i], error);
+    sizes[i] = error ? 0 : size;
+  }
+
+  std::stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+  if (!options_.outputDirectory.empty()) {
+    std::error_code error;
+    fs::create_directories(options_.outputDirectory, error);
+  }
+
+  // The calling thread takes files too, so one fewer worker gives `threads`
+  // files in flight. Each worker claims the next file as it finishes one.
+  size_t threads = options_.threads > 0 ? options_.threads : std::max(1u, std::thread::hardware_concurrency());
+  ThreadPool pool(threads - 1);
+
+  pool.parallelFor(order.size(), [this, &order, &results](size_t index) {
+    Result& result = results[order[index]];
+
+    if (result.error.empty()) {
+      processFile(result);
+    }
+
+    if (options_.onFileDone) {
+      std::lock_guard<std::mutex> lock(reportMutex_);
+      options_.onFileDone(result);
+    }
+  });
+
+  return results;
+}
+
+void BatchProcessor::processFile(Result& result) {
+  auto start = std::chrono::steady_clock::now();
+
+  AudioFileLoader loader;
+  loader.setVerbose(false);
+  loader.setIndexCache(indexCache_);
+  WavInfo info;
+
+  if (!loader.getWavInfo(result.input, info)) {
+    result.error = "not a readable WAV file";
+    return;
+  }
+
+  // Decoded size; held against the budget until the output is written
+  uint64_t bytes = info.frameCount * info.channels * sizeof(float);
+  acquireMemory(bytes);
+
+  AudioBuffer buffer;
+  bool loaded = loader.loadWavFile(result.input, buffer);
+
+  if (loaded) {
+    apply(buffer);
+
+    // Written under a temporary name so a partial file is never mistaken
+    // for a result
+    std::string partial = result.output + ".part";
+    AudioFileWriter writer;
+    writer.setSampleFormat(options_.keepInputFormat ? info.sampleFormat : options_.format);
+    writer.setDirectIo(options_.directIo);
+    std::error_code error;
+
+    if (!writer.writeWavFile(partial, buffer)) {
+      result.error = "could not write " + partial;
+      fs::remove(partial, error);
+    }
+    else {
+      fs::rename(partial, result.output, error);
+
+      if (error) {
+        result.error = "could not rename to " + result.output + ": " + error.message();
+      }
+    }
+
+    result.frames = buffer.getFrameCount();
+  }
+  else {
+    result.error = "failed to load";
+  }
+
+  buffer = AudioBuffer();
+  releaseMemory(bytes);
+
+  result.success = result.error.empty();
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BatchProcessor::acquireMemory(uint64_t bytes) {
+  // A file larger than the whole budget still runs, but only on its own
+  std::unique_lock<std::mutex> lock(memoryMutex_);
+  memoryAvailable_.wait(lock, [this, bytes]() {
+    return memoryInFlight_ == 0 || memoryInFlight_ + bytes <= options_.memoryBudget;
+  });
+  memoryInFlight_ += bytes;
+}
+
+void BatchProcessor::releaseMemory(uint64_t bytes) {
+  {
+    std::lock_guard<std::mutex> lock(memoryMutex_);
+    memoryInFlight_ -= bytes;
+  }
+  memoryAvailable_.notify_all();
+}
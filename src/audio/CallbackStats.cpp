@@ -0,0 +1,160 @@
+#include "audio/CallbackStats.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+
+namespace {
+  void storeMax(std::atomic<uint64_t>& target, uint64_t value) {
+    // Only the audio thread writes, so no compare-exchange loop is needed
+    if (value > target.load(std::memory_order_relaxed)) {
+      target.store(value, std::memory_order_relaxed);
+    }
+  }
+}
+
+double CallbackStats::Snapshot::getAverageLoad() const {
+  if (callbacks == 0 || periodNs == 0) return 0.0;
+
+  return static_cast<double>(totalDurationNs) / callbacks / periodNs;
+}
+
+double CallbackStats::Snapshot::getMaxLoad() const {
+  if (periodNs == 0) return 0.0;
+
+  return static_cast<double>(maxDurationNs) / periodNs;
+}
+
+double CallbackStats::Snapshot::getLoadPercentile(double percentile) const {
+  if (callbacks == 0) return 0.0;
+
+  uint64_t total = 0;
+  for (uint64_t count : histogram) total += count;
+
+  if (total == 0) return 0.0;
+
+  double fraction = std::max(0.0, std::min(100.0, percentile)) / 100.0;
+  uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * total)));
+  uint64_t seen = 0;
+
+  for (size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+    seen += histogram[bucket];
+
+    if (seen >= rank) {
+      // The overflow bucket has no upper bound; report the worst callback
+      if (bucket == kBucketCount - 1) return getMaxLoad();
+      return static_cast<double>(bucket + 1) / kBucketsPerPeriod;
+    }
+  }
+  return getMaxLoad();
+}
+
+void CallbackStats::Snapshot::write(std::ostream& out) const {
+  out << std::fixed << std::setprecision(1);
+  out << "period_us: " << periodNs / 1000.0 << "\n";
+  out << "callbacks: " << callbacks << "\n";
+  out << "xruns: " << getXruns() << "\n";
+  out << "overruns: " << overruns << "\n";
+  out << "late_callbacks: " << lateCallbacks << "\n";
+  out << "average_us: " << (callbacks ? totalDurationNs / 1000.0 / callbacks : 0.0) << "\n";
+  out << "max_us: " << maxDurationNs / 1000.0 << "\n";
+  out << "max_interval_us: " << maxIntervalNs / 1000.0 << "\n";
+  out << "average_load_percent: " << getAverageLoad() * 100.0 << "\n";
+  out << "p99_load_percent: " << getLoadPercentile(99.0) * 100.0 << "\n";
+  out << "max_load_percent: " << getMaxLoad() * 100.0 << "\n";
+  out << "min_headroom_percent: " << getMinHeadroom() * 100.0 << "\n";
+  out << "histogram (load percent: callbacks):\n";
+
+  for (size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+    if (histogram[bucket] == 0) continue;
+
+    double lower = 100.0 * bucket / kBucketsPerPeriod;
+
+    if (bucket == kBucketCount - 1) {
+      out << "  >=" << lower << ": " << histogram[bucket] << "\n";
+    }
+    else {
+      out << "  " << lower << "-" << 100.0 * (bucket + 1) / kBucketsPerPeriod << ": " << histogram[bucket] << "\n";
+    }
+  }
+}
+
+CallbackStats::CallbackStats() {
+  reset(0);
+}
+
+void CallbackStats::reset(uint64_t periodNs) {
+  periodNs_.store(periodNs, std::memory_order_relaxed);
+  callbacks_.store(0, std::memory_order_relaxed);
+  overruns_.store(0, std::memory_order_relaxed);
+  lateCallbacks_.store(0, std::memory_order_relaxed);
+  totalDurationNs_.store(0, std::memory_order_relaxed);
+  maxDurationNs_.store(0, std::memory_order_relaxed);
+  maxIntervalNs_.store(0, std::memory_order_relaxed);
+  previousOverrun_.store(false, std::memory_order_relaxed);
+
+  for (auto& count : histogram_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+}
+
+void CallbackStats::reset(size_t blockFrames, int sampleRate) {
+  reset(sampleRate > 0 ? static_cast<uint64_t>(blockFrames) * 1000000000ULL / sampleRate : 0);
+}
+
+void CallbackStats::record(uint64_t durationNs, uint64_t intervalNs) {
+  uint64_t periodNs = periodNs_.load(std::memory_order_relaxed);
+
+  callbacks_.fetch_add(1, std::memory_order_relaxed);
+  totalDurationNs_.fetch_add(durationNs, std::memory_order_relaxed);
+  storeMax(maxDurationNs_, durationNs);
+  storeMax(maxIntervalNs_, intervalNs);
+
+  if (periodNs == 0) return;
+
+  bool overrun = durationNs > periodNs;
+
+  if (overrun) {
+    overruns_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  if (intervalNs > periodNs * kLateCallbackPeriods && !previousOverrun_.load(std::memory_order_relaxed)) {
+    lateCallbacks_.fetch_add(1, std::memory_order_relaxed);
+  }
+  previousOverrun_.store(overrun, std::memory_order_relaxed);
+
+  size_t bucket = std::min<uint64_t>(kBucketCount - 1, durationNs * kBucketsPerPeriod / periodNs);
+  histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+CallbackStats::Snapshot CallbackStats::getSnapshot() const {
+  Snapshot snapshot;
+  snapshot.periodNs = periodNs_.load(std::memory_order_relaxed);
+  snapshot.callbacks = callbacks_.load(std::memory_order_relaxed);
+  snapshot.overruns = overruns_.load(std::memory_order_relaxed);
+  snapshot.lateCallbacks = lateCallbacks_.load(std::memory_order_relaxed);
+  snapshot.totalDurationNs = totalDurationNs_.load(std::memory_order_relaxed);
+  snapshot.maxDurationNs = maxDurationNs_.load(std::memory_order_relaxed);
+  snapshot.maxIntervalNs = maxIntervalNs_.load(std::memory_order_relaxed);
+
+  for (size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+    snapshot.histogram[bucket] = histogram_[bucket].load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+bool CallbackStats::writeReport(const std::string& filename) const {
+  std::ofstream out(filename);
+
+  if (!out) return false;
+
+  getSnapshot().write(out);
+  return static_cast<bool>(out);
+}
+
+uint64_t CallbackStats::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
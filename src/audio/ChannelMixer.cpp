@@ -0,0 +1,261 @@
+#include "audio/ChannelMixer.h"
+#include "audio/CpuFeatures.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef AUDIO_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+  enum Speaker { FL, FR, FC, LFE, BL, BR, SL, SR, BC, None };
+
+  // -3 dB, for a speaker split across two
+  const float kFold = 0.70710678f;
+
+  // Floats per input channel in the stereo gain table (one AVX vector)
+  const size_t kLanes = 8;
+
+  Speaker getSpeaker(size_t channels, size_t channel) {
+    static const Speaker layouts[][8] = {
+      { FC },
+      { FL, FR },
+      { FL, FR, FC },
+      { FL, FR, BL, BR },
+      { FL, FR, FC, BL, BR },
+      { FL, FR, FC, LFE, BL, BR },
+      { FL, FR, FC, LFE, BL, BR, BC },
+      { FL, FR, FC, LFE, BL, BR, SL, SR },
+    };
+
+    if (channels == 0 || channel >= std::min<size_t>(channels, 8)) return None;
+    return layouts[std::min<size_t>(channels, 8) - 1][channel];
+  }
+
+  int findSpeaker(size_t channels, Speaker speaker) {
+    for (size_t channel = 0; channel < channels; ++channel) {
+      if (getSpeaker(channels, channel) == speaker) return static_cast<int>(channel);
+    }
+    return -1;
+  }
+
+  void route(std::vector<float>& matrix, size_t inputs, size_t outputs, size_t input, Speaker speaker, float gain);
+
+  // Surround channels move to the matching side/back speaker at full level,
+  // or into the front speaker on that side at -3 dB
+  void foldInto(std::vector<float>& matrix, size_t inputs, size_t outputs, size_t input,
+                Speaker nearest, Speaker front, float gain) {
+    if (findSpeaker(outputs, nearest) >= 0) {
+      route(matrix, inputs, outputs, input, nearest, gain);
+    }
+    else {
+      route(matrix, inputs, outputs, input, front, gain * kFold);
+    }
+  }
+
+  // Add `gain` of an input to the output playing `speaker`, folding it into
+  // the nearest available speakers when the output layout lacks it
+  void route(std::vector<float>& matrix, size_t inputs, size_t outputs, size_t input, Speaker speaker, float gain) {
+    if (speaker == None || gain == 0.0f) return;
+
+    int output = findSpeaker(outputs, speaker);
+
+    if (output >= 0) {
+      matrix[output * inputs + input] += gain;
+      return;
+    }
+
+    switch (speaker) {
+      case FC:
+        route(matrix, inputs, outputs, input, FL, gain * kFold);
+        route(matrix, inputs, outputs, input, FR, gain * kFold);
+        break;
+      case FL:
+      case FR:
+        // Only a mono output lacks the front pair
+        route(matrix, inputs, outputs, input, FC, gain * kFold);
+        break;
+      case SL: foldInto(matrix, inputs, outputs, input, BL, FL, gain); break;
+      case SR: foldInto(matrix, inputs, outputs, input, BR, FR, gain); break;
+      case BL: foldInto(matrix, inputs, outputs, input, SL, FL, gain); break;
+      case BR: foldInto(matrix, inputs, outputs, input, SR, FR, gain); break;
+      case BC:
+        route(matrix, inputs, outputs, input, BL, gain * kFold);
+        route(matrix, inputs, outputs, input, BR, gain * kFold);
+        break;
+      default:
+        // LFE without an LFE output is dropped
+        break;
+    }
+  }
+
+  void mixScalar(const float* input, float* output, size_t frames, size_t inputs, size_t outputs, const float* matrix) {
+    for (size_t frame = 0; frame < frames; ++frame) {
+      const float* in = input + frame * inputs;
+      float* out = output + frame * outputs;
+
+      for (size_t o = 0; o < outputs; ++o) {
+        const float* gains = matrix + o * inputs;
+        float sum = 0.0f;
+
+        for (size_t i = 0; i < inputs; ++i) {
+          sum += gains[i] * in[i];
+        }
+        out[o] = sum;
+      }
+    }
+  }
+
+#ifdef AUDIO_SIMD_X86
+
+  // Two stereo frames per vector: each input sample is broadcast to the L
+  // and R lanes of its frame and scaled by that input's two gains
+
+  AUDIO_TARGET_SSE2 size_t mixStereoSSE2(const float* input, float* output, size_t frames, size_t inputs, const float* gains) {
+    size_t frame = 0;
+
+    for (; frame + 2 <= frames; frame += 2) {
+      const float* a = input + frame * inputs;
+      const float* b = a + inputs;
+      __m128 sum = _mm_setzero_ps();
+
+      for (size_t i = 0; i < inputs; ++i) {
+        __m128 x = _mm_set_ps(b[i], b[i], a[i], a[i]);
+        sum = _mm_add_ps(sum, _mm_mul_ps(x, _mm_load_ps(gains + i * kLanes)));
+      }
+      _mm_storeu_ps(output + frame * 2, sum);
+    }
+    return frame;
+  }
+
+  AUDIO_TARGET_AVX2 size_t mixStereoAVX2(const float* input, float* output, size_t frames, size_t inputs, const float* gains) {
+    size_t frame = 0;
+
+    for (; frame + 4 <= frames; frame += 4) {
+      const float* a = input + frame * inputs;
+      const float* b = a + inputs;
+      const float* c = b + inputs;
+      const float* d = c + inputs;
+      __m256 sum = _mm256_setzero_ps();
+
+      for (size_t i = 0; i < inputs; ++i) {
+        __m256 x = _mm256_set_ps(d[i], d[i], c[i], c[i], b[i], b[i], a[i], a[i]);
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(x, _mm256_load_ps(gains + i * kLanes)));
+      }
+      _mm256_storeu_ps(output + frame * 2, sum);
+    }
+    return frame;
+  }
+
+#endif
+}
+
+ChannelMixer::ChannelMixer(size_t inputChannels, size_t outputChannels)
+  : ChannelMixer(inputChannels, outputChannels, getDefaultMatrix(inputChannels, outputChannels)) {}
+
+ChannelMixer::ChannelMixer(size_t inputChannels, size_t outputChannels, const std::vector<float>& matrix)
+  : inputChannels_(std::max<size_t>(1, inputChannels)), outputChannels_(std::max<size_t>(1, outputChannels)),
+  matrix_(matrix), kernel_(Kernel::Scalar) {
+  matrix_.resize(inputChannels_ * outputChannels_, 0.0f);
+  selectKernel();
+}
+
+std::vector<float> ChannelMixer::getDefaultMatrix(size_t inputChannels, size_t outputChannels) {
+  size_t inputs = std::max<size_t>(1, inputChannels);
+  size_t outputs = std::max<size_t>(1, outputChannels);
+  std::vector<float> matrix(inputs * outputs, 0.0f);
+
+  if (inputs == outputs) {
+    for (size_t channel = 0; channel < inputs; ++channel) {
+      matrix[channel * inputs + channel] = 1.0f;
+    }
+    return matrix;
+  }
+
+  // Mono to stereo plays at full level on both sides
+  if (inputs == 1 && outputs == 2) {
+    matrix[0] = matrix[1] = 1.0f;
+    return matrix;
+  }
+
+  // Anything to mono: the stereo downmix, averaged
+  if (outputs == 1) {
+    std::vector<float> stereo = getDefaultMatrix(inputs, 2);
+
+    for (size_t input = 0; input < inputs; ++input) {
+      matrix[input] = 0.5f * (stereo[input] + stereo[inputs + input]);
+    }
+    return matrix;
+  }
+
+  for (size_t input = 0; input < inputs; ++input) {
+    route(matrix, inputs, outputs, input, getSpeaker(inputs, input), 1.0f);
+  }
+  return matrix;
+}
+
+void ChannelMixer::setGain(size_t output, size_t input, float gain) {
+  if (output >= outputChannels_ || input >= inputChannels_) return;
+
+  matrix_[output * inputChannels_ + input] = gain;
+  selectKernel();
+}
+
+void ChannelMixer::selectKernel() {
+  bool identity = inputChannels_ == outputChannels_;
+
+  for (size_t output = 0; output < outputChannels_ && identity; ++output) {
+    for (size_t input = 0; input < inputChannels_; ++input) {
+      if (getGain(output, input) != (input == output ? 1.0f : 0.0f)) {
+        identity = false;
+        break;
+      }
+    }
+  }
+
+  kernel_ = identity ? Kernel::Identity : Kernel::Scalar;
+
+#ifdef AUDIO_SIMD_X86
+  if (!identity && outputChannels_ == 2) {
+    stereoGains_.assign(inputChannels_ * kLanes, 0.0f);
+
+    for (size_t input = 0; input < inputChannels_; ++input) {
+      for (size_t lane = 0; lane < kLanes; ++lane) {
+        stereoGains_[input * kLanes + lane] = getGain(lane % 2, input);
+      }
+    }
+
+    switch (CpuFeatures::getActiveLevel()) {
+      case SimdLevel::AVX2: kernel_ = Kernel::StereoAVX2; break;
+      case SimdLevel::SSE2: kernel_ = Kernel::StereoSSE2; break;
+      default: break;
+    }
+  }
+#endif
+}
+
+void ChannelMixer::process(const float* input, float* output, size_t frames) const {
+  size_t done = 0;
+
+  switch (kernel_) {
+    case Kernel::Identity:
+      std::memcpy(output, input, frames * inputChannels_ * sizeof(float));
+      return;
+
+#ifdef AUDIO_SIMD_X86
+    case Kernel::StereoAVX2:
+      done = mixStereoAVX2(input, output, frames, inputChannels_, stereoGains_.data());
+      break;
+
+    case Kernel::StereoSSE2:
+      done = mixStereoSSE2(input, output, frames, inputChannels_, stereoGains_.data());
+      break;
+#endif
+
+    default:
+      break;
+  }
+
+  mixScalar(input + done * inputChannels_, output + done * outputChannels_, frames - done,
+            inputChannels_, outputChannels_, matrix_.data());
+}
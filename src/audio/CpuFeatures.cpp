@@ -0,0 +1,71 @@
+#include "audio/CpuFeatures.h"
+#include <atomic>
+
+#if defined(AUDIO_SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+  std::atomic<int> levelOverride(-1);
+
+  SimdLevel detectLevel() {
+#if defined(AUDIO_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE2;
+    return SimdLevel::Scalar;
+#elif defined(AUDIO_SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+      __cpuidex(info, 7, 0);
+
+      if (info[1] & (1 << 5)) return SimdLevel::AVX2;
+    }
+
+    return sse2 ? SimdLevel::SSE2 : SimdLevel::Scalar;
+#else
+    return SimdLevel::Scalar;
+#endif
+  }
+}
+
+SimdLevel CpuFeatures::getSupportedLevel() {
+  static const SimdLevel supported = detectLevel();
+  return supported;
+}
+
+SimdLevel CpuFeatures::getActiveLevel() {
+  int forced = levelOverride.load(std::memory_order_relaxed);
+  SimdLevel supported = getSupportedLevel();
+
+  if (forced >= 0 && forced < static_cast<int>(supported)) {
+    return static_cast<SimdLevel>(forced);
+  }
+  return supported;
+}
+
+void CpuFeatures::setLevelOverride(SimdLevel level) {
+  levelOverride.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+void CpuFeatures::clearLevelOverride() {
+  levelOverride.store(-1, std::memory_order_relaxed);
+}
+
+const char* CpuFeatures::getLevelName(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::AVX2: return "AVX2";
+    case SimdLevel::SSE2: return "SSE2";
+    default: return "Scalar";
+  }
+}
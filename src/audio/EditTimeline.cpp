@@ -0,0 +1,257 @@
+#include "audio/EditTimeline.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+EditTimeline::EditTimeline(size_t sampleRate, size_t channels)
+  : sampleRate_(sampleRate), channels_(channels), state_(makeState({})) {
+  if (channels == 0) {
+    throw std::invalid_argument("Channel count must be greater than 0");
+  }
+}
+
+void EditTimeline::load(const AudioBuffer& buffer) {
+  sampleRate_ = buffer.getSampleRate();
+  channels_ = buffer.getChannelCount();
+
+  std::vector<Segment> segments;
+
+  if (buffer.getFrameCount() > 0) {
+    segments.push_back({ makeBlock(buffer), 0, buffer.getFrameCount() });
+  }
+
+  state_ = makeState(std::move(segments));
+  clearHistory();
+}
+
+float EditTimeline::getSample(size_t frame, size_t channel) const {
+  if (frame >= state_->frameCount || channel >= channels_) {
+    return 0.0f;
+  }
+
+  size_t index = findSegment(frame);
+  const Segment& segment = state_->segments[index];
+  size_t blockFrame = segment.offset + (frame - state_->starts[index]);
+
+  return (*segment.block)[blockFrame * channels_ + channel];
+}
+
+size_t EditTimeline::readFrames(size_t start, size_t frames, float* dest) const {
+  if (start >= state_->frameCount) return 0;
+
+  frames = std::min(frames, state_->frameCount - start);
+
+  size_t done = 0;
+  size_t index = findSegment(start);
+
+  while (done < frames) {
+    const Segment& segment = state_->segments[index];
+    size_t within = start + done - state_->starts[index];
+    size_t count = std::min(segment.frames - within, frames - done);
+
+    std::memcpy(dest + done * channels_,
+                segment.block->data() + (segment.offset + within) * channels_,
+                count * channels_ * sizeof(float));
+
+    done += count;
+    ++index;
+  }
+
+  return frames;
+}
+
+AudioBuffer EditTimeline::render() const {
+  AudioBuffer buffer(sampleRate_, channels_);
+  buffer.resize(state_->frameCount);
+  readFrames(0, state_->frameCount, buffer.getData());
+  return buffer;
+}
+
+EditTimeline::Clip EditTimeline::copy(size_t start, size_t frames) const {
+  Clip clip;
+  clip.segments = slice(start, frames);
+  clip.channels = channels_;
+
+  for (const Segment& segment : clip.segments) {
+    clip.frames += segment.frames;
+  }
+  return clip;
+}
+
+EditTimeline::Clip EditTimeline::cut(size_t start, size_t frames) {
+  Clip clip = copy(start, frames);
+  erase(start, frames);
+  return clip;
+}
+
+void EditTimeline::erase(size_t start, size_t frames) {
+  if (start >= state_->frameCount || frames == 0) return;
+
+  frames = std::min(frames, state_->frameCount - start);
+
+  std::vector<Segment> segments = slice(0, start);
+  std::vector<Segment> tail = slice(start + frames, state_->frameCount);
+  segments.insert(segments.end(), tail.begin(), tail.end());
+
+  commit(std::move(segments));
+}
+
+void EditTimeline::paste(size_t position, const Clip& clip) {
+  if (clip.frames == 0) return;
+
+  // Blocks hold interleaved frames of the clip's channel count; a clip from
+  // before a load() of different audio cannot be read with this one's
+  if (clip.channels != channels_) {
+    throw std::invalid_argument("Pasted clip must match the timeline's channel count");
+  }
+
+  position = std::min(position, state_->frameCount);
+
+  std::vector<Segment> segments = slice(0, position);
+  std::vector<Segment> tail = slice(position, state_->frameCount);
+  segments.insert(segments.end(), clip.segments.begin(), clip.segments.end());
+  segments.insert(segments.end(), tail.begin(), tail.end());
+
+  commit(std::move(segments));
+}
+
+void EditTimeline::insert(size_t position, const AudioBuffer& buffer) {
+  if (buffer.getChannelCount() != channels_) {
+    throw std::invalid_argument("Inserted audio must match the timeline's channel count");
+  }
+
+  Clip clip;
+  clip.frames = buffer.getFrameCount();
+  clip.channels = channels_;
+
+  if (clip.frames > 0) {
+    clip.segments.push_back({ makeBlock(buffer), 0, clip.frames });
+  }
+
+  paste(position, clip);
+}
+
+void EditTimeline::applyEffect(size_t start, size_t frames, AudioEffect& effect) {
+  if (start >= state_->frameCount || frames == 0) return;
+
+  frames = std::min(frames, state_->frameCount - start);
+
+  // Only the touched range is rendered; the rest keeps sharing its blocks
+  AudioBuffer region(sampleRate_, channels_);
+  region.resize(frames);
+  readFrames(start, frames, region.getData());
+  effect.process(region);
+
+  std::vector<Segment> segments = slice(0, start);
+  std::vector<Segment> tail = slice(start + frames, state_->frameCount);
+  segments.push_back({ makeBlock(region), 0, frames });
+  segments.insert(segments.end(), tail.begin(), tail.end());
+
+  commit(std::move(segments));
+}
+
+bool EditTimeline::undo() {
+  if (undoStack_.empty()) return false;
+
+  redoStack_.push_back(std::move(state_));
+  state_ = std::move(undoStack_.back());
+  undoStack_.pop_back();
+  return true;
+}
+
+bool EditTimeline::redo() {
+  if (redoStack_.empty()) return false;
+
+  undoStack_.push_back(std::move(state_));
+  state_ = std::move(redoStack_.back());
+  redoStack_.pop_back();
+  return true;
+}
+
+void EditTimeline::clearHistory() {
+  undoStack_.clear();
+  redoStack_.clear();
+}
+
+EditTimeline::StatePtr EditTimeline::makeState(std::vector<Segment> segments) {
+  auto state = std::make_shared<State>();
+  state->segments.reserve(segments.size());
+
+  for (Segment& segment : segments) {
+    if (segment.frames == 0) continue;
+
+    // Re-join neighbours that are contiguous in the same block, e.g. after
+    // cutting and pasting a range back in place
+    if (!state->segments.empty()) {
+      Segment& last = state->segments.back();
+
+      if (last.block == segment.block && last.offset + last.frames == segment.offset) {
+        last.frames += segment.frames;
+        continue;
+      }
+    }
+
+    state->segments.push_back(std::move(segment));
+  }
+
+  state->starts.reserve(state->segments.size());
+
+  for (const Segment& segment : state->segments) {
+    state->starts.push_back(state->frameCount);
+    state->frameCount += segment.frames;
+  }
+
+  return state;
+}
+
+size_t EditTimeline::findSegment(size_t frame) const {
+  const std::vector<size_t>& starts = state_->starts;
+  return static_cast<size_t>(std::upper_bound(starts.begin(), starts.end(), frame) - starts.begin()) - 1;
+}
+
+std::vector<EditTimeline::Segment> EditTimeline::slice(size_t start, size_t frames) const {
+  std::vector<Segment> result;
+
+  if (start >= state_->frameCount || frames == 0) return result;
+
+  size_t end = start + std::min(frames, state_->frameCount - start);
+
+  for (size_t index = findSegment(start); index < state_->segments.size(); ++index) {
+    size_t segmentStart = state_->starts[index];
+
+    if (segmentStart >= end) break;
+
+    const Segment& segment = state_->segments[index];
+    size_t from = std::max(start, segmentStart);
+    size_t to = std::min(end, segmentStart + segment.frames);
+
+    result.push_back({ segment.block, segment.offset + (from - segmentStart), to - from });
+  }
+
+  return result;
+}
+
+std::shared_ptr<const EditTimeline::SampleBlock> EditTimeline::makeBlock(const AudioBuffer& buffer) const {
+  auto block = std::make_shared<SampleBlock>(buffer.getFrameCount() * channels_);
+
+  ConstAudioBufferView view = buffer.getView();
+
+  if (!view.isEmpty()) {
+    copyFrames(view, AudioBufferView(block->data(), buffer.getFrameCount(), channels_));
+    return block;
+  }
+
+  // Mapped storage converts per sample
+  for (size_t frame = 0; frame < buffer.getFrameCount(); ++frame) {
+    for (size_t channel = 0; channel < channels_; ++channel) {
+      (*block)[frame * channels_ + channel] = buffer.getSample(frame, channel);
+    }
+  }
+  return block;
+}
+
+void EditTimeline::commit(std::vector<Segment> segments) {
+  undoStack_.push_back(std::move(state_));
+  redoStack_.clear();
+  state_ = makeState(std::move(segments));
+}
@@ -0,0 +1,21 @@
+#include "audio/EffectChain.h"
+
+void EffectChain::addEffect(std::shared_ptr<AudioEffect> effect) {
+  effects_.push_back(std::move(effect));
+}
+
+void EffectChain::prepare(size_t sampleRate, size_t maxBlockFrames, size_t channels) {
+  AudioEffect::prepare(sampleRate, maxBlockFrames, channels);
+
+  for (const auto& effect : effects_) {
+    effect->prepare(sampleRate, maxBlockFrames, channels);
+  }
+}
+
+void EffectChain::processBlock(float* samples, size_t frames) {
+  for (const auto& effect : effects_) {
+    if (effect->isEnabled()) {
+      effect->processBlock(samples, frames);
+    }
+  }
+}
@@ -1,16 +1,52 @@
 #include "audio/GainEffect.h"
 #include <algorithm>
 
-GainEffect::GainEffect(float gain) : gain_(gain) {
-  if (gain < 0.0f) gain_ = 0.0f;
+namespace {
+  // Per-frame gains applied to interleaved samples. The common layouts get
+  // their own loops so the compiler can vectorize them.
+  void applyGainRamp(float* samples, const float* gains, size_t frames, size_t channels) {
+    if (channels == 1) {
+      for (size_t i = 0; i < frames; ++i) {
+        samples[i] *= gains[i];
+      }
+    }
+    else if (channels == 2) {
+      for (size_t i = 0; i < frames; ++i) {
+        samples[2 * i] *= gains[i];
+        samples[2 * i + 1] *= gains[i];
+      }
+    }
+    else {
+      for (size_t i = 0; i < frames; ++i) {
+        for (size_t channel = 0; channel < channels; ++channel) {
+          samples[i * channels + channel] *= gains[i];
+        }
+      }
+    }
+  }
 }
 
-void GainEffect::process(AudioBuffer& buffer) {
-  if (!enabled_) return;
+GainEffect::GainEffect(float gain) : gain_(std::max(0.0f, gain)) {}
 
-  buffer.applyGain(gain_);
+void GainEffect::prepare(size_t sampleRate, size_t maxBlockFrames, size_t channels) {
+  AudioEffect::prepare(sampleRate, maxBlockFrames, channels);
+  gain_.prepare(sampleRate, maxBlockFrames);
+}
+
+void GainEffect::processBlock(float* samples, size_t frames) {
+  if (gain_.processBlock(frames)) {
+    applyGainRamp(samples, gain_.getValues(), frames, channels_);
+    return;
+  }
+
+  const float gain = gain_.getCurrentValue();
+  const size_t count = frames * channels_;
+
+  for (size_t i = 0; i < count; ++i) {
+    samples[i] *= gain;
+  }
 }
 
 void GainEffect::setGain(float gain) {
-  gain_ = std::max(0.0f, gain);
-}
\ No newline at end of file
+  gain_.setTarget(std::max(0.0f, gain));
+}
@@ -0,0 +1,162 @@
+#include "audio/MappedFile.h"
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+  : data_(nullptr), size_(0)
+#ifdef _WIN32
+  , fileHandle_(INVALID_HANDLE_VALUE), mappingHandle_(nullptr)
+#endif
+{}
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& filename) {
+  close();
+
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+  if (file == INVALID_HANDLE_VALUE) {
+    std::cerr << "Cannot open file for mapping: " << filename << std::endl;
+    return false;
+  }
+
+  LARGE_INTEGER fileSize;
+
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+  if (!mapping) {
+    std::cerr << "Failed to map file: " << filename << std::endl;
+    CloseHandle(file);
+    return false;
+  }
+
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+  if (!view) {
+    std::cerr << "Failed to map file: " << filename << std::endl;
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  fileHandle_ = file;
+  mappingHandle_ = mapping;
+  data_ = static_cast<const uint8_t*>(view);
+  size_ = static_cast<size_t>(fileSize.QuadPart);
+  return true;
+}
+
+void MappedFile::close() {
+  if (data_) {
+    UnmapViewOfFile(data_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  if (mappingHandle_) {
+    CloseHandle(mappingHandle_);
+    mappingHandle_ = nullptr;
+  }
+
+  if (fileHandle_ != INVALID_HANDLE_VALUE) {
+    CloseHandle(fileHandle_);
+    fileHandle_ = INVALID_HANDLE_VALUE;
+  }
+}
+
+void MappedFile::adviseSequential(size_t, size_t) const {}
+
+void MappedFile::adviseWillNeed(size_t offset, size_t length) const {
+  if (!data_ || offset >= size_) return;
+
+  WIN32_MEMORY_RANGE_ENTRY range;
+  range.VirtualAddress = const_cast<uint8_t*>(data_) + offset;
+  range.NumberOfBytes = std::min(length, size_ - offset);
+  PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+bool MappedFile::open(const std::string& filename) {
+  close();
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+
+  if (fd < 0) {
+    std::cerr << "Cannot open file for mapping: " << filename << std::endl;
+    return false;
+  }
+
+  struct stat st;
+
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+
+  void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+  // The mapping keeps its own reference to the file
+  ::close(fd);
+
+  if (view == MAP_FAILED) {
+    std::cerr << "Failed to map file: " << filename << std::endl;
+    return false;
+  }
+
+  data_ = static_cast<const uint8_t*>(view);
+  size_ = static_cast<size_t>(st.st_size);
+  return true;
+}
+
+void MappedFile::close() {
+  if (data_) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+}
+
+namespace {
+  // madvise requires a page-aligned start address
+  void adviseRange(const uint8_t* base, size_t size, size_t offset, size_t length, int advice) {
+    if (!base || offset >= size) return;
+
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t alignedOffset = offset - offset % pageSize;
+    size_t end = std::min(size, offset + length);
+
+    madvise(const_cast<uint8_t*>(base) + alignedOffset, end - alignedOffset, advice);
+  }
+}
+
+void MappedFile::adviseSequential(size_t offset, size_t length) const {
+  adviseRange(data_, size_, offset, length, MADV_SEQUENTIAL);
+}
+
+void MappedFile::adviseWillNeed(size_t offset, size_t length) const {
+  adviseRange(data_, size_, offset, length, MADV_WILLNEED);
+}
+
+#endif
@@ -0,0 +1,68 @@
+#include "audio/ParallelEffects.h"
+#include <algorithm>
+
+ParallelEffects::ParallelEffects(float dryLevel)
+  : dryLevel_(dryLevel), threadPool_(nullptr) {}
+
+size_t ParallelEffects::addBranch(std::shared_ptr<AudioEffect> effect, float level) {
+  auto branch = std::make_unique<Branch>();
+  branch->effect = std::move(effect);
+  branch->level = level;
+
+  branches_.push_back(std::move(branch));
+  return branches_.size() - 1;
+}
+
+void ParallelEffects::setBranchLevel(size_t branch, float level) {
+  if (branch < branches_.size()) {
+    branches_[branch]->level = level;
+  }
+}
+
+void ParallelEffects::prepare(size_t sampleRate, size_t maxBlockFrames, size_t channels) {
+  AudioEffect::prepare(sampleRate, maxBlockFrames, channels);
+
+  for (auto& branch : branches_) {
+    branch->effect->prepare(sampleRate, maxBlockFrames, channels);
+    branch->scratch.assign(maxBlockFrames * channels, 0.0f);
+  }
+}
+
+void ParallelEffects::runBranch(Branch& branch, const float* input, size_t samples) {
+  std::copy(input, input + samples, branch.scratch.begin());
+
+  if (branch.effect->isEnabled()) {
+    branch.effect->processBlock(branch.scratch.data(), samples / channels_);
+  }
+}
+
+void ParallelEffects::processBlock(float* samples, size_t frames) {
+  const size_t count = frames * channels_;
+
+  if (threadPool_ && branches_.size() > 1) {
+    threadPool_->parallelFor(branches_.size(), [&](size_t index) {
+      runBranch(*branches_[index], samples, count);
+    });
+  }
+  else {
+    for (auto& branch : branches_) {
+      runBranch(*branch, samples, count);
+    }
+  }
+
+  // Mix bus
+  const float dry = dryLevel_.load(std::memory_order_relaxed);
+
+  for (size_t i = 0; i < count; ++i) {
+    samples[i] *= dry;
+  }
+
+  for (const auto& branch : branches_) {
+    const float level = branch->level.load(std::memory_order_relaxed);
+    const float* wet = branch->scratch.data();
+
+    for (size_t i = 0; i < count; ++i) {
+      samples[i] += wet[i] * level;
+    }
+  }
+}
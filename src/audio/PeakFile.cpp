@@ -0,0 +1,130 @@
+#include "audio/PeakFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+  const char kMagic[4] = { 'P', 'E', 'A', 'K' };
+
+  // Bytes hashed at each end of the audio file
+  const uint64_t kHashedBytes = 64 * 1024;
+
+  // FNV-1a, 64-bit
+  uint64_t hashBytes(uint64_t hash, const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+      hash ^= static_cast<uint8_t>(data[i]);
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  bool hashRange(std::ifstream& file, uint64_t offset, uint64_t size, uint64_t& hash) {
+    std::vector<char> block(size);
+
+    file.seekg(static_cast<std::streamoff>(offset));
+
+    if (!file.read(block.data(), static_cast<std::streamsize>(size))) return false;
+
+    hash = hashBytes(hash, block.data(), block.size());
+    return true;
+  }
+
+  template <typename T>
+  void writeValue(std::ofstream& file, T value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  bool readValue(std::ifstream& file, T& value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+}
+
+std::string PeakFile::getSidecarPath(const std::string& audioFilename) {
+  return audioFilename + ".peak";
+}
+
+bool PeakFile::computeKey(const std::string& audioFilename, PeakFileKey& key) {
+  std::error_code error;
+  uint64_t fileSize = std::filesystem::file_size(audioFilename, error);
+
+  if (error) return false;
+
+  auto modifiedTime = std::filesystem::last_write_time(audioFilename, error);
+
+  if (error) return false;
+
+  std::ifstream file(audioFilename, std::ios::binary);
+
+  if (!file.is_open()) return false;
+
+  uint64_t hash = 14695981039346656037ULL;
+  uint64_t headBytes = std::min(fileSize, kHashedBytes);
+  uint64_t tailBytes = std::min(fileSize - headBytes, kHashedBytes);
+
+  if (!hashRange(file, 0, headBytes, hash) ||
+      !hashRange(file, fileSize - tailBytes, tailBytes, hash)) {
+    return false;
+  }
+
+  key.fileSize = fileSize;
+  key.modifiedTime = static_cast<int64_t>(modifiedTime.time_since_epoch().count());
+  key.contentHash = hash;
+  return true;
+}
+
+bool PeakFile::load(const std::string& sidecarFilename, const PeakFileKey& key, PeakPyramid& peaks) {
+  std::ifstream file(sidecarFilename, std::ios::binary);
+
+  if (!file.is_open()) return false;
+
+  char magic[4];
+  uint32_t version;
+  PeakFileKey storedKey;
+
+  if (!file.read(magic, 4) || std::memcmp(magic, kMagic, 4) != 0 ||
+      !readValue(file, version) || version != kVersion) {
+    return false;
+  }
+
+  if (!readValue(file, storedKey.fileSize) || !readValue(file, storedKey.modifiedTime) ||
+      !readValue(file, storedKey.contentHash) || storedKey != key) {
+    return false;
+  }
+
+  return peaks.read(file);
+}
+
+bool PeakFile::save(const std::string& sidecarFilename, const PeakFileKey& key, const PeakPyramid& peaks) {
+  std::string tempFilename = sidecarFilename + ".tmp";
+
+  {
+    std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open()) return false;
+
+    file.write(kMagic, 4);
+    writeValue<uint32_t>(file, kVersion);
+    writeValue<uint64_t>(file, key.fileSize);
+    writeValue<int64_t>(file, key.modifiedTime);
+    writeValue<uint64_t>(file, key.contentHash);
+
+    if (!peaks.write(file) || !file.flush()) {
+      file.close();
+      std::remove(tempFilename.c_str());
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tempFilename, sidecarFilename, error);
+
+  if (error) {
+    std::remove(tempFilename.c_str());
+    return false;
+  }
+  return true;
+}
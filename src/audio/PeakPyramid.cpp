@@ -0,0 +1,243 @@
+#include "audio/PeakPyramid.h"
+#include <algorithm>
+#include <cmath>
+#include <istream>
+#include <ostream>
+
+namespace {
+  template <typename T>
+  void writeValue(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  bool readValue(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+}
+
+PeakPyramid::PeakPyramid()
+  : frameCount_(0), channels_(0) {}
+
+void PeakPyramid::build(const AudioBuffer& buffer) {
+  reset(buffer.getFrameCount(), buffer.getChannelCount());
+  computeBase(buffer, 0, levels_[0].size());
+
+  for (size_t level = 1; level < kLevelCount; ++level) {
+    computeLevel(level, 0, levels_[level].size());
+  }
+}
+
+void PeakPyramid::update(const AudioBuffer& buffer, size_t startFrame, size_t frames) {
+  if (buffer.getFrameCount() != frameCount_ || buffer.getChannelCount() != channels_) {
+    build(buffer);
+    return;
+  }
+
+  if (startFrame >= frameCount_ || frames == 0) return;
+
+  size_t endFrame = std::min(frameCount_, startFrame + frames);
+  size_t firstBucket = startFrame / kBaseBucketFrames;
+  size_t lastBucket = (endFrame + kBaseBucketFrames - 1) / kBaseBucketFrames;
+
+  computeBase(buffer, firstBucket, lastBucket);
+
+  for (size_t level = 1; level < kLevelCount; ++level) {
+    firstBucket /= kLevelRatio;
+    lastBucket = (lastBucket + kLevelRatio - 1) / kLevelRatio;
+    computeLevel(level, firstBucket, lastBucket);
+  }
+}
+
+void PeakPyramid::reset(size_t frameCount, size_t channels) {
+  frameCount_ = frameCount;
+  channels_ = channels;
+
+  for (size_t level = 0; level < kLevelCount; ++level) {
+    size_t bucketFrames = getBucketFrames(level);
+    levels_[level].assign((frameCount_ + bucketFrames - 1) / bucketFrames, Bucket{ 0.0f, 0.0f, 0.0f });
+  }
+}
+
+bool PeakPyramid::insertPiece(const PeakPyramid& piece, size_t startFrame) {
+  size_t alignment = getBucketFrames(kLevelCount - 1);
+
+  if (piece.channels_ != channels_ || startFrame % alignment != 0 || startFrame > frameCount_ ||
+      piece.frameCount_ > frameCount_ - startFrame ||
+      (startFrame + piece.frameCount_ < frameCount_ && piece.frameCount_ % alignment != 0)) {
+    return false;
+  }
+
+  for (size_t level = 0; level < kLevelCount; ++level) {
+    size_t firstBucket = startFrame / getBucketFrames(level);
+    std::copy(piece.levels_[level].begin(), piece.levels_[level].end(), levels_[level].begin() + firstBucket);
+  }
+  return true;
+}
+
+void PeakPyramid::clear() {
+  for (auto& level : levels_) {
+    level.clear();
+  }
+
+  frameCount_ = 0;
+  channels_ = 0;
+}
+
+size_t PeakPyramid::getBucketFrames(size_t level) const {
+  size_t bucketFrames = kBaseBucketFrames;
+
+  for (size_t i = 0; i < level; ++i) {
+    bucketFrames *= kLevelRatio;
+  }
+  return bucketFrames;
+}
+
+size_t PeakPyramid::getBucketCount(size_t level) const {
+  return level < kLevelCount ? levels_[level].size() : 0;
+}
+
+void PeakPyramid::computeBase(const AudioBuffer& buffer, size_t firstBucket, size_t lastBucket) {
+  // Owned storage is scanned through a view in either layout; mapped storage
+  // converts per sample
+  ConstAudioBufferView view = buffer.getView();
+  bool direct = !view.isEmpty();
+
+  for (size_t bucket = firstBucket; bucket < lastBucket; ++bucket) {
+    size_t startFrame = bucket * kBaseBucketFrames;
+    size_t endFrame = std::min(frameCount_, startFrame + kBaseBucketFrames);
+
+    float minValue = 0.0f;
+    float maxValue = 0.0f;
+    float sumSquares = 0.0f;
+    bool first = true;
+
+    for (size_t frame = startFrame; frame < endFrame; ++frame) {
+      for (size_t channel = 0; channel < channels_; ++channel) {
+        float sample = direct ? view.at(frame, channel) : buffer.getSample(frame, channel);
+
+        if (first) {
+          minValue = maxValue = sample;
+          first = false;
+        }
+        else {
+          minValue = std::min(minValue, sample);
+          maxValue = std::max(maxValue, sample);
+        }
+        sumSquares += sample * sample;
+      }
+    }
+
+    levels_[0][bucket] = { minValue, maxValue, sumSquares };
+  }
+}
+
+void PeakPyramid::computeLevel(size_t level, size_t firstBucket, size_t lastBucket) {
+  const std::vector<Bucket>& children = levels_[level - 1];
+  std::vector<Bucket>& buckets = levels_[level];
+
+  for (size_t bucket = firstBucket; bucket < lastBucket; ++bucket) {
+    size_t firstChild = bucket * kLevelRatio;
+    size_t lastChild = std::min(children.size(), firstChild + kLevelRatio);
+
+    Bucket summary = children[firstChild];
+
+    for (size_t child = firstChild + 1; child < lastChild; ++child) {
+      summary.min = std::min(summary.min, children[child].min);
+      summary.max = std::max(summary.max, children[child].max);
+      summary.sumSquares += children[child].sumSquares;
+    }
+
+    buckets[bucket] = summary;
+  }
+}
+
+PeakSummary PeakPyramid::query(size_t startFrame, size_t frames) const {
+  PeakSummary summary;
+
+  if (startFrame >= frameCount_ || frames == 0) return summary;
+
+  frames = std::min(frames, frameCount_ - startFrame);
+
+  size_t level = 0;
+
+  while (level + 1 < kLevelCount && getBucketFrames(level + 1) <= frames) {
+    ++level;
+  }
+
+  const std::vector<Bucket>& buckets = levels_[level];
+  size_t bucketFrames = getBucketFrames(level);
+  size_t endFrame = startFrame + frames;
+
+  size_t firstBucket = startFrame / bucketFrames;
+  size_t lastBucket = endFrame >= frameCount_ ? buckets.size() : endFrame / bucketFrames;
+  lastBucket = std::min(buckets.size(), std::max(lastBucket, firstBucket + 1));
+
+  summary.min = buckets[firstBucket].min;
+  summary.max = buckets[firstBucket].max;
+  double sumSquares = 0.0;
+
+  for (size_t bucket = firstBucket; bucket < lastBucket; ++bucket) {
+    summary.min = std::min(summary.min, buckets[bucket].min);
+    summary.max = std::max(summary.max, buckets[bucket].max);
+    sumSquares += buckets[bucket].sumSquares;
+  }
+
+  size_t coveredFrames = std::min(frameCount_, lastBucket * bucketFrames) - firstBucket * bucketFrames;
+  summary.rms = static_cast<float>(std::sqrt(sumSquares / (coveredFrames * channels_)));
+  return summary;
+}
+
+bool PeakPyramid::write(std::ostream& out) const {
+  writeValue<uint64_t>(out, frameCount_);
+  writeValue<uint32_t>(out, static_cast<uint32_t>(channels_));
+  writeValue<uint32_t>(out, kBaseBucketFrames);
+  writeValue<uint32_t>(out, kLevelRatio);
+  writeValue<uint32_t>(out, kLevelCount);
+
+  for (const auto& level : levels_) {
+    writeValue<uint64_t>(out, level.size());
+    out.write(reinterpret_cast<const char*>(level.data()), level.size() * sizeof(Bucket));
+  }
+
+  return static_cast<bool>(out);
+}
+
+bool PeakPyramid::read(std::istream& in) {
+  uint64_t frameCount;
+  uint32_t channels, baseBucketFrames, levelRatio, levelCount;
+
+  if (!readValue(in, frameCount) || !readValue(in, channels) || !readValue(in, baseBucketFrames) ||
+      !readValue(in, levelRatio) || !readValue(in, levelCount)) {
+    return false;
+  }
+
+  if (baseBucketFrames != kBaseBucketFrames || levelRatio != kLevelRatio || levelCount != kLevelCount) {
+    return false;
+  }
+
+  std::vector<Bucket> levels[kLevelCount];
+
+  for (size_t level = 0; level < kLevelCount; ++level) {
+    size_t bucketFrames = getBucketFrames(level);
+    uint64_t bucketCount;
+
+    if (!readValue(in, bucketCount) || bucketCount != (frameCount + bucketFrames - 1) / bucketFrames) {
+      return false;
+    }
+
+    levels[level].resize(bucketCount);
+
+    if (!in.read(reinterpret_cast<char*>(levels[level].data()), bucketCount * sizeof(Bucket))) {
+      return false;
+    }
+  }
+
+  for (size_t level = 0; level < kLevelCount; ++level) {
+    levels_[level] = std::move(levels[level]);
+  }
+
+  frameCount_ = frameCount;
+  channels_ = channels;
+  return true;
+}
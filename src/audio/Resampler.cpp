@@ -0,0 +1,364 @@
+#include "audio/Resampler.h"
+#include "audio/CpuFeatures.h"
+#include "audio/ThreadPool.h"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#ifdef AUDIO_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+  // Passband edge as a fraction of the lower Nyquist frequency
+  const double kRolloff = 0.95;
+
+  // Output frames per task in offline conversion
+  const size_t kConvertChunkFrames = 16384;
+
+  size_t getHalfTaps(Resampler::Quality quality) {
+    switch (quality) {
+      case Resampler::Quality::Fast: return 8;
+      case Resampler::Quality::High: return 32;
+      default: return 16;
+    }
+  }
+
+  double getKaiserBeta(Resampler::Quality quality) {
+    switch (quality) {
+      case Resampler::Quality::Fast: return 6.0;
+      case Resampler::Quality::High: return 10.0;
+      default: return 8.6;
+    }
+  }
+
+  // Zeroth-order modified Bessel function of the first kind
+  double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+
+    for (int k = 1; k < 50; ++k) {
+      term *= (x / (2.0 * k)) * (x / (2.0 * k));
+      sum += term;
+
+      if (term < sum * 1e-12) break;
+    }
+    return sum;
+  }
+
+  float dotScalar(const float* a, const float* b, size_t count) {
+    float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+
+    for (size_t i = 0; i < count; i += 4) {
+      sum0 += a[i] * b[i];
+      sum1 += a[i + 1] * b[i + 1];
+      sum2 += a[i + 2] * b[i + 2];
+      sum3 += a[i + 3] * b[i + 3];
+    }
+    return (sum0 + sum1) + (sum2 + sum3);
+  }
+
+#ifdef AUDIO_SIMD_X86
+
+  // Tap counts are multiples of 8, so the vector kernels need no tail
+
+  AUDIO_TARGET_SSE2 float dotSSE2(const float* a, const float* b, size_t count) {
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+
+    for (size_t i = 0; i < count; i += 8) {
+      sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+      sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(sum0, sum1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  }
+
+  AUDIO_TARGET_AVX2 float dotAVX2(const float* a, const float* b, size_t count) {
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+      sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+      sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+
+    if (i < count) {
+      sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+
+    __m256 sum = _mm256_add_ps(sum0, sum1);
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, half);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  }
+
+#endif
+}
+
+// Filter rows for every phase, `taps` coefficients each. With interpolation
+// there is one extra row (phase P) so phase P - 1 has a right neighbour.
+struct Resampler::FilterBank {
+  uint64_t upFactor = 1;      // L
+  uint64_t downFactor = 1;    // M
+  size_t phases = 1;          // P
+  size_t halfTaps = 0;
+  size_t wholeStep = 0;       // M / L
+  uint64_t phaseStep = 0;     // M % L
+  bool interpolate = false;
+  std::vector<float, AlignedAllocator<float>> coefficients;
+
+  const float* getRow(size_t phase) const { return coefficients.data() + phase * halfTaps * 2; }
+};
+
+Resampler::Resampler(size_t inputRate, size_t outputRate, size_t channels, size_t maxOutputFrames, Quality quality)
+  : inputRate_(std::max<size_t>(1, inputRate)), outputRate_(std::max<size_t>(1, outputRate)),
+  channels_(std::max<size_t>(1, channels)), maxOutputFrames_(maxOutputFrames), taps_(0),
+  dot_(dotScalar), historyCapacity_(0), buffered_(0), index_(0), phase_(0) {
+  auto bank = std::make_shared<FilterBank>();
+
+  uint64_t divisor = std::gcd(inputRate_, outputRate_);
+  bank->upFactor = outputRate_ / divisor;
+  bank->downFactor = inputRate_ / divisor;
+  bank->phases = static_cast<size_t>(std::min<uint64_t>(bank->upFactor, kMaxPhases));
+  bank->interpolate = bank->phases < bank->upFactor;
+  bank->wholeStep = static_cast<size_t>(bank->downFactor / bank->upFactor);
+  bank->phaseStep = bank->downFactor % bank->upFactor;
+
+  // Downsampling lowers the cutoff below the input Nyquist frequency and
+  // widens the filter in proportion, so the transition band stays as sharp
+  double ratio = std::min(1.0, static_cast<double>(bank->upFactor) / bank->downFactor);
+  double cutoff = ratio * kRolloff;
+  size_t halfTaps = static_cast<size_t>(std::ceil(getHalfTaps(quality) / ratio));
+  halfTaps = std::min<size_t>(256, (halfTaps + 3) / 4 * 4);
+  bank->halfTaps = halfTaps;
+  taps_ = 2 * halfTaps;
+
+  double beta = getKaiserBeta(quality);
+  double window = besselI0(beta);
+  size_t rows = bank->phases + (bank->interpolate ? 1 : 0);
+  bank->coefficients.resize(rows * taps_);
+
+  for (size_t row = 0; row < rows; ++row) {
+    double fraction = static_cast<double>(row) / bank->phases;
+    float* coefficients = bank->coefficients.data() + row * taps_;
+    double sum = 0.0;
+
+    for (size_t tap = 0; tap < taps_; ++tap) {
+      // Distance from the output position to this input frame
+      double distance = static_cast<double>(tap) - (halfTaps - 1) - fraction;
+      double x = distance / halfTaps;
+      double sinc = distance == 0.0 ? 1.0 : std::sin(M_PI * cutoff * distance) / (M_PI * cutoff * distance);
+      double value = std::abs(x) < 1.0 ? cutoff * sinc * besselI0(beta * std::sqrt(1.0 - x * x)) / window : 0.0;
+
+      coefficients[tap] = static_cast<float>(value);
+      sum += value;
+    }
+
+    // Unity gain at DC for every phase
+    for (size_t tap = 0; tap < taps_; ++tap) {
+      coefficients[tap] = static_cast<float>(coefficients[tap] / sum);
+    }
+  }
+
+  bank_ = std::move(bank);
+
+#ifdef AUDIO_SIMD_X86
+  switch (CpuFeatures::getActiveLevel()) {
+    case SimdLevel::AVX2: dot_ = dotAVX2; break;
+    case SimdLevel::SSE2: dot_ = dotSSE2; break;
+    default: dot_ = dotScalar; break;
+  }
+#endif
+
+  // Worst case after a process() call: the kept filter window plus the input
+  // for maxOutputFrames more frames
+  uint64_t maxInput = (maxOutputFrames_ * bank_->downFactor + bank_->upFactor - 1) / bank_->upFactor;
+  historyCapacity_ = taps_ + static_cast<size_t>(maxInput) + 2;
+  history_.assign(historyCapacity_ * channels_, 0.0f);
+  inputBlock_.assign(historyCapacity_ * channels_, 0.0f);
+
+  reset();
+}
+
+void Resampler::reset() {
+  // Half a window of silence before the first input frame, so output frame
+  // 0 is centred on input frame 0
+  size_t lead = bank_->halfTaps - 1;
+
+  for (size_t channel = 0; channel < channels_; ++channel) {
+    std::fill_n(history_.begin() + channel * historyCapacity_, lead, 0.0f);
+  }
+
+  buffered_ = lead;
+  index_ = lead;
+  phase_ = 0;
+}
+
+size_t Resampler::getInputFramesFor(size_t outputFrames) const {
+  if (outputFrames == 0) return 0;
+
+  uint64_t last = index_ + (phase_ + (outputFrames - 1) * bank_->downFactor) / bank_->upFactor;
+  uint64_t needed = last + bank_->halfTaps + 1;
+
+  return needed > buffered_ ? static_cast<size_t>(needed - buffered_) : 0;
+}
+
+size_t Resampler::getOutputFramesFor(size_t inputFrames) const {
+  uint64_t end = buffered_ + inputFrames;
+
+  if (end <= index_) return 0;
+
+  uint64_t span = (end - index_) * bank_->upFactor;
+
+  if (span <= phase_) return 0;
+  return static_cast<size_t>((span - phase_ + bank_->downFactor - 1) / bank_->downFactor);
+}
+
+float Resampler::filter(const float* samples, uint64_t phase) const {
+  const FilterBank& bank = *bank_;
+
+  if (!bank.interpolate) {
+    return dot_(samples, bank.getRow(static_cast<size_t>(phase)), taps_);
+  }
+
+  uint64_t scaled = phase * bank.phases;
+  size_t row = static_cast<size_t>(scaled / bank.upFactor);
+  float weight = static_cast<float>(scaled % bank.upFactor) / bank.upFactor;
+
+  float a = dot_(samples, bank.getRow(row), taps_);
+  float b = dot_(samples, bank.getRow(row + 1), taps_);
+  return a + weight * (b - a);
+}
+
+void Resampler::process(const float* input, float* output, size_t outputFrames) {
+  assert(outputFrames <= maxOutputFrames_);
+
+  const FilterBank& bank = *bank_;
+  size_t inputFrames = getInputFramesFor(outputFrames);
+
+  assert(buffered_ + inputFrames <= historyCapacity_);
+
+  for (size_t channel = 0; channel < channels_; ++channel) {
+    float* history = history_.data() + channel * historyCapacity_ + buffered_;
+
+    for (size_t frame = 0; frame < inputFrames; ++frame) {
+      history[frame] = input[frame * channels_ + channel];
+    }
+  }
+  buffered_ += inputFrames;
+
+  for (size_t frame = 0; frame < outputFrames; ++frame) {
+    const float* window = history_.data() + index_ - (bank.halfTaps - 1);
+
+    for (size_t channel = 0; channel < channels_; ++channel) {
+      output[frame * channels_ + channel] = filter(window + channel * historyCapacity_, phase_);
+    }
+
+    // Step by M/L input frames without a division per frame
+    index_ += bank.wholeStep;
+    phase_ += bank.phaseStep;
+
+    if (phase_ >= bank.upFactor) {
+      phase_ -= bank.upFactor;
+      ++index_;
+    }
+  }
+
+  // Drop history no future window reaches
+  size_t discard = std::min(buffered_, index_ - (bank.halfTaps - 1));
+
+  if (discard > 0) {
+    for (size_t channel = 0; channel < channels_; ++channel) {
+      float* history = history_.data() + channel * historyCapacity_;
+      std::memmove(history, history + discard, (buffered_ - discard) * sizeof(float));
+    }
+
+    buffered_ -= discard;
+    index_ -= discard;
+  }
+}
+
+AudioBuffer Resampler::convert(const AudioBuffer& input, size_t outputRate, ThreadPool* pool, Quality quality) {
+  size_t channels = input.getChannelCount();
+  size_t inputFrames = input.getFrameCount();
+
+  Resampler resampler(input.getSampleRate(), outputRate, channels, 0, quality);
+  const FilterBank& bank = *resampler.bank_;
+  size_t taps = resampler.taps_;
+
+  // Filter windows run over unit-stride channels
+  AudioBuffer planarCopy;
+  const AudioBuffer* source = &input;
+
+  if (input.isMapped() || input.getLayout() != SampleLayout::Planar) {
+    planarCopy = input;
+    planarCopy.setLayout(SampleLayout::Planar);
+    source = &planarCopy;
+  }
+
+  ConstAudioBufferView sourceView = source->getView();
+
+  uint64_t outputFrames = (static_cast<uint64_t>(inputFrames) * bank.upFactor + bank.downFactor - 1) / bank.downFactor;
+  AudioBuffer output(outputRate, channels, SampleLayout::Planar);
+  output.resize(static_cast<size_t>(outputFrames));
+
+  AudioBufferView outputView = output.getView();
+  size_t chunks = (static_cast<size_t>(outputFrames) + kConvertChunkFrames - 1) / kConvertChunkFrames;
+
+  auto task = [&](size_t job) {
+    size_t channel = job / chunks;
+    size_t first = (job % chunks) * kConvertChunkFrames;
+    size_t last = std::min<size_t>(static_cast<size_t>(outputFrames), first + kConvertChunkFrames);
+
+    const float* samples = sourceView.getChannelData(channel);
+    float* dest = outputView.getChannelData(channel);
+    std::vector<float> edge(taps);
+
+    uint64_t position = static_cast<uint64_t>(first) * bank.downFactor;
+    int64_t start = static_cast<int64_t>(position / bank.upFactor) - static_cast<int64_t>(bank.halfTaps - 1);
+    uint64_t phase = position % bank.upFactor;
+
+    for (size_t frame = first; frame < last; ++frame) {
+      if (start >= 0 && static_cast<uint64_t>(start) + taps <= inputFrames) {
+        dest[frame] = resampler.filter(samples + start, phase);
+      }
+      else {
+        // Zeros beyond either end of the input
+        for (size_t tap = 0; tap < taps; ++tap) {
+          int64_t index = start + static_cast<int64_t>(tap);
+          edge[tap] = index >= 0 && static_cast<uint64_t>(index) < inputFrames ? samples[index] : 0.0f;
+        }
+        dest[frame] = resampler.filter(edge.data(), phase);
+      }
+
+      start += bank.wholeStep;
+      phase += bank.phaseStep;
+
+      if (phase >= bank.upFactor) {
+        phase -= bank.upFactor;
+        ++start;
+      }
+    }
+  };
+
+  if (pool) {
+    pool->parallelFor(chunks * channels, task);
+  }
+  else {
+    for (size_t i = 0; i < chunks * channels; ++i) {
+      task(i);
+    }
+  }
+
+  if (input.getLayout() == SampleLayout::Interleaved) {
+    output.setLayout(SampleLayout::Interleaved);
+  }
+  return output;
+}
@@ -0,0 +1,465 @@
+#include "audio/SampleConversion.h"
+#include "audio/CpuFeatures.h"
+#include <cmath>
+#include <cstring>
+
+#ifdef AUDIO_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+  const float kInt16Scale = 32768.0f;
+  const float kInt24Scale = 8388608.0f;
+  const float kInt32Scale = 2147483648.0f;
+
+  // Largest float below 1.0; keeps full-scale positive input inside int32
+  const float kInt32MaxInput = 0.99999994f;
+
+  // Clamp written so NaN maps to -1, matching _mm_max_ps/_mm_min_ps
+  inline float clampUnit(float x, float upper = 1.0f) {
+    x = x > -1.0f ? x : -1.0f;
+    return x < upper ? x : upper;
+  }
+
+  // Scalar kernels (also used for the tails of the SIMD kernels)
+
+  void int16ToFloatScalar(const uint8_t* src, float* dest, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      int16_t value;
+      std::memcpy(&value, src + i * 2, 2);
+      dest[i] = static_cast<float>(value) * (1.0f / kInt16Scale);
+    }
+  }
+
+  void int24ToFloatScalar(const uint8_t* src, float* dest, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      const uint8_t* p = src + i * 3;
+      uint32_t bits = static_cast<uint32_t>(p[0]) << 8 | static_cast<uint32_t>(p[1]) << 16 |
+                      static_cast<uint32_t>(p[2]) << 24;
+      dest[i] = static_cast<float>(static_cast<int32_t>(bits) >> 8) * (1.0f / kInt24Scale);
+    }
+  }
+
+  void int32ToFloatScalar(const uint8_t* src, float* dest, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      int32_t value;
+      std::memcpy(&value, src + i * 4, 4);
+      dest[i] = static_cast<float>(value) * (1.0f / kInt32Scale);
+    }
+  }
+
+  // Converts the top 24 bits of a generator output to a float scale
+  const float kRandomUnit = 1.0f / 16777216.0f;
+
+  inline uint32_t nextRandom(uint32_t& x) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+  }
+
+  // Sample i always draws from lane i % kLanes, which is what lets the SIMD
+  // kernels match this one exactly. The difference of two uniform draws is
+  // triangular; both are whole multiples of kRandomUnit, so the noise is
+  // exact and only the final addition rounds.
+  void ditherScalar(float* samples, size_t count, float lsb, uint32_t* lanes) {
+    const float scale = kRandomUnit * lsb;
+
+    for (size_t i = 0; i < count; ++i) {
+      uint32_t& x = lanes[i % SampleConversion::DitherState::kLanes];
+      float a = static_cast<float>(nextRandom(x) >> 8);
+      float b = static_cast<float>(nextRandom(x) >> 8);
+      samples[i] += (a - b) * scale;
+    }
+  }
+
+  void floatToInt16Scalar(const float* src, uint8_t* dest, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      long value = std::lrint(clampUnit(src[i]) * kInt16Scale);
+      int16_t sample = static_cast<int16_t>(value > 32767 ? 32767 : value);
+      std::memcpy(dest + i * 2, &sample, 2);
+    }
+  }
+
+  void floatToInt24Scalar(const float* src, uint8_t* dest, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      long value = std::lrint(clampUnit(src[i]) * kInt24Scale);
+      uint32_t bits = static_cast<uint32_t>(value > 8388607 ? 8388607 : value);
+      uint8_t* p = dest + i * 3;
+      p[0] = static_cast<uint8_t>(bits);
+      p[1] = static_cast<uint8_t>(bits >> 8);
+      p[2] = static_cast<uint8_t>(bits >> 16);
+    }
+  }
+
+  void floatToInt32Scalar(const float* src, uint8_t* dest, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      int32_t sample = static_cast<int32_t>(std::lrint(clampUnit(src[i], kInt32MaxInput) * kInt32Scale));
+      std::memcpy(dest + i * 4, &sample, 4);
+    }
+  }
+
+#ifdef AUDIO_SIMD_X86
+
+  // SSE2 kernels
+
+  AUDIO_TARGET_SSE2 void int16ToFloatSSE2(const uint8_t* src, float* dest, size_t count) {
+    const __m128 scale = _mm_set1_ps(1.0f / kInt16Scale);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+      __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+      // Sign-extend by placing each sample in the top half and shifting back
+      __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(raw, raw), 16);
+      __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(raw, raw), 16);
+      _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+      _mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+
+    int16ToFloatScalar(src + i * 2, dest + i, count - i);
+  }
+
+  AUDIO_TARGET_SSE2 void int24ToFloatSSE2(const uint8_t* src, float* dest, size_t count) {
+    // Without byte shuffles, gather each sample with an unaligned 32-bit
+    // load, then shift it to the top of the lane and back to sign-extend
+    const __m128 scale = _mm_set1_ps(1.0f / kInt24Scale);
+    size_t i = 0;
+
+    // The last load reads one byte past the fourth sample
+    for (; i + 5 <= count; i += 4) {
+      const uint8_t* p = src + i * 3;
+      int32_t a, b, c, d;
+      std::memcpy(&a, p, 4);
+      std::memcpy(&b, p + 3, 4);
+      std::memcpy(&c, p + 6, 4);
+      std::memcpy(&d, p + 9, 4);
+      __m128i value = _mm_srai_epi32(_mm_slli_epi32(_mm_set_epi32(d, c, b, a), 8), 8);
+      _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(value), scale));
+    }
+
+    int24ToFloatScalar(src + i * 3, dest + i, count - i);
+  }
+
+  AUDIO_TARGET_SSE2 void int32ToFloatSSE2(const uint8_t* src, float* dest, size_t count) {
+    const __m128 scale = _mm_set1_ps(1.0f / kInt32Scale);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+      __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+      _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(raw), scale));
+    }
+
+    int32ToFloatScalar(src + i * 4, dest + i, count - i);
+  }
+
+  AUDIO_TARGET_SSE2 void floatToInt16SSE2(const float* src, uint8_t* dest, size_t count) {
+    const __m128 lower = _mm_set1_ps(-1.0f);
+    const __m128 upper = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(kInt16Scale);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+      __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lower), upper);
+      __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), lower), upper);
+      // Saturating pack turns +32768 (full-scale positive) into 32767
+      __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)),
+                                       _mm_cvtps_epi32(_mm_mul_ps(b, scale)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 2), packed);
+    }
+
+    floatToInt16Scalar(src + i, dest + i * 2, count - i);
+  }
+
+  AUDIO_TARGET_SSE2 void floatToInt32SSE2(const float* src, uint8_t* dest, size_t count) {
+    const __m128 lower = _mm_set1_ps(-1.0f);
+    const __m128 upper = _mm_set1_ps(kInt32MaxInput);
+    const __m128 scale = _mm_set1_ps(kInt32Scale);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+      __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lower), upper);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 4), _mm_cvtps_epi32(_mm_mul_ps(x, scale)));
+    }
+
+    floatToInt32Scalar(src + i, dest + i * 4, count - i);
+  }
+
+  AUDIO_TARGET_SSE2 inline __m128i nextRandomSSE2(__m128i& x) {
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+    return _mm_srli_epi32(x, 8);
+  }
+
+  // Lanes 0-3 and 4-7 as two vectors, eight samples per step
+  AUDIO_TARGET_SSE2 void ditherSSE2(float* samples, size_t count, float lsb, uint32_t* lanes) {
+    const __m128 scale = _mm_set1_ps(kRandomUnit * lsb);
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes + 4));
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+      __m128 a = _mm_cvtepi32_ps(nextRandomSSE2(lo));
+      __m128 b = _mm_cvtepi32_ps(nextRandomSSE2(lo));
+      __m128 c = _mm_cvtepi32_ps(nextRandomSSE2(hi));
+      __m128 d = _mm_cvtepi32_ps(nextRandomSSE2(hi));
+      _mm_storeu_ps(samples + i, _mm_add_ps(_mm_loadu_ps(samples + i), _mm_mul_ps(_mm_sub_ps(a, b), scale)));
+      _mm_storeu_ps(samples + i + 4, _mm_add_ps(_mm_loadu_ps(samples + i + 4), _mm_mul_ps(_mm_sub_ps(c, d), scale)));
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes + 4), hi);
+    ditherScalar(samples + i, count - i, lsb, lanes);
+  }
+
+  // AVX2 kernels
+
+  AUDIO_TARGET_AVX2 void int16ToFloatAVX2(const uint8_t* src, float* dest, size_t count) {
+    const __m256 scale = _mm256_set1_ps(1.0f / kInt16Scale);
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+      __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+      __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2 + 16));
+      _mm256_storeu_ps(dest + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a)), scale));
+      _mm256_storeu_ps(dest + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b)), scale));
+    }
+
+    int16ToFloatScalar(src + i * 2, dest + i, count - i);
+  }
+
+  AUDIO_TARGET_AVX2 void int24ToFloatAVX2(const uint8_t* src, float* dest, size_t count) {
+    // Move each 3-byte sample into the top of a 32-bit lane, then shift
+    // back arithmetically to sign-extend
+    const __m256i spread = _mm256_setr_epi8(
+      -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+      -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m256 scale = _mm256_set1_ps(1.0f / kInt24Scale);
+    size_t i = 0;
+
+    // Each step reads 28 bytes for 24 bytes of samples
+    for (; i + 10 <= count; i += 8) {
+      const uint8_t* p = src + i * 3;
+      __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 12));
+      __m256i raw = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+      __m256i value = _mm256_srai_epi32(_mm256_shuffle_epi8(raw, spread), 8);
+      _mm256_storeu_ps(dest + i, _mm256_mul_ps(_mm256_cvtepi32_ps(value), scale));
+    }
+
+    int24ToFloatScalar(src + i * 3, dest + i, count - i);
+  }
+
+  AUDIO_TARGET_AVX2 void int32ToFloatAVX2(const uint8_t* src, float* dest, size_t count) {
+    const __m256 scale = _mm256_set1_ps(1.0f / kInt32Scale);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+      __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+      _mm256_storeu_ps(dest + i, _mm256_mul_ps(_mm256_cvtepi32_ps(raw), scale));
+    }
+
+    int32ToFloatScalar(src + i * 4, dest + i, count - i);
+  }
+
+  AUDIO_TARGET_AVX2 void floatToInt16AVX2(const float* src, uint8_t* dest, size_t count) {
+    const __m256 lower = _mm256_set1_ps(-1.0f);
+    const __m256 upper = _mm256_set1_ps(1.0f);
+    const __m256 scale = _mm256_set1_ps(kInt16Scale);
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+      __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i), lower), upper);
+      __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i + 8), lower), upper);
+      __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(a, scale)),
+                                          _mm256_cvtps_epi32(_mm256_mul_ps(b, scale)));
+      // Pack works per 128-bit lane; restore sample order across lanes
+      packed = _mm256_permute4x64_epi64(packed, 0xD8);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 2), packed);
+    }
+
+    floatToInt16Scalar(src + i, dest + i * 2, count - i);
+  }
+
+  AUDIO_TARGET_AVX2 void floatToInt24AVX2(const float* src, uint8_t* dest, size_t count) {
+    const __m256 lower = _mm256_set1_ps(-1.0f);
+    const __m256 upper = _mm256_set1_ps(1.0f);
+    const __m256 scale = _mm256_set1_ps(kInt24Scale);
+    const __m256i maxValue = _mm256_set1_epi32(8388607);
+    const __m256i pack = _mm256_setr_epi8(
+      0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+      0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    size_t i = 0;
+
+    // Each step stores 28 bytes for 24 bytes of samples; the upper lane's
+    // store overwrites the lower lane's 4 padding bytes
+    for (; i + 10 <= count; i += 8) {
+      __m256 x = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i), lower), upper);
+      __m256i value = _mm256_min_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(x, scale)), maxValue);
+      __m256i packed = _mm256_shuffle_epi8(value, pack);
+      uint8_t* p = dest + i * 3;
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(packed));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(p + 12), _mm256_extracti128_si256(packed, 1));
+    }
+
+    floatToInt24Scalar(src + i, dest + i * 3, count - i);
+  }
+
+  AUDIO_TARGET_AVX2 void floatToInt32AVX2(const float* src, uint8_t* dest, size_t count) {
+    const __m256 lower = _mm256_set1_ps(-1.0f);
+    const __m256 upper = _mm256_set1_ps(kInt32MaxInput);
+    const __m256 scale = _mm256_set1_ps(kInt32Scale);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+      __m256 x = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i), lower), upper);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 4), _mm256_cvtps_epi32(_mm256_mul_ps(x, scale)));
+    }
+
+    floatToInt32Scalar(src + i, dest + i * 4, count - i);
+  }
+
+  AUDIO_TARGET_AVX2 inline __m256i nextRandomAVX2(__m256i& x) {
+    x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+    x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+    return _mm256_srli_epi32(x, 8);
+  }
+
+  AUDIO_TARGET_AVX2 void ditherAVX2(float* samples, size_t count, float lsb, uint32_t* lanes) {
+    const __m256 scale = _mm256_set1_ps(kRandomUnit * lsb);
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes));
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+      __m256 a = _mm256_cvtepi32_ps(nextRandomAVX2(x));
+      __m256 b = _mm256_cvtepi32_ps(nextRandomAVX2(x));
+      __m256 noise = _mm256_mul_ps(_mm256_sub_ps(a, b), scale);
+      _mm256_storeu_ps(samples + i, _mm256_add_ps(_mm256_loadu_ps(samples + i), noise));
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), x);
+    ditherScalar(samples + i, count - i, lsb, lanes);
+  }
+
+#endif
+}
+
+SampleConversion::DitherState::DitherState(uint32_t seed) {
+  // Spread the seed so neighbouring lanes start far apart; xorshift must
+  // never hold zero
+  for (size_t lane = 0; lane < kLanes; ++lane) {
+    uint32_t x = seed + static_cast<uint32_t>(lane) * 0x9E3779B9u;
+    x = (x ^ (x >> 16)) * 0x85EBCA6Bu;
+    x = (x ^ (x >> 13)) * 0xC2B2AE35u;
+    x ^= x >> 16;
+    lanes[lane] = x ? x : 1;
+  }
+}
+
+size_t SampleConversion::getBytesPerSample(SampleFormat format) {
+  switch (format) {
+    case SampleFormat::Int16: return 2;
+    case SampleFormat::Int24: return 3;
+    case SampleFormat::Int32: return 4;
+    case SampleFormat::Float32: return 4;
+  }
+  return 0;
+}
+
+const char* SampleConversion::getFormatName(SampleFormat format) {
+  switch (format) {
+    case SampleFormat::Int16: return "PCM16";
+    case SampleFormat::Int24: return "PCM24";
+    case SampleFormat::Int32: return "PCM32";
+    case SampleFormat::Float32: return "Float32";
+  }
+  return "Unknown";
+}
+
+void SampleConversion::toFloat(SampleFormat format, const void* src, float* dest, size_t count) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(src);
+
+#ifdef AUDIO_SIMD_X86
+  SimdLevel level = CpuFeatures::getActiveLevel();
+#endif
+
+  switch (format) {
+    case SampleFormat::Int16:
+#ifdef AUDIO_SIMD_X86
+      if (level == SimdLevel::AVX2) return int16ToFloatAVX2(bytes, dest, count);
+      if (level == SimdLevel::SSE2) return int16ToFloatSSE2(bytes, dest, count);
+#endif
+      return int16ToFloatScalar(bytes, dest, count);
+
+    case SampleFormat::Int24:
+#ifdef AUDIO_SIMD_X86
+      if (level == SimdLevel::AVX2) return int24ToFloatAVX2(bytes, dest, count);
+      if (level == SimdLevel::SSE2) return int24ToFloatSSE2(bytes, dest, count);
+#endif
+      return int24ToFloatScalar(bytes, dest, count);
+
+    case SampleFormat::Int32:
+#ifdef AUDIO_SIMD_X86
+      if (level == SimdLevel::AVX2) return int32ToFloatAVX2(bytes, dest, count);
+      if (level == SimdLevel::SSE2) return int32ToFloatSSE2(bytes, dest, count);
+#endif
+      return int32ToFloatScalar(bytes, dest, count);
+
+    case SampleFormat::Float32:
+      std::memcpy(dest, bytes, count * sizeof(float));
+      return;
+  }
+}
+
+void SampleConversion::fromFloat(SampleFormat format, const float* src, void* dest, size_t count) {
+  uint8_t* bytes = static_cast<uint8_t*>(dest);
+
+#ifdef AUDIO_SIMD_X86
+  SimdLevel level = CpuFeatures::getActiveLevel();
+#endif
+
+  switch (format) {
+    case SampleFormat::Int16:
+#ifdef AUDIO_SIMD_X86
+      if (level == SimdLevel::AVX2) return floatToInt16AVX2(src, bytes, count);
+      if (level == SimdLevel::SSE2) return floatToInt16SSE2(src, bytes, count);
+#endif
+      return floatToInt16Scalar(src, bytes, count);
+
+    case SampleFormat::Int24:
+#ifdef AUDIO_SIMD_X86
+      if (level == SimdLevel::AVX2) return floatToInt24AVX2(src, bytes, count);
+#endif
+      return floatToInt24Scalar(src, bytes, count);
+
+    case SampleFormat::Int32:
+#ifdef AUDIO_SIMD_X86
+      if (level == SimdLevel::AVX2) return floatToInt32AVX2(src, bytes, count);
+      if (level == SimdLevel::SSE2) return floatToInt32SSE2(src, bytes, count);
+#endif
+      return floatToInt32Scalar(src, bytes, count);
+
+    case SampleFormat::Float32:
+      std::memcpy(bytes, src, count * sizeof(float));
+      return;
+  }
+}
+
+void SampleConversion::addDither(SampleFormat format, float* samples, size_t count, DitherState& state) {
+  float lsb;
+
+  switch (format) {
+    case SampleFormat::Int16: lsb = 1.0f / kInt16Scale; break;
+    case SampleFormat::Int24: lsb = 1.0f / kInt24Scale; break;
+    default: return;
+  }
+
+#ifdef AUDIO_SIMD_X86
+  SimdLevel level = CpuFeatures::getActiveLevel();
+
+  if (level == SimdLevel::AVX2) return ditherAVX2(samples, count, lsb, state.lanes);
+  if (level == SimdLevel::SSE2) return ditherSSE2(samples, count, lsb, state.lanes);
+#endif
+  ditherScalar(samples, count, lsb, state.lanes);
+}
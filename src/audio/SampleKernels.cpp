@@ -0,0 +1,375 @@
+#include "audio/SampleKernels.h"
+#include "audio/CpuFeatures.h"
+#include "audio/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef AUDIO_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+  // Scalar kernels (also used for the tails of the SIMD kernels)
+
+  float peakScalar(const float* samples, size_t count) {
+    float peak = 0.0f;
+
+    for (size_t i = 0; i < count; ++i) {
+      peak = std::max(peak, std::abs(samples[i]));
+    }
+    return peak;
+  }
+
+  double sumSquaresScalar(const float* samples, size_t count) {
+    double sum = 0.0;
+
+    for (size_t i = 0; i < count; ++i) {
+      double sample = samples[i];
+      sum += sample * sample;
+    }
+    return sum;
+  }
+
+  // `first` is the index of samples[0] within the frame-aligned input, so
+  // tails land on the right channel
+  void sumChannelsScalar(const float* samples, size_t count, size_t channels, size_t first, double* sums) {
+    for (size_t i = 0; i < count; ++i) {
+      sums[(first + i) % channels] += samples[i];
+    }
+  }
+
+  void applyGainScalar(float* samples, size_t count, float gain) {
+    for (size_t i = 0; i < count; ++i) {
+      samples[i] *= gain;
+    }
+  }
+
+  void mixScalar(float* dest, const float* src, size_t count, float destLevel, float srcLevel) {
+    for (size_t i = 0; i < count; ++i) {
+      dest[i] = dest[i] * destLevel + src[i] * srcLevel;
+    }
+  }
+
+#ifdef AUDIO_SIMD_X86
+
+  // SSE2 kernels
+
+  AUDIO_TARGET_SSE2 float peakSSE2(const float* samples, size_t count) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 a = _mm_setzero_ps();
+    __m128 b = _mm_setzero_ps();
+    size_t i = 0;
+
+    // The running peak is the second operand, so NaN inputs are dropped
+    for (; i + 8 <= count; i += 8) {
+      a = _mm_max_ps(_mm_and_ps(_mm_loadu_ps(samples + i), absMask), a);
+      b = _mm_max_ps(_mm_and_ps(_mm_loadu_ps(samples + i + 4), absMask), b);
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_max_ps(a, b));
+
+    float peak = peakScalar(samples + i, count - i);
+    return std::max(peak, peakScalar(lanes, 4));
+  }
+
+  AUDIO_TARGET_SSE2 double sumSquaresSSE2(const float* samples, size_t count) {
+    __m128d a = _mm_setzero_pd();
+    __m128d b = _mm_setzero_pd();
+    size_t i = 0;
+
+    // Squares of floats are exact in double
+    for (; i + 4 <= count; i += 4) {
+      __m128 x = _mm_loadu_ps(samples + i);
+      __m128d lo = _mm_cvtps_pd(x);
+      __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(x, x));
+      a = _mm_add_pd(a, _mm_mul_pd(lo, lo));
+      b = _mm_add_pd(b, _mm_mul_pd(hi, hi));
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(a, b));
+    return lanes[0] + lanes[1] + sumSquaresScalar(samples + i, count - i);
+  }
+
+  // Lane k of the double accumulators always holds channel k % channels, so
+  // this only handles channel counts that divide the lane count
+  AUDIO_TARGET_SSE2 void sumChannelsSSE2(const float* samples, size_t count, size_t channels, double* sums) {
+    __m128d a = _mm_setzero_pd();
+    __m128d b = _mm_setzero_pd();
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+      __m128 x = _mm_loadu_ps(samples + i);
+      a = _mm_add_pd(a, _mm_cvtps_pd(x));
+      b = _mm_add_pd(b, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(a, b));
+
+    for (size_t lane = 0; lane < 2; ++lane) {
+      sums[lane % channels] += lanes[lane];
+    }
+    sumChannelsScalar(samples + i, count - i, channels, i, sums);
+  }
+
+  AUDIO_TARGET_SSE2 void applyGainSSE2(float* samples, size_t count, float gain) {
+    const __m128 scale = _mm_set1_ps(gain);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+      _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), scale));
+    }
+
+    applyGainScalar(samples + i, count - i, gain);
+  }
+
+  AUDIO_TARGET_SSE2 void mixSSE2(float* dest, const float* src, size_t count, float destLevel, float srcLevel) {
+    const __m128 destScale = _mm_set1_ps(destLevel);
+    const __m128 srcScale = _mm_set1_ps(srcLevel);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+      __m128 x = _mm_mul_ps(_mm_loadu_ps(dest + i), destScale);
+      __m128 y = _mm_mul_ps(_mm_loadu_ps(src + i), srcScale);
+      _mm_storeu_ps(dest + i, _mm_add_ps(x, y));
+    }
+
+    mixScalar(dest + i, src + i, count - i, destLevel, srcLevel);
+  }
+
+  // AVX2 kernels
+
+  AUDIO_TARGET_AVX2 float peakAVX2(const float* samples, size_t count) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 a = _mm256_setzero_ps();
+    __m256 b = _mm256_setzero_ps();
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+      a = _mm256_max_ps(_mm256_and_ps(_mm256_loadu_ps(samples + i), absMask), a);
+      b = _mm256_max_ps(_mm256_and_ps(_mm256_loadu_ps(samples + i + 8), absMask), b);
+    }
+
+    float lanes[8];
+    _mm256_storeu_ps(lanes, _mm256_max_ps(a, b));
+
+    float peak = peakScalar(samples + i, count - i);
+    return std::max(peak, peakScalar(lanes, 8));
+  }
+
+  AUDIO_TARGET_AVX2 double sumSquaresAVX2(const float* samples, size_t count) {
+    __m256d a = _mm256_setzero_pd();
+    __m256d b = _mm256_setzero_pd();
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+      __m256 x = _mm256_loadu_ps(samples + i);
+      __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(x));
+      __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1));
+      a = _mm256_add_pd(a, _mm256_mul_pd(lo, lo));
+      b = _mm256_add_pd(b, _mm256_mul_pd(hi, hi));
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(a, b));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + sumSquaresScalar(samples + i, count - i);
+  }
+
+  AUDIO_TARGET_AVX2 void sumChannelsAVX2(const float* samples, size_t count, size_t channels, double* sums) {
+    __m256d a = _mm256_setzero_pd();
+    __m256d b = _mm256_setzero_pd();
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+      __m256 x = _mm256_loadu_ps(samples + i);
+      a = _mm256_add_pd(a, _mm256_cvtps_pd(_mm256_castps256_ps128(x)));
+      b = _mm256_add_pd(b, _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)));
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(a, b));
+
+    for (size_t lane = 0; lane < 4; ++lane) {
+      sums[lane % channels] += lanes[lane];
+    }
+    sumChannelsScalar(samples + i, count - i, channels, i, sums);
+  }
+
+  AUDIO_TARGET_AVX2 void applyGainAVX2(float* samples, size_t count, float gain) {
+    const __m256 scale = _mm256_set1_ps(gain);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+      _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), scale));
+    }
+
+    applyGainScalar(samples + i, count - i, gain);
+  }
+
+  AUDIO_TARGET_AVX2 void mixAVX2(float* dest, const float* src, size_t count, float destLevel, float srcLevel) {
+    const __m256 destScale = _mm256_set1_ps(destLevel);
+    const __m256 srcScale = _mm256_set1_ps(srcLevel);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+      __m256 x = _mm256_mul_ps(_mm256_loadu_ps(dest + i), destScale);
+      __m256 y = _mm256_mul_ps(_mm256_loadu_ps(src + i), srcScale);
+      _mm256_storeu_ps(dest + i, _mm256_add_ps(x, y));
+    }
+
+    mixScalar(dest + i, src + i, count - i, destLevel, srcLevel);
+  }
+
+#endif
+
+  // Single-threaded dispatch
+
+  float peakSerial(const float* samples, size_t count) {
+#ifdef AUDIO_SIMD_X86
+    SimdLevel level = CpuFeatures::getActiveLevel();
+    if (level == SimdLevel::AVX2) return peakAVX2(samples, count);
+    if (level == SimdLevel::SSE2) return peakSSE2(samples, count);
+#endif
+    return peakScalar(samples, count);
+  }
+
+  double sumSquaresSerial(const float* samples, size_t count) {
+#ifdef AUDIO_SIMD_X86
+    SimdLevel level = CpuFeatures::getActiveLevel();
+    if (level == SimdLevel::AVX2) return sumSquaresAVX2(samples, count);
+    if (level == SimdLevel::SSE2) return sumSquaresSSE2(samples, count);
+#endif
+    return sumSquaresScalar(samples, count);
+  }
+
+  void sumChannelsSerial(const float* samples, size_t count, size_t channels, double* sums) {
+#ifdef AUDIO_SIMD_X86
+    SimdLevel level = CpuFeatures::getActiveLevel();
+    if (level == SimdLevel::AVX2 && 4 % channels == 0) return sumChannelsAVX2(samples, count, channels, sums);
+    if (level >= SimdLevel::SSE2 && 2 % channels == 0) return sumChannelsSSE2(samples, count, channels, sums);
+#endif
+    sumChannelsScalar(samples, count, channels, 0, sums);
+  }
+
+  void applyGainSerial(float* samples, size_t count, float gain) {
+#ifdef AUDIO_SIMD_X86
+    SimdLevel level = CpuFeatures::getActiveLevel();
+    if (level == SimdLevel::AVX2) return applyGainAVX2(samples, count, gain);
+    if (level == SimdLevel::SSE2) return applyGainSSE2(samples, count, gain);
+#endif
+    applyGainScalar(samples, count, gain);
+  }
+
+  void mixSerial(float* dest, const float* src, size_t count, float destLevel, float srcLevel) {
+#ifdef AUDIO_SIMD_X86
+    SimdLevel level = CpuFeatures::getActiveLevel();
+    if (level == SimdLevel::AVX2) return mixAVX2(dest, src, count, destLevel, srcLevel);
+    if (level == SimdLevel::SSE2) return mixSSE2(dest, src, count, destLevel, srcLevel);
+#endif
+    mixScalar(dest, src, count, destLevel, srcLevel);
+  }
+
+  // Number of chunks to split `count` samples into: one per worker plus the
+  // calling thread, or a single chunk for small inputs
+  size_t getChunkCount(ThreadPool* pool, size_t count) {
+    if (!pool || pool->getThreadCount() == 0 || count < SampleKernels::kParallelThreshold) return 1;
+    return pool->getThreadCount() + 1;
+  }
+
+  // Chunk starts stay on cache-line boundaries relative to the input
+  const size_t kChunkAlignSamples = 16;
+
+  // Calls fn(chunk, start, length) for consecutive chunks of [0, count)
+  // whose starts are multiples of `granularity`
+  template <typename Function>
+  void forEachChunk(ThreadPool* pool, size_t chunks, size_t count, size_t granularity, Function fn) {
+    size_t chunkSize = ((count + chunks - 1) / chunks + granularity - 1) / granularity * granularity;
+
+    auto task = [&](size_t chunk) {
+      size_t start = chunk * chunkSize;
+
+      if (start < count) {
+        fn(chunk, start, std::min(chunkSize, count - start));
+      }
+    };
+
+    if (chunks == 1) {
+      task(0);
+      return;
+    }
+    pool->parallelFor(chunks, task);
+  }
+}
+
+float SampleKernels::peak(const float* samples, size_t count, ThreadPool* pool) {
+  size_t chunks = getChunkCount(pool, count);
+
+  if (chunks == 1) return peakSerial(samples, count);
+
+  std::vector<float> partial(chunks, 0.0f);
+
+  forEachChunk(pool, chunks, count, kChunkAlignSamples, [&](size_t chunk, size_t start, size_t length) {
+    partial[chunk] = peakSerial(samples + start, length);
+  });
+
+  return *std::max_element(partial.begin(), partial.end());
+}
+
+double SampleKernels::sumSquares(const float* samples, size_t count, ThreadPool* pool) {
+  size_t chunks = getChunkCount(pool, count);
+
+  if (chunks == 1) return sumSquaresSerial(samples, count);
+
+  std::vector<double> partial(chunks, 0.0);
+
+  forEachChunk(pool, chunks, count, kChunkAlignSamples, [&](size_t chunk, size_t start, size_t length) {
+    partial[chunk] = sumSquaresSerial(samples + start, length);
+  });
+
+  double sum = 0.0;
+
+  for (double value : partial) {
+    sum += value;
+  }
+  return sum;
+}
+
+void SampleKernels::sumChannels(const float* samples, size_t frames, size_t channels, double* sums, ThreadPool* pool) {
+  if (channels == 0) return;
+
+  size_t count = frames * channels;
+  size_t chunks = getChunkCount(pool, count);
+
+  if (chunks == 1) {
+    sumChannelsSerial(samples, count, channels, sums);
+    return;
+  }
+
+  // Chunks start on frame boundaries so every chunk sees channel 0 first
+  std::vector<double> partial(chunks * channels, 0.0);
+
+  forEachChunk(pool, chunks, count, channels * kChunkAlignSamples, [&](size_t chunk, size_t start, size_t length) {
+    sumChannelsSerial(samples + start, length, channels, partial.data() + chunk * channels);
+  });
+
+  for (size_t chunk = 0; chunk < chunks; ++chunk) {
+    for (size_t channel = 0; channel < channels; ++channel) {
+      sums[channel] += partial[chunk * channels + channel];
+    }
+  }
+}
+
+void SampleKernels::applyGain(float* samples, size_t count, float gain, ThreadPool* pool) {
+  forEachChunk(pool, getChunkCount(pool, count), count, kChunkAlignSamples, [&](size_t, size_t start, size_t length) {
+    applyGainSerial(samples + start, length, gain);
+  });
+}
+
+void SampleKernels::mix(float* dest, const float* src, size_t count, float destLevel, float srcLevel, ThreadPool* pool) {
+  forEachChunk(pool, getChunkCount(pool, count), count, kChunkAlignSamples, [&](size_t, size_t start, size_t length) {
+    mixSerial(dest + start, src + start, length, destLevel, srcLevel);
+  });
+}
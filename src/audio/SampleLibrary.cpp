@@ -0,0 +1,343 @@
+#include "audio/SampleLibrary.h"
+#include "audio/AudioFileLoader.h"
+#include "audio/ThreadPool.h"
+#include "audio/WavIndexCache.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+
+namespace fs = std::filesystem;
+
+namespace {
+  const char kMagic[4] = { 'S', 'L', 'I', 'B' };
+
+  // Bytes of an entry besides its path
+  const size_t kEntryFixedBytes = 2 + 2 + 8 + 8 + 4 + 2 + 1 + 8 + 4 + 4;
+
+  // Paths are front-coded against the previous one with 16-bit lengths
+  const size_t kMaxPathBytes = 0xFFFF;
+
+  struct FoundFile {
+    std::string path;
+    uint64_t fileSize;
+    int64_t modifiedTime;
+  };
+
+  bool isCancelled(const std::atomic<bool>* cancel) {
+    return cancel && cancel->load(std::memory_order_relaxed);
+  }
+
+  bool isWavFile(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".wav";
+  }
+
+  void addFile(const fs::directory_entry& entry, std::vector<FoundFile>& files) {
+    std::error_code error;
+
+    if (!entry.is_regular_file(error) || !isWavFile(entry.path())) return;
+
+    uint64_t fileSize = entry.file_size(error);
+    if (error) return;
+
+    auto modifiedTime = entry.last_write_time(error);
+    if (error) return;
+
+    files.push_back({ entry.path().string(), fileSize, static_cast<int64_t>(modifiedTime.time_since_epoch().count()) });
+  }
+
+  void walkDirectory(const fs::path& directory, std::vector<FoundFile>& files, const std::atomic<bool>* cancel) {
+    std::error_code error;
+
+    for (fs::recursive_directory_iterator it(directory, fs::directory_options::skip_permission_denied, error), end;
+         !error && it != end && !isCancelled(cancel); it.increment(error)) {
+      addFile(*it, files);
+    }
+  }
+
+  void analyze(SampleLibrary::Entry& entry, const std::shared_ptr<WavIndexCache>& indexCache) {
+    // Mapped, so the samples are read once, by the levels pass; the header
+    // parsed for the info is reused by the load through the cache
+    AudioFileLoader loader;
+    loader.setVerbose(false);
+    loader.setLoadMode(AudioFileLoader::LoadMode::Mapped);
+    loader.setIndexCache(indexCache);
+
+    WavInfo info;
+    AudioBuffer buffer;
+
+    if (!loader.getWavInfo(entry.path, info) || !loader.loadWavFile(entry.path, buffer)) {
+      entry.channels = 0;
+      return;
+    }
+
+    entry.sampleRate = info.sampleRate;
+    entry.channels = info.channels;
+    entry.sampleFormat = info.sampleFormat;
+    entry.frameCount = info.frameCount;
+    buffer.getLevels(entry.peak, entry.rms);
+  }
+
+  template <typename T>
+  void appendValue(std::vector<char>& bytes, T value) {
+    const char* p = reinterpret_cast<const char*>(&value);
+    bytes.insert(bytes.end(), p, p + sizeof(T));
+  }
+
+  // Bounds-checked reads from an index held in memory
+  class IndexReader {
+  public:
+    explicit IndexReader(const std::vector<char>& bytes) : bytes_(bytes), position_(0) {}
+
+    template <typename T>
+    bool read(T& value) {
+      return readBytes(&value, sizeof(T));
+    }
+
+    bool readBytes(void* dest, size_t count) {
+      if (count > bytes_.size() - position_) return false;
+
+      std::memcpy(dest, bytes_.data() + position_, count);
+      position_ += count;
+      return true;
+    }
+
+    size_t remaining() const { return bytes_.size() - position_; }
+
+  private:
+    const std::vector<char>& bytes_;
+    size_t position_;
+  };
+}
+
+std::string SampleLibrary::getIndexPath(const std::string& root) {
+  return (fs::path(root) / ".sample_library").string();
+}
+
+SampleLibrary::ScanStats SampleLibrary::scan(const std::vector<std::string>& roots, ThreadPool* pool,
+                                             const std::atomic<bool>* cancel) {
+  auto start = std::chrono::steady_clock::now();
+  ScanStats stats;
+
+  ThreadPool callingThreadOnly(0);
+  ThreadPool& workers = pool ? *pool : callingThreadOnly;
+
+  // The top level of each root is listed here; every directory found there
+  // is then walked as its own task
+  std::vector<FoundFile> files;
+  std::vector<fs::path> directories;
+  std::error_code error;
+
+  for (const std::string& root : roots) {
+    fs::directory_entry rootEntry(root, error);
+
+    if (error || !rootEntry.is_directory(error)) {
+      if (!error) addFile(rootEntry, files);
+      continue;
+    }
+
+    for (fs::directory_iterator it(root, fs::directory_options::skip_permission_denied, error), end;
+         !error && it != end; it.increment(error)) {
+      std::error_code typeError;
+
+      if (it->is_directory(typeError)) {
+        directories.push_back(it->path());
+      }
+      else {
+        addFile(*it, files);
+      }
+    }
+  }
+
+  std::vector<std::vector<FoundFile>> found(directories.size());
+
+  workers.parallelFor(directories.size(), [&](size_t index) {
+    walkDirectory(directories[index], found[index], cancel);
+  });
+
+  for (std::vector<FoundFile>& subtree : found) {
+    std::move(subtree.begin(), subtree.end(), std::back_inserter(files));
+  }
+
+  std::sort(files.begin(), files.end(), [](const FoundFile& a, const FoundFile& b) { return a.path < b.path; });
+  files.erase(std::unique(files.begin(), files.end(), [](const FoundFile& a, const FoundFile& b) { return a.path == b.path; }),
+              files.end());
+
+  // Files whose size and modification time match the catalogue keep their
+  // entry; only the rest are read
+  std::vector<Entry> entries(files.size());
+  std::vector<size_t> pending;
+  size_t kept = 0;
+
+  for (size_t i = 0; i < files.size(); ++i) {
+    size_t previous = find(files[i].path);
+
+    if (previous < entries_.size()) {
+      ++kept;
+
+      if (entries_[previous].fileSize == files[i].fileSize && entries_[previous].modifiedTime == files[i].modifiedTime) {
+        entries[i] = entries_[previous];
+        ++stats.unchanged;
+        continue;
+      }
+    }
+
+    entries[i].path = files[i].path;
+    entries[i].fileSize = files[i].fileSize;
+    entries[i].modifiedTime = files[i].modifiedTime;
+    pending.push_back(i);
+  }
+
+  auto indexCache = std::make_shared<WavIndexCache>();
+
+  workers.parallelFor(pending.size(), [&](size_t index) {
+    if (!isCancelled(cancel)) {
+      analyze(entries[pending[index]], indexCache);
+    }
+  });
+
+  if (isCancelled(cancel)) {
+    stats.cancelled = true;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+  }
+
+  stats.files = files.size();
+  stats.analyzed = pending.size();
+  stats.failed = std::count_if(pending.begin(), pending.end(), [&entries](size_t i) { return !entries[i].isReadable(); });
+  stats.removed = entries_.size() - kept;
+  entries_ = std::move(entries);
+
+  stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return stats;
+}
+
+size_t SampleLibrary::find(const std::string& path) const {
+  auto it = std::lower_bound(entries_.begin(), entries_.end(), path,
+                             [](const Entry& entry, const std::string& value) { return entry.path < value; });
+
+  return it != entries_.end() && it->path == path ? static_cast<size_t>(it - entries_.begin()) : entries_.size();
+}
+
+bool SampleLibrary::load(const std::string& indexFilename) {
+  entries_.clear();
+
+  // One read for the whole index; entries are then decoded from memory
+  std::ifstream file(indexFilename, std::ios::binary | std::ios::ate);
+
+  if (!file.is_open()) return false;
+
+  std::vector<char> bytes(static_cast<size_t>(file.tellg()));
+  file.seekg(0);
+
+  if (!file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()))) return false;
+
+  IndexReader reader(bytes);
+  char magic[4];
+  uint32_t version;
+  uint64_t count;
+
+  if (!reader.readBytes(magic, 4) || std::memcmp(magic, kMagic, 4) != 0 ||
+      !reader.read(version) || version != kIndexVersion || !reader.read(count) ||
+      count > reader.remaining() / kEntryFixedBytes) {
+    return false;
+  }
+
+  std::vector<Entry> entries(static_cast<size_t>(count));
+  std::string previous;
+
+  for (Entry& entry : entries) {
+    uint16_t shared, suffixLength;
+    uint8_t format;
+
+    if (!reader.read(shared) || !reader.read(suffixLength) || shared > previous.size()) return false;
+
+    entry.path.assign(previous, 0, shared);
+    entry.path.resize(shared + suffixLength);
+
+    if (!reader.readBytes(&entry.path[shared], suffixLength) ||
+        !reader.read(entry.fileSize) || !reader.read(entry.modifiedTime) ||
+        !reader.read(entry.sampleRate) || !reader.read(entry.channels) || !reader.read(format) ||
+        !reader.read(entry.frameCount) || !reader.read(entry.peak) || !reader.read(entry.rms) ||
+        format > static_cast<uint8_t>(SampleFormat::Float32) || entry.path <= previous) {
+      return false;
+    }
+
+    entry.sampleFormat = static_cast<SampleFormat>(format);
+    previous = entry.path;
+  }
+
+  entries_ = std::move(entries);
+  return true;
+}
+
+bool SampleLibrary::save(const std::string& indexFilename) const {
+  // Sorted paths share long directory prefixes, so each stores only the
+  // part that differs from the one before it
+  std::vector<char> bytes(kMagic, kMagic + 4);
+  appendValue<uint32_t>(bytes, kIndexVersion);
+  size_t countOffset = bytes.size();
+  appendValue<uint64_t>(bytes, 0);
+
+  uint64_t count = 0;
+  const std::string* previous = nullptr;
+
+  for (const Entry& entry : entries_) {
+    if (entry.path.size() > kMaxPathBytes) continue;
+
+    size_t shared = 0;
+
+    if (previous) {
+      size_t limit = std::min(previous->size(), entry.path.size());
+      while (shared < limit && (*previous)[shared] == entry.path[shared]) ++shared;
+    }
+
+    appendValue<uint16_t>(bytes, static_cast<uint16_t>(shared));
+    appendValue<uint16_t>(bytes, static_cast<uint16_t>(entry.path.size() - shared));
+    bytes.insert(bytes.end(), entry.path.begin() + shared, entry.path.end());
+    appendValue<uint64_t>(bytes, entry.fileSize);
+    appendValue<int64_t>(bytes, entry.modifiedTime);
+    appendValue<uint32_t>(bytes, entry.sampleRate);
+    appendValue<uint16_t>(bytes, entry.channels);
+    appendValue<uint8_t>(bytes, static_cast<uint8_t>(entry.sampleFormat));
+    appendValue<uint64_t>(bytes, entry.frameCount);
+    appendValue<float>(bytes, entry.peak);
+    appendValue<float>(bytes, entry.rms);
+
+    previous = &entry.path;
+    ++count;
+  }
+
+  std::memcpy(bytes.data() + countOffset, &count, sizeof(count));
+
+  std::string tempFilename = indexFilename + ".tmp";
+
+  {
+    std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open()) return false;
+
+    if (!file.write(bytes.data(), static_cast<std::streamsize>(bytes.size())) || !file.flush()) {
+      file.close();
+      std::remove(tempFilename.c_str());
+      return false;
+    }
+  }
+
+  std::error_code error;
+  fs::rename(tempFilename, indexFilename, error);
+
+  if (error) {
+    std::remove(tempFilename.c_str());
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,191 @@
+#include "audio/SmoothedParameter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  // Exponential ramps snap to the target once this close
+  const float kSettleThreshold = 1e-6f;
+}
+
+SmoothedParameter::SmoothedParameter(float initial, Ramp ramp, float rampSeconds)
+  : target_(initial), ramp_(ramp), rampSeconds_(std::max(0.0f, rampSeconds)),
+  rampFrames_(0), current_(initial), rampTarget_(initial), step_(0.0f),
+  stepsRemaining_(0), coefficient_(0.0f), position_(0) {}
+
+void SmoothedParameter::setTarget(float value) {
+  target_.store(value, std::memory_order_relaxed);
+}
+
+void SmoothedParameter::setRamp(Ramp ramp, float rampSeconds) {
+  ramp_ = ramp;
+  rampSeconds_ = std::max(0.0f, rampSeconds);
+}
+
+void SmoothedParameter::setAutomation(std::vector<Breakpoint> points) {
+  std::sort(points.begin(), points.end(), [](const Breakpoint& a, const Breakpoint& b) {
+    return a.frame < b.frame;
+  });
+
+  automation_ = std::move(points);
+}
+
+void SmoothedParameter::clearAutomation() {
+  automation_.clear();
+}
+
+void SmoothedParameter::prepare(size_t sampleRate, size_t maxBlockFrames) {
+  values_.assign(maxBlockFrames, 0.0f);
+  rampFrames_ = static_cast<size_t>(rampSeconds_ * sampleRate);
+
+  // exp(-4.6) ~= 0.01: within 1% of the target after rampFrames_
+  coefficient_ = rampFrames_ > 0 ? std::exp(-4.6f / rampFrames_) : 0.0f;
+
+  reset();
+}
+
+void SmoothedParameter::reset() {
+  current_ = rampTarget_ = target_.load(std::memory_order_relaxed);
+  stepsRemaining_ = 0;
+  position_ = 0;
+
+  if (!automation_.empty()) {
+    current_ = getAutomationValue(0);
+  }
+}
+
+bool SmoothedParameter::processBlock(size_t frames) {
+  // An empty block leaves everything as it was, including a pending target
+  if (frames == 0) return false;
+
+  // Not prepared for blocks this long: no room for per-frame values
+  if (frames > values_.size()) {
+    current_ = rampTarget_ = automation_.empty() ? target_.load(std::memory_order_relaxed)
+                                                 : getAutomationValue(position_ + frames);
+    stepsRemaining_ = 0;
+    position_ += frames;
+    return false;
+  }
+
+  bool varying = automation_.empty() ? processRamp(frames) : processAutomation(frames);
+
+  position_ += frames;
+  return varying;
+}
+
+bool SmoothedParameter::processRamp(size_t frames) {
+  float target = target_.load(std::memory_order_relaxed);
+
+  if (target != rampTarget_) {
+    rampTarget_ = target;
+
+    if (rampFrames_ == 0) {
+      current_ = target;
+      stepsRemaining_ = 0;
+    }
+    else {
+      stepsRemaining_ = rampFrames_;
+      step_ = (target - current_) / rampFrames_;
+    }
+  }
+
+  if (current_ == rampTarget_) {
+    stepsRemaining_ = 0;
+    return false;
+  }
+
+  float* values = values_.data();
+
+  if (ramp_ == Ramp::Linear) {
+    size_t rampPart = std::min(frames, stepsRemaining_);
+    const float start = current_;
+    const float step = step_;
+
+    for (size_t i = 0; i < rampPart; ++i) {
+      values[i] = start + step * static_cast<float>(i + 1);
+    }
+
+    std::fill(values + rampPart, values + frames, rampTarget_);
+
+    stepsRemaining_ -= rampPart;
+    current_ = stepsRemaining_ == 0 ? rampTarget_ : values[rampPart - 1];
+    return true;
+  }
+
+  float value = current_;
+
+  for (size_t i = 0; i < frames; ++i) {
+    value = rampTarget_ + (value - rampTarget_) * coefficient_;
+
+    if (std::abs(value - rampTarget_) < kSettleThreshold) {
+      value = rampTarget_;
+    }
+    values[i] = value;
+  }
+
+  current_ = value;
+  return true;
+}
+
+bool SmoothedParameter::processAutomation(size_t frames) {
+  const uint64_t start = position_;
+  const uint64_t end = position_ + frames;
+
+  // Entirely before the first or after the last point: one value
+  if (end <= automation_.front().frame + 1 || start >= automation_.back().frame) {
+    current_ = getAutomationValue(start);
+    return false;
+  }
+
+  float* values = values_.data();
+
+  auto next = std::upper_bound(automation_.begin(), automation_.end(), start,
+    [](uint64_t frame, const Breakpoint& point) { return frame < point.frame; });
+  size_t i = 0;
+
+  while (i < frames) {
+    uint64_t frame = start + i;
+
+    // First point after this frame; the segment ends there
+    while (next != automation_.end() && next->frame <= frame) {
+      ++next;
+    }
+
+    if (next == automation_.begin() || next == automation_.end()) {
+      // Holding before the first or after the last point
+      float value = next == automation_.begin() ? automation_.front().value : automation_.back().value;
+      uint64_t until = next == automation_.end() ? end : std::min(end, next->frame);
+
+      for (; start + i < until; ++i) {
+        values[i] = value;
+      }
+    }
+    else {
+      const Breakpoint& from = *(next - 1);
+      const Breakpoint& to = *next;
+      const float slope = (to.value - from.value) / static_cast<float>(to.frame - from.frame);
+      const float base = from.value + slope * static_cast<float>(frame - from.frame);
+      size_t count = static_cast<size_t>(std::min(end, to.frame) - frame);
+
+      for (size_t j = 0; j < count; ++j) {
+        values[i + j] = base + slope * static_cast<float>(j);
+      }
+      i += count;
+    }
+  }
+
+  current_ = values[frames - 1];
+  return true;
+}
+
+float SmoothedParameter::getAutomationValue(uint64_t frame) const {
+  if (frame <= automation_.front().frame) return automation_.front().value;
+  if (frame >= automation_.back().frame) return automation_.back().value;
+
+  auto next = std::upper_bound(automation_.begin(), automation_.end(), frame,
+    [](uint64_t value, const Breakpoint& point) { return value < point.frame; });
+  const Breakpoint& from = *(next - 1);
+  const Breakpoint& to = *next;
+
+  return from.value + (to.value - from.value) * static_cast<float>(frame - from.frame) /
+         static_cast<float>(to.frame - from.frame);
+}
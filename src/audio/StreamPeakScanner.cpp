@@ -0,0 +1,84 @@
+#include "audio/StreamPeakScanner.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+  // Frames per piece: whole coarsest pyramid buckets, so pieces line up at
+  // every level, and enough of them that the overview grows in visible steps
+  const size_t kPieceFrames = 4 * PeakPyramid::kBaseBucketFrames * PeakPyramid::kLevelRatio * PeakPyramid::kLevelRatio;
+
+  // How long the worker waits for the consumer to make room for a piece
+  const auto kQueueWait = std::chrono::milliseconds(5);
+}
+
+StreamPeakScanner::StreamPeakScanner()
+  : state_(State::Idle), cancelRequested_(false) {}
+
+StreamPeakScanner::~StreamPeakScanner() {
+  cancel();
+}
+
+bool StreamPeakScanner::start(const std::string& filename) {
+  WavStreamReader reader;
+
+  if (!reader.open(filename)) {
+    return false;
+  }
+
+  cancel();
+
+  reader_ = std::move(reader);
+  filename_ = filename;
+  cancelRequested_.store(false, std::memory_order_relaxed);
+  state_.store(State::Scanning, std::memory_order_release);
+
+  worker_ = std::thread(&StreamPeakScanner::run, this);
+  return true;
+}
+
+void StreamPeakScanner::cancel() {
+  cancelRequested_.store(true, std::memory_order_relaxed);
+
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+
+  // Pieces of a cancelled scan are of no use to the next one
+  Piece stale;
+  while (pieces_.tryPop(stale)) {}
+}
+
+void StreamPeakScanner::run() {
+  size_t frameCount = reader_.getFrameCount();
+  AudioBuffer chunk(reader_.getSampleRate(), reader_.getChannelCount());
+
+  for (size_t start = 0; start < frameCount; start += kPieceFrames) {
+    size_t frames = std::min(kPieceFrames, frameCount - start);
+    chunk.resize(frames);
+
+    if (reader_.readFrames(chunk.getData(), frames) != frames) {
+      std::cerr << "Failed to read all audio data: " << filename_ << std::endl;
+      state_.store(State::Failed, std::memory_order_release);
+      return;
+    }
+
+    Piece piece;
+    piece.startFrame = start;
+    piece.peaks.build(chunk);
+
+    // The consumer takes pieces once per UI update; wait for room rather
+    // than read further ahead
+    while (!pieces_.tryPush(std::move(piece))) {
+      if (cancelRequested_.load(std::memory_order_relaxed)) break;
+      std::this_thread::sleep_for(kQueueWait);
+    }
+
+    if (cancelRequested_.load(std::memory_order_relaxed)) {
+      state_.store(State::Cancelled, std::memory_order_release);
+      return;
+    }
+  }
+
+  state_.store(State::Finished, std::memory_order_release);
+}
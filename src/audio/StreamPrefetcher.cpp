@@ -0,0 +1,177 @@
+#include "audio/StreamPrefetcher.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+  // Frames read from the file per step
+  const size_t kReadFrames = 4096;
+
+  // How long the reader thread sleeps when the ring is full or the stream
+  // has ended; bounds how late it notices freed space and seeks
+  const auto kPollInterval = std::chrono::milliseconds(5);
+}
+
+StreamPrefetcher::StreamPrefetcher(size_t capacityFrames, bool blocking)
+  : reader_(kReadFrames), capacityFrames_(std::max(capacityFrames, kReadFrames)), channels_(0), frameCount_(0),
+  blocking_(blocking), writeIndex_(0), readIndex_(0), seekTarget_(0), seekRequest_(0), seekAnswered_(0),
+  seekStart_(0), endFrame_(0), position_(0), requested_(0), synced_(0), underruns_(0), stopping_(false) {}
+
+StreamPrefetcher::~StreamPrefetcher() {
+  stop();
+}
+
+bool StreamPrefetcher::open(const std::string& filename) {
+  stop();
+
+  if (!reader_.open(filename)) {
+    return false;
+  }
+
+  channels_ = reader_.getChannelCount();
+  frameCount_ = reader_.getFrameCount();
+  ring_.assign(capacityFrames_ * channels_, 0.0f);
+
+  writeIndex_.store(0, std::memory_order_relaxed);
+  readIndex_.store(0, std::memory_order_relaxed);
+  seekTarget_.store(0, std::memory_order_relaxed);
+  seekRequest_.store(0, std::memory_order_relaxed);
+  seekAnswered_.store(0, std::memory_order_relaxed);
+  seekStart_.store(0, std::memory_order_relaxed);
+  endFrame_.store(frameCount_, std::memory_order_relaxed);
+  position_ = 0;
+  requested_ = 0;
+  synced_ = 0;
+  stopping_.store(false, std::memory_order_relaxed);
+
+  thread_ = std::thread(&StreamPrefetcher::readerLoop, this);
+  return true;
+}
+
+void StreamPrefetcher::stop() {
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    stopping_.store(true, std::memory_order_release);
+  }
+  wake_.notify_all();
+  ready_.notify_all();
+
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void StreamPrefetcher::readerLoop() {
+  uint32_t answered = 0;
+  uint64_t write = 0;
+
+  while (!stopping_.load(std::memory_order_acquire)) {
+    uint32_t request = seekRequest_.load(std::memory_order_acquire);
+
+    // Frames already in the ring stay behind the mark; the consumer skips them
+    if (request != answered) {
+      reader_.seek(seekTarget_.load(std::memory_order_relaxed));
+      answered = request;
+      seekStart_.store(write, std::memory_order_relaxed);
+      seekAnswered_.store(request, std::memory_order_release);
+    }
+
+    size_t end = endFrame_.load(std::memory_order_relaxed);
+    size_t remaining = reader_.tell() < end ? end - reader_.tell() : 0;
+    size_t space = static_cast<size_t>(capacityFrames_ - (write - readIndex_.load(std::memory_order_acquire)));
+    size_t slot = static_cast<size_t>(write % capacityFrames_);
+    size_t frames = std::min({ kReadFrames, space, capacityFrames_ - slot, remaining });
+
+    if (frames == 0) {
+      std::unique_lock<std::mutex> lock(wakeMutex_);
+      wake_.wait_for(lock, kPollInterval, [this]() { return stopping_.load(std::memory_order_relaxed); });
+      continue;
+    }
+
+    size_t got = reader_.readFrames(ring_.data() + slot * channels_, frames);
+
+    if (got < frames) {
+      // The file is shorter than its header says; the stream ends here
+      endFrame_.store(reader_.tell(), std::memory_order_release);
+    }
+
+    write += got;
+    writeIndex_.store(write, std::memory_order_release);
+
+    if (blocking_) {
+      ready_.notify_all();
+    }
+  }
+}
+
+size_t StreamPrefetcher::available() {
+  if (seekAnswered_.load(std::memory_order_acquire) != requested_) {
+    return 0;
+  }
+
+  if (synced_ != requested_) {
+    readIndex_.store(seekStart_.load(std::memory_order_relaxed), std::memory_order_release);
+    synced_ = requested_;
+  }
+
+  return static_cast<size_t>(writeIndex_.load(std::memory_order_acquire) - readIndex_.load(std::memory_order_relaxed));
+}
+
+size_t StreamPrefetcher::getBufferedFrames() const {
+  if (seekAnswered_.load(std::memory_order_acquire) != requested_) {
+    return 0;
+  }
+
+  uint64_t start = synced_ == requested_ ? readIndex_.load(std::memory_order_relaxed)
+                                         : seekStart_.load(std::memory_order_relaxed);
+  return static_cast<size_t>(writeIndex_.load(std::memory_order_acquire) - start);
+}
+
+size_t StreamPrefetcher::read(float* dest, size_t frames) {
+  size_t done = 0;
+
+  for (;;) {
+    size_t end = getEndFrame();
+    size_t wanted = position_ < end ? std::min(frames - done, end - position_) : 0;
+    size_t count = std::min(wanted, available());
+
+    copyOut(dest + done * channels_, count);
+    done += count;
+
+    if (count == wanted || !blocking_ || stopping_.load(std::memory_order_relaxed)) break;
+
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    ready_.wait_for(lock, kPollInterval);
+  }
+
+  if (done < frames && position_ < getEndFrame()) {
+    underruns_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return done;
+}
+
+void StreamPrefetcher::copyOut(float* dest, size_t frames) {
+  if (frames == 0) return;
+
+  uint64_t read = readIndex_.load(std::memory_order_relaxed);
+  size_t slot = static_cast<size_t>(read % capacityFrames_);
+  size_t first = std::min(frames, capacityFrames_ - slot);
+
+  std::memcpy(dest, ring_.data() + slot * channels_, first * channels_ * sizeof(float));
+  std::memcpy(dest + first * channels_, ring_.data(), (frames - first) * channels_ * sizeof(float));
+
+  readIndex_.store(read + frames, std::memory_order_release);
+  position_ += frames;
+}
+
+void StreamPrefetcher::seek(size_t frame) {
+  frame = std::min(frame, frameCount_);
+
+  // position_ is always the latest target, so this also covers a seek
+  // still waiting for its answer
+  if (frame == position_) return;
+
+  position_ = frame;
+  seekTarget_.store(frame, std::memory_order_relaxed);
+  seekRequest_.store(++requested_, std::memory_order_release);
+}
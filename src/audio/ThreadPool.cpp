@@ -0,0 +1,96 @@
+#include "audio/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+struct ThreadPool::Job {
+  const std::function<void(size_t)>* task = nullptr;
+  size_t count = 0;
+  std::atomic<size_t> next{ 0 };
+  std::atomic<size_t> done{ 0 };
+
+  std::mutex mutex;
+  std::condition_variable finished;
+};
+
+ThreadPool::ThreadPool(size_t threadCount) : stopping_(false) {
+  workers_.reserve(threadCount);
+
+  for (size_t i = 0; i < threadCount; ++i) {
+    workers_.emplace_back(&ThreadPool::workerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+
+  available_.notify_all();
+
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& task) {
+  if (count == 0) return;
+
+  auto job = std::make_shared<Job>();
+  job->task = &task;
+  job->count = count;
+
+  // One helper entry per worker that can usefully join in
+  size_t helpers = std::min(workers_.size(), count - 1);
+
+  if (helpers > 0) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      for (size_t i = 0; i < helpers; ++i) {
+        queue_.push_back(job);
+      }
+    }
+
+    available_.notify_all();
+  }
+
+  runTasks(*job);
+
+  // Tasks claimed by workers are running; wait for them to finish
+  std::unique_lock<std::mutex> lock(job->mutex);
+  job->finished.wait(lock, [&job]() { return job->done.load() == job->count; });
+}
+
+void ThreadPool::workerLoop() {
+  for (;;) {
+    std::shared_ptr<Job> job;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      available_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+
+      if (queue_.empty()) return;
+
+      job = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    runTasks(*job);
+  }
+}
+
+void ThreadPool::runTasks(Job& job) {
+  for (;;) {
+    size_t index = job.next.fetch_add(1);
+
+    if (index >= job.count) return;
+
+    (*job.task)(index);
+
+    if (job.done.fetch_add(1) + 1 == job.count) {
+      std::lock_guard<std::mutex> lock(job.mutex);
+      job.finished.notify_all();
+    }
+  }
+}
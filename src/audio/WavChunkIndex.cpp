@@ -0,0 +1,197 @@
+#include "audio/WavChunkIndex.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <istream>
+#include <vector>
+
+namespace {
+  // Read up front from streams; covers the header chunks of nearly every file
+  const size_t kHeadBytes = 4096;
+
+  const uint16_t kFormatPcm = 1;
+  const uint16_t kFormatFloat = 3;
+  const uint16_t kFormatExtensible = 0xFFFE;
+
+  // Extensible sub-format GUIDs are the plain format tag followed by this
+  // fixed suffix (KSDATAFORMAT_SUBTYPE_PCM, _IEEE_FLOAT)
+  const uint8_t kSubFormatSuffix[14] = {
+    0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+  };
+
+  // 32-bit chunk size meaning "see ds64" in RF64 files
+  const uint32_t kSizeInDs64 = 0xFFFFFFFF;
+
+  bool isRiffId(const char* id) {
+    return strncmp(id, "RIFF", 4) == 0 || strncmp(id, "RF64", 4) == 0 || strncmp(id, "BW64", 4) == 0;
+  }
+
+  bool getSampleFormat(uint16_t formatTag, uint16_t bitsPerSample, SampleFormat& format) {
+    if (formatTag == kFormatPcm) {
+      switch (bitsPerSample) {
+        case 16: format = SampleFormat::Int16; return true;
+        case 24: format = SampleFormat::Int24; return true;
+        case 32: format = SampleFormat::Int32; return true;
+        default: return false;
+      }
+    }
+
+    if (formatTag == kFormatFloat && bitsPerSample == 32) {
+      format = SampleFormat::Float32;
+      return true;
+    }
+    return false;
+  }
+
+  void setLocation(ChunkLocation& location, uint64_t offset, uint64_t size) {
+    // The first chunk of each kind wins
+    if (!location.isPresent()) {
+      location.offset = offset;
+      location.size = size;
+    }
+  }
+}
+
+bool WavChunkIndex::build(const ReadAtFunction& readAt, WavChunkIndex& index) {
+  index = WavChunkIndex();
+  WavInfo& info = index.info;
+
+  // Read RIFF header
+  char riffHeader[12];
+
+  if (!readAt(0, riffHeader, 12) || !isRiffId(riffHeader) || strncmp(riffHeader + 8, "WAVE", 4) != 0) {
+    std::cerr << "Not a valid WAV file" << std::endl;
+    return false;
+  }
+
+  info.isRF64 = strncmp(riffHeader, "RIFF", 4) != 0;
+
+  // Walk every chunk; the list ends where a header can no longer be read
+  uint64_t offset = 12;
+  uint64_t ds64DataSize = 0;
+  bool ds64Found = false;
+
+  for (char chunkHeader[8]; readAt(offset, chunkHeader, 8);) {
+    uint32_t chunkSize;
+    std::memcpy(&chunkSize, chunkHeader + 4, 4);
+    uint64_t chunkData = offset + 8;
+    uint64_t size = chunkSize;
+
+    if (strncmp(chunkHeader, "ds64", 4) == 0 && info.isRF64) {
+      // RIFF size, data size and sample count as 64-bit values
+      uint8_t sizes[24];
+
+      if (chunkSize < 24 || !readAt(chunkData, sizes, 24)) {
+        std::cerr << "Truncated ds64 chunk" << std::endl;
+        return false;
+      }
+
+      std::memcpy(&ds64DataSize, sizes + 8, 8);
+      ds64Found = true;
+    }
+    else if (strncmp(chunkHeader, "fmt ", 4) == 0 && !index.format.isPresent()) {
+      // Plain PCM/float headers are 16 bytes (18 with cbSize); extensible
+      // ones are 40
+      uint8_t format[40];
+
+      if (chunkSize < 16 || !readAt(chunkData, format, std::min<size_t>(chunkSize, sizeof(format)))) {
+        std::cerr << "Truncated format chunk" << std::endl;
+        return false;
+      }
+
+      std::memcpy(&info.audioFormat, format, 2);
+      std::memcpy(&info.channels, format + 2, 2);
+      std::memcpy(&info.sampleRate, format + 4, 4);
+      std::memcpy(&info.blockAlign, format + 12, 2);
+      std::memcpy(&info.bitsPerSample, format + 14, 2);
+
+      uint16_t formatTag = info.audioFormat;
+
+      if (formatTag == kFormatExtensible) {
+        if (chunkSize < 40 || std::memcmp(format + 26, kSubFormatSuffix, sizeof(kSubFormatSuffix)) != 0) {
+          std::cerr << "Unsupported extensible format chunk" << std::endl;
+          return false;
+        }
+
+        // Valid bits may be fewer than the container's (e.g. 20 in 24);
+        // the container size decides the decoding
+        std::memcpy(&info.channelMask, format + 20, 4);
+        std::memcpy(&formatTag, format + 24, 2);
+      }
+
+      if (!getSampleFormat(formatTag, info.bitsPerSample, info.sampleFormat)) {
+        std::cerr << "Unsupported audio format: tag " << formatTag << ", "
+                  << info.bitsPerSample << "-bit" << std::endl;
+        return false;
+      }
+
+      if (info.channels == 0) {
+        std::cerr << "Invalid channel count: 0" << std::endl;
+        return false;
+      }
+
+      if (info.blockAlign != info.channels * SampleConversion::getBytesPerSample(info.sampleFormat)) {
+        std::cerr << "Invalid block alignment: " << info.blockAlign << std::endl;
+        return false;
+      }
+
+      setLocation(index.format, chunkData, size);
+    }
+    else if (strncmp(chunkHeader, "data", 4) == 0 && !index.data.isPresent()) {
+      if (info.isRF64 && chunkSize == kSizeInDs64) {
+        if (!ds64Found) {
+          std::cerr << "RF64 file without a ds64 chunk" << std::endl;
+          return false;
+        }
+        size = ds64DataSize;
+      }
+
+      setLocation(index.data, chunkData, size);
+    }
+    else if (strncmp(chunkHeader, "LIST", 4) == 0) {
+      setLocation(index.list, chunkData, size);
+    }
+    else if (strncmp(chunkHeader, "bext", 4) == 0) {
+      setLocation(index.bext, chunkData, size);
+    }
+    else if (strncmp(chunkHeader, "cue ", 4) == 0) {
+      setLocation(index.cue, chunkData, size);
+    }
+
+    // Chunks are padded to an even size
+    offset = chunkData + size + (size & 1);
+  }
+
+  if (!index.format.isPresent() || !index.data.isPresent()) {
+    return false;
+  }
+
+  info.dataOffset = index.data.offset;
+  info.dataSize = index.data.size;
+  info.frameCount = info.dataSize / info.blockAlign;
+  return true;
+}
+
+bool WavChunkIndex::build(std::istream& file, WavChunkIndex& index) {
+  // One read covers the header; only chunks beyond it (typically metadata
+  // after the samples) cost a seek each
+  std::vector<char> head(kHeadBytes);
+  file.clear();
+  file.seekg(0, std::ios::beg);
+  file.read(head.data(), static_cast<std::streamsize>(head.size()));
+  head.resize(static_cast<size_t>(file.gcount()));
+
+  auto readAt = [&file, &head](uint64_t offset, void* dest, size_t bytes) {
+    if (offset + bytes <= head.size()) {
+      std::memcpy(dest, head.data() + offset, bytes);
+      return true;
+    }
+
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+    file.read(static_cast<char*>(dest), static_cast<std::streamsize>(bytes));
+    return static_cast<size_t>(file.gcount()) == bytes;
+  };
+
+  return build(readAt, index);
+}
@@ -0,0 +1,92 @@
+#include "audio/WavIndexCache.h"
+#include <algorithm>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+WavIndexCache::WavIndexCache(size_t capacity)
+  : capacity_(std::max<size_t>(capacity, 1)), hits_(0), misses_(0) {}
+
+bool WavIndexCache::getStamp(const std::string& filename, FileStamp& stamp) {
+  std::error_code error;
+  fs::directory_entry entry(filename, error);
+
+  if (error) return false;
+
+  stamp.size = entry.file_size(error);
+  if (error) return false;
+
+  stamp.modified = entry.last_write_time(error).time_since_epoch().count();
+  return !error;
+}
+
+bool WavIndexCache::lookup(const std::string& filename, WavChunkIndex& index) {
+  FileStamp stamp;
+  bool haveStamp = getStamp(filename, stamp);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = byName_.find(filename);
+
+  if (found == byName_.end()) {
+    ++misses_;
+    return false;
+  }
+
+  if (!haveStamp || !(found->second->stamp == stamp)) {
+    // Changed or gone; the caller indexes it again
+    entries_.erase(found->second);
+    byName_.erase(found);
+    ++misses_;
+    return false;
+  }
+
+  entries_.splice(entries_.begin(), entries_, found->second);
+  index = found->second->index;
+  ++hits_;
+  return true;
+}
+
+void WavIndexCache::store(const std::string& filename, const WavChunkIndex& index) {
+  FileStamp stamp;
+
+  if (!getStamp(filename, stamp)) return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = byName_.find(filename);
+
+  if (found != byName_.end()) {
+    found->second->stamp = stamp;
+    found->second->index = index;
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return;
+  }
+
+  if (entries_.size() >= capacity_) {
+    byName_.erase(entries_.back().filename);
+    entries_.pop_back();
+  }
+
+  entries_.push_front(Entry{filename, stamp, index});
+  byName_[filename] = entries_.begin();
+}
+
+void WavIndexCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  byName_.clear();
+}
+
+size_t WavIndexCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+uint64_t WavIndexCache::getHits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+uint64_t WavIndexCache::getMisses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
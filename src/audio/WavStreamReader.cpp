@@ -0,0 +1,95 @@
+#include "audio/WavStreamReader.h"
+#include "audio/SampleConversion.h"
+#include <algorithm>
+#include <iostream>
+
+WavStreamReader::WavStreamReader(size_t blockFrames)
+  : blockFrames_(std::max<size_t>(1, blockFrames)), position_(0), filePositionValid_(false) {}
+
+bool WavStreamReader::open(const std::string& filename) {
+  close();
+
+  file_.open(filename, std::ios::binary);
+
+  if (!file_.is_open()) {
+    std::cerr << "Cannot open file: " << filename << std::endl;
+    return false;
+  }
+
+  if (!AudioFileLoader::parseWavChunks(file_, info_)) {
+    std::cerr << "Failed to read WAV header from: " << filename << std::endl;
+    close();
+    return false;
+  }
+
+  filename_ = filename;
+  rawBlock_.resize(blockFrames_ * info_.blockAlign);
+  return seek(0);
+}
+
+void WavStreamReader::close() {
+  if (file_.is_open()) {
+    file_.close();
+  }
+
+  file_.clear();
+  info_ = WavInfo();
+  filename_.clear();
+  position_ = 0;
+  filePositionValid_ = false;
+}
+
+bool WavStreamReader::seek(size_t frame) {
+  if (!isOpen()) return false;
+
+  position_ = std::min(frame, getFrameCount());
+  filePositionValid_ = false;
+  return true;
+}
+
+size_t WavStreamReader::readFrames(float* dest, size_t frames) {
+  if (!isOpen() || !dest) return 0;
+
+  size_t channelCount = info_.channels;
+  size_t frameBytes = info_.blockAlign;
+  size_t framesRead = 0;
+
+  frames = std::min(frames, getFrameCount() - position_);
+
+  if (!filePositionValid_ && frames > 0) {
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(info_.dataOffset + position_ * frameBytes), std::ios::beg);
+    filePositionValid_ = true;
+  }
+
+  while (framesRead < frames) {
+    size_t framesToRead = std::min(blockFrames_, frames - framesRead);
+    size_t bytesToRead = framesToRead * frameBytes;
+
+    file_.read(reinterpret_cast<char*>(rawBlock_.data()), bytesToRead);
+
+    size_t framesGot = static_cast<size_t>(file_.gcount()) / frameBytes;
+    size_t samplesGot = framesGot * channelCount;
+
+    SampleConversion::toFloat(info_.sampleFormat, rawBlock_.data(), dest + framesRead * channelCount, samplesGot);
+
+    framesRead += framesGot;
+    position_ += framesGot;
+
+    if (framesGot < framesToRead) {
+      // Truncated data chunk
+      filePositionValid_ = false;
+      break;
+    }
+  }
+
+  return framesRead;
+}
+
+size_t WavStreamReader::readBlock(std::vector<float>& block) {
+  block.resize(blockFrames_ * info_.channels);
+
+  size_t framesRead = readFrames(block.data(), blockFrames_);
+  block.resize(framesRead * info_.channels);
+  return framesRead;
+}
@@ -1,10 +1,51 @@
 #include "ui/Application.h"
+#include "audio/AudioFileWriter.h"
+#include "audio/PeakFile.h"
+#include "audio/SampleKernels.h"
+#include "audio/ThreadPool.h"
+#include "audio/WavIndexCache.h"
+#include <algorithm>
 #include <iostream>
 #include <cmath>
-#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+  // Files with more audio data than this are streamed instead of loaded
+  const uint64_t kStreamingThresholdBytes = 512ULL * 1024 * 1024;
+
+  // Longest the loop sleeps waiting for input while nothing needs drawing
+  const int kIdleWaitMs = 250;
+
+  // Frames rendered per write when exporting
+  const size_t kExportBlockFrames = 64 * 1024;
+
+  // Scans share the machine with playback and the UI, so they get a few
+  // threads rather than one per core
+  const size_t kLibraryScanThreads = 2;
+
+  // Export progress is printed in steps of this many percent
+  const size_t kExportReportPercent = 10;
+
+  // Library entries skipped by Page Up/Page Down
+  const long kLibraryPageEntries = 100;
+
+  // selectedEntry_ before anything is selected
+  const size_t kNoEntry = static_cast<size_t>(-1);
+
+  std::string formatLevel(float level) {
+    std::ostringstream text;
+    text.precision(1);
+    text << std::fixed << 20.0f * std::log10(std::max(level, 1e-6f)) << " dBFS";
+    return text.str();
+  }
+}
 
 Application::Application()
-  : running_(false), audioLoaded_(false), currentGain_(1.0f), showWaveform_(true), audioPlaying_(false) {}
+  : displayedFrames_(0), peaksFromSidecar_(false), scanningStreamPeaks_(false), running_(false), audioLoaded_(false), streaming_(false), currentGain_(1.0f), showWaveform_(true), audioPlaying_(false),
+  redrawNeeded_(true), reportedXruns_(0), selectedEntry_(kNoEntry), libraryScanDone_(false), cancelLibraryScan_(false),
+  exportTotalFrames_(0), reportedExportPercent_(0), exportOk_(false), exportedFrames_(0), exportDone_(false), cancelExport_(false) {}
 
 Application::~Application() {
   shutdown();
@@ -21,18 +62,55 @@ bool Application::initialize() {
   waveformView_ = std::make_unique<WaveformView>(50, 100, 800, 300);
   waveformView_->setColor(0, 255, 0, 255);
 
-  audioBuffer_ = std::make_unique<AudioBuffer>(44100, 2);
-  gainEffect_ = std::make_unique<GainEffect>(currentGain_);
+  audioBuffer_ = std::make_shared<AudioBuffer>(44100, 2);
+  gainEffect_ = std::make_shared<GainEffect>(currentGain_);
   audioPlayer_ = std::make_unique<AudioPlayer>();
   fileLoader_ = std::make_unique<AudioFileLoader>();
+  fileLoader_->setIndexCache(std::make_shared<WavIndexCache>());
+  asyncLoader_ = std::make_unique<AsyncFileLoader>();
+  peakScanner_ = std::make_unique<StreamPeakScanner>();
+
+  // Monitoring while editing wants short device periods; the period size
+  // in frames can be given, e.g. MINI_AUDIO_LOW_LATENCY=128
+  AudioPlayer::DeviceConfig deviceConfig;
 
-  if (!audioPlayer_->initialize()) {
+  if (const char* period = std::getenv("MINI_AUDIO_LOW_LATENCY")) {
+    int frames = std::atoi(period);
+    deviceConfig = AudioPlayer::DeviceConfig::lowLatency(frames > 0 ? frames : 128);
+  }
+
+  if (const char* device = std::getenv("MINI_AUDIO_DEVICE")) {
+    deviceConfig.deviceName = device;
+  }
+
+  if (!audioPlayer_->initialize(deviceConfig)) {
     std::cerr << "Failed to initialize audio player" << std::endl;
     return false;
   }
 
+  // Callback timing report for sizing device buffers on a given machine
+  if (const char* statsFile = std::getenv("MINI_AUDIO_CALLBACK_STATS")) {
+    audioPlayer_->setCallbackStatsReport(statsFile);
+  }
+
+  audioPlayer_->setEffects({ gainEffect_ });
+
   loadTestAudio();
 
+  // The saved index is browsable at once; a rescan then picks up changes.
+  // Only a library chosen explicitly is scanned at startup, since the
+  // working directory may be arbitrarily large; R scans on request.
+  const char* libraryRoot = std::getenv("MINI_AUDIO_LIBRARY");
+  libraryRoot_ = libraryRoot ? libraryRoot : ".";
+
+  if (library_.load(SampleLibrary::getIndexPath(libraryRoot_))) {
+    std::cout << "Sample library: " << library_.size() << " files in " << libraryRoot_ << std::endl;
+  }
+
+  if (libraryRoot) {
+    scanLibrary();
+  }
+
   running_ = true;
   std::cout << "Application initialized successfully" << std::endl;
   return true;
@@ -48,20 +126,53 @@ void Application::run() {
   std::cout << "  W - Toggle waveform" << std::endl;
   std::cout << "  SPACE - Play/Pause audio" << std::endl;
   std::cout << "  S - Stop audio" << std::endl;
-  std::cout << "  L - Load WAV file (if available)" << std::endl;
+  std::cout << "  Up/Down, PgUp/PgDn - Browse the sample library" << std::endl;
+  std::cout << "  L - Load the selected library file" << std::endl;
+  std::cout << "  R - Rescan the sample library" << std::endl;
+  std::cout << "  E - Export to export.wav" << std::endl;
 
   while (running_) {
     handleEvents();
     update();
-    render();
 
-    SDL_Delay(16);
+    // Only present frames when something changed; otherwise sleep until
+    // the next event instead of spinning
+    if (redrawNeeded_) {
+      render();
+      redrawNeeded_ = false;
+      SDL_Delay(16);
+    }
+    else {
+      window_->waitForEvent(kIdleWaitMs);
+    }
   }
 }
 
 void Application::shutdown() {
   running_ = false;
 
+  if (libraryScan_.joinable()) {
+    cancelLibraryScan_.store(true, std::memory_order_relaxed);
+    libraryScan_.join();
+  }
+
+  if (exportThread_.joinable()) {
+    cancelExport_.store(true, std::memory_order_relaxed);
+    exportThread_.join();
+  }
+
+  if (asyncLoader_) {
+    asyncLoader_->cancel();
+  }
+
+  if (peakScanner_) {
+    peakScanner_->cancel();
+  }
+
+  if (audioPlayer_) {
+    audioPlayer_->shutdown();
+  }
+
   if (window_) {
     window_->close();
   }
@@ -90,6 +201,8 @@ void Application::loadTestAudio() {
   }
 
   audioLoaded_ = true;
+  streaming_ = false;
+  loadingFrames_.reset();
   waveformView_->setAudioBuffer(*audioBuffer_);
 
   std::cout << "Loaded test audio: 1 second sine wave at 440Hz" << std::endl;
@@ -98,45 +211,391 @@ void Application::loadTestAudio() {
 void Application::loadAudioFile(const std::string& filename) {
   if (!fileLoader_ || !audioBuffer_) return;
 
-  if (!fileLoader_->canLoadFile(filename)) {
+  if (exportThread_.joinable()) {
+    std::cout << "Cannot load while exporting to " << exportFilename_ << std::endl;
+    return;
+  }
+
+  // One header pass serves the check, the streaming decision and the load
+  WavInfo info;
+
+  if (!fileLoader_->getWavInfo(filename, info)) {
     std::cout << "Cannot load file: " << filename << " (not a valid WAV file)" << std::endl;
     return;
   }
 
-  if (fileLoader_->loadWavFile(filename, *audioBuffer_)) {
-    audioLoaded_ = true;
-    waveformView_->setAudioBuffer(*audioBuffer_);
+  // Stop any current playback before its source is replaced
+  if (audioPlaying_) {
+    audioPlayer_->stop();
+    audioPlaying_ = false;
+  }
 
-    // Stop any current playback
+  if (info.dataSize > kStreamingThresholdBytes) {
+    openAudioStream(filename);
+    return;
+  }
+
+  // Read on a worker thread into a fresh buffer; the player keeps its
+  // reference to the old one until the audio thread has swapped it out
+  if (!asyncLoader_->start(filename, info)) {
+    std::cout << "Failed to load audio file: " << filename << std::endl;
+    return;
+  }
+
+  // A peak scan of a previous stream is no longer needed
+  peakScanner_->cancel();
+  scanningStreamPeaks_ = false;
+
+  audioBuffer_ = asyncLoader_->getBuffer();
+  loadingFrames_ = asyncLoader_->getLoadedFrameCounter();
+  displayedFrames_ = 0;
+  audioLoaded_ = true;
+  streaming_ = false;
+
+  // A sidecar overview that still matches the file shows the whole
+  // waveform at once; otherwise it fills in as the samples arrive
+  PeakFileKey key;
+  PeakPyramid peaks;
+  peaksFromSidecar_ = PeakFile::computeKey(filename, key) &&
+    PeakFile::load(PeakFile::getSidecarPath(filename), key, peaks) &&
+    peaks.getFrameCount() == audioBuffer_->getFrameCount();
+
+  if (peaksFromSidecar_) {
+    waveformView_->setLoadingBuffer(*audioBuffer_, peaks);
+  }
+  else {
+    waveformView_->setLoadingBuffer(*audioBuffer_);
+  }
+
+  std::cout << "Loading audio file: " << filename << " (" << audioBuffer_->getFrameCount() << " frames)" << std::endl;
+}
+
+void Application::updateLoading() {
+  // The state is read first: once it is Finished, every frame is loaded
+  AsyncFileLoader::State state = asyncLoader_->getState();
+  size_t loadedFrames = asyncLoader_->getLoadedFrames();
+
+  if (loadedFrames != displayedFrames_) {
+    waveformView_->setLoadedFrames(loadedFrames);
+    displayedFrames_ = loadedFrames;
+    redrawNeeded_ = true;
+  }
+
+  if (state == AsyncFileLoader::State::Loading) return;
+
+  loadingFrames_.reset();
+  redrawNeeded_ = true;
+
+  if (state != AsyncFileLoader::State::Finished) {
+    // Playback would wait forever for frames that will not arrive
     if (audioPlaying_) {
-      audioPlayer_->stop();
-      audioPlaying_ = false;
+      stopPlayback();
     }
 
-    std::cout << "Audio file loaded successfully" << std::endl;
+    std::cout << "Failed to load audio file: " << asyncLoader_->getFilename() << std::endl;
+    return;
+  }
+
+  const std::string& filename = asyncLoader_->getFilename();
+  PeakFileKey key;
+  std::string sidecar = PeakFile::getSidecarPath(filename);
+
+  if (!peaksFromSidecar_ && PeakFile::computeKey(filename, key) && !PeakFile::save(sidecar, key, waveformView_->getPeaks())) {
+    std::cout << "Could not write waveform cache: " << sidecar << std::endl;
+  }
+
+  std::cout << "Audio file loaded successfully" << std::endl;
+}
+
+void Application::updateStreamPeaks() {
+  // The state is read first: once it is Finished, every piece is queued
+  StreamPeakScanner::State state = peakScanner_->getState();
+  StreamPeakScanner::Piece piece;
+
+  while (peakScanner_->takePiece(piece)) {
+    waveformView_->addStreamPeaks(piece.peaks, piece.startFrame);
+    redrawNeeded_ = true;
+  }
+
+  if (state == StreamPeakScanner::State::Scanning) return;
+
+  scanningStreamPeaks_ = false;
+
+  if (state != StreamPeakScanner::State::Finished) return;
+
+  const std::string& filename = peakScanner_->getFilename();
+  PeakFileKey key;
+  std::string sidecar = PeakFile::getSidecarPath(filename);
+
+  if (PeakFile::computeKey(filename, key) && !PeakFile::save(sidecar, key, waveformView_->getPeaks())) {
+    std::cout << "Could not write waveform cache: " << sidecar << std::endl;
+  }
+}
+
+void Application::openAudioStream(const std::string& filename) {
+  if (exportThread_.joinable()) {
+    std::cout << "Cannot load while exporting to " << exportFilename_ << std::endl;
+    return;
+  }
+
+  auto playbackStream = std::make_shared<WavStreamReader>();
+  auto viewStream = std::make_unique<WavStreamReader>();
+
+  if (!playbackStream->open(filename) || !viewStream->open(filename)) {
+    std::cout << "Failed to open audio stream: " << filename << std::endl;
+    return;
+  }
+
+  // A load still filling the previous buffer is no longer needed
+  asyncLoader_->cancel();
+  loadingFrames_.reset();
+
+  playbackStream_ = std::move(playbackStream);
+  viewStream_ = std::move(viewStream);
+
+  audioLoaded_ = true;
+  streaming_ = true;
+
+  // A matching sidecar gives the overview at once. Otherwise the file is
+  // scanned in the background and the overview fills in as it goes; the
+  // sidecar is written when the scan ends.
+  PeakFileKey key;
+  PeakPyramid peaks;
+
+  peakScanner_->cancel();
+
+  if (PeakFile::computeKey(filename, key) && PeakFile::load(PeakFile::getSidecarPath(filename), key, peaks) &&
+      peaks.getFrameCount() == viewStream_->getFrameCount()) {
+    waveformView_->setAudioStream(*viewStream_, peaks);
+    scanningStreamPeaks_ = false;
   }
   else {
-    std::cout << "Failed to load audio file: " << filename << std::endl;
+    waveformView_->setAudioStream(*viewStream_);
+    scanningStreamPeaks_ = peakScanner_->start(filename);
   }
+
+  std::cout << "Streaming audio file: " << filename << " ("
+            << viewStream_->getFrameCount() << " frames)" << std::endl;
 }
 
 void Application::applyGainEffect(float gain) {
-  if (!gainEffect_ || !audioBuffer_ || !waveformView_) return;
+  if (!gainEffect_ || !waveformView_) return;
 
-  currentGain_ = gain;
+  // Gain runs live in the playback chain, so a change only updates the
+  // parameter; the source audio is never rewritten
   gainEffect_->setGain(gain);
+  currentGain_ = gainEffect_->getGain();
 
-  // Apply effect directly to the original buffer
-  gainEffect_->process(*audioBuffer_);
+  // Preview the gain by scaling the waveform display
+  waveformView_->setDisplayGain(currentGain_);
 
-  // Update waveform with the modified audio buffer
-  waveformView_->setAudioBuffer(*audioBuffer_);
+  std::cout << "Applied gain: " << currentGain_ << std::endl;
+}
 
-  if (audioPlayer_) {
-    audioPlayer_->setVolume(gain);
+void Application::exportAudio(const std::string& filename) {
+  if (!audioLoaded_ || !audioBuffer_) return;
+
+  if (loadingFrames_) {
+    std::cout << "Cannot export while the file is still loading" << std::endl;
+    return;
+  }
+
+  if (exportThread_.joinable()) {
+    std::cout << "Export already running: " << exportFilename_ << std::endl;
+    return;
   }
 
-  std::cout << "Applied gain: " << gain << std::endl;
+  // The worker gets its own reference to the source and the gain as it is
+  // now, so later gain changes do not reach a running export
+  std::shared_ptr<const AudioBuffer> source = streaming_ ? nullptr : audioBuffer_;
+  std::string streamFilename = streaming_ ? viewStream_->getFilename() : std::string();
+  float gain = currentGain_;
+
+  exportFilename_ = filename;
+  exportTotalFrames_ = streaming_ ? viewStream_->getFrameCount() : audioBuffer_->getFrameCount();
+  reportedExportPercent_ = 0;
+  exportedFrames_.store(0, std::memory_order_relaxed);
+  exportDone_.store(false, std::memory_order_relaxed);
+  cancelExport_.store(false, std::memory_order_relaxed);
+
+  std::cout << "Exporting to " << filename << " (" << exportTotalFrames_ << " frames)" << std::endl;
+
+  exportThread_ = std::thread([this, filename, streamFilename, source, gain]() {
+    exportOk_ = writeExport(filename, streamFilename, source.get(), gain);
+    exportDone_.store(true, std::memory_order_release);
+  });
+}
+
+bool Application::writeExport(const std::string& filename, const std::string& streamFilename,
+                              const AudioBuffer* source, float gain) {
+  // The live gain is rendered into the export; the source is never changed.
+  // Blocks are appended as they are rendered, so streamed files export in
+  // constant memory too.
+  AudioFileWriter writer;
+  writer.setSampleFormat(SampleFormat::Int24);
+  std::vector<float> block;
+  bool ok;
+
+  auto cancelled = [this]() { return cancelExport_.load(std::memory_order_relaxed); };
+
+  if (!source) {
+    WavStreamReader reader(kExportBlockFrames);
+    ok = reader.open(streamFilename) &&
+         writer.open(filename, reader.getSampleRate(), reader.getChannelCount());
+
+    while (ok && !cancelled()) {
+      size_t frames = reader.readBlock(block);
+
+      if (frames == 0) break;
+
+      SampleKernels::applyGain(block.data(), block.size(), gain);
+      ok = writer.write(block.data(), frames);
+      exportedFrames_.store(static_cast<size_t>(writer.getFramesWritten()), std::memory_order_relaxed);
+    }
+  }
+  else {
+    // Const access, so shared or mapped storage is read in place
+    size_t channels = source->getChannelCount();
+    ConstAudioBufferView view = source->getView();
+    ok = writer.open(filename, source->getSampleRate(), channels);
+    block.resize(kExportBlockFrames * channels);
+
+    for (size_t frame = 0; ok && !cancelled() && frame < source->getFrameCount(); frame += kExportBlockFrames) {
+      size_t frames = std::min(kExportBlockFrames, source->getFrameCount() - frame);
+      AudioBufferView rendered(block.data(), frames, channels);
+
+      if (!view.isEmpty()) {
+        copyFrames(view.getFrames(frame, frames), rendered, gain);
+      }
+      else {
+        for (size_t i = 0; i < frames; ++i) {
+          for (size_t channel = 0; channel < channels; ++channel) {
+            rendered.at(i, channel) = source->getSample(frame + i, channel) * gain;
+          }
+        }
+      }
+      ok = writer.write(rendered);
+      exportedFrames_.store(static_cast<size_t>(writer.getFramesWritten()), std::memory_order_relaxed);
+    }
+  }
+
+  if (writer.isOpen()) {
+    ok = writer.close() && ok;
+  }
+
+  // A cancelled export leaves no partial file behind
+  if (cancelled()) {
+    std::remove(filename.c_str());
+    return false;
+  }
+  return ok;
+}
+
+void Application::updateExport() {
+  if (!exportDone_.load(std::memory_order_acquire)) {
+    size_t percent = exportTotalFrames_ > 0
+      ? exportedFrames_.load(std::memory_order_relaxed) * 100 / exportTotalFrames_ : 0;
+
+    if (percent >= reportedExportPercent_ + kExportReportPercent) {
+      reportedExportPercent_ = percent / kExportReportPercent * kExportReportPercent;
+      std::cout << "Exporting: " << reportedExportPercent_ << "%" << std::endl;
+    }
+    return;
+  }
+
+  exportThread_.join();
+
+  if (exportOk_) {
+    std::cout << "Exported " << exportedFrames_.load(std::memory_order_relaxed) << " frames to " << exportFilename_ << std::endl;
+  }
+  else {
+    std::cout << "Failed to export audio: " << exportFilename_ << std::endl;
+  }
+}
+
+void Application::scanLibrary() {
+  if (libraryScan_.joinable()) {
+    std::cout << "Sample library scan already running" << std::endl;
+    return;
+  }
+
+  // Starts from the current catalogue, so only new or changed files are read
+  scannedLibrary_ = std::make_unique<SampleLibrary>(library_);
+  libraryScanDone_.store(false, std::memory_order_relaxed);
+  cancelLibraryScan_.store(false, std::memory_order_relaxed);
+
+  std::cout << "Scanning sample library: " << libraryRoot_ << std::endl;
+
+  libraryScan_ = std::thread([this]() {
+    ThreadPool pool(kLibraryScanThreads);
+    scanStats_ = scannedLibrary_->scan({ libraryRoot_ }, &pool, &cancelLibraryScan_);
+    libraryScanDone_.store(true, std::memory_order_release);
+  });
+}
+
+void Application::finishLibraryScan() {
+  libraryScan_.join();
+
+  if (scanStats_.cancelled) return;
+
+  // Keep the selection on the same file where it still exists
+  std::string selected = selectedEntry_ < library_.size() ? library_.getEntries()[selectedEntry_].path : "";
+  library_ = std::move(*scannedLibrary_);
+  scannedLibrary_.reset();
+
+  size_t index = library_.find(selected);
+
+  if (index < library_.size()) {
+    selectedEntry_ = index;
+  }
+  else if (selectedEntry_ != kNoEntry) {
+    selectedEntry_ = library_.isEmpty() ? kNoEntry : std::min(selectedEntry_, library_.size() - 1);
+  }
+
+  std::cout << "Sample library: " << scanStats_.files << " files (" << scanStats_.analyzed << " read, "
+            << scanStats_.failed << " unreadable, " << scanStats_.removed << " removed) in "
+            << scanStats_.seconds << " s" << std::endl;
+
+  std::string indexPath = SampleLibrary::getIndexPath(libraryRoot_);
+
+  if ((scanStats_.analyzed > 0 || scanStats_.removed > 0) && !library_.save(indexPath)) {
+    std::cout << "Could not write sample library index: " << indexPath << std::endl;
+  }
+}
+
+void Application::selectLibraryEntry(long offset) {
+  if (library_.isEmpty()) {
+    std::cout << "Sample library is empty: no WAV files catalogued in " << libraryRoot_ << " (R to scan)" << std::endl;
+    return;
+  }
+
+  // The first key press selects the first file
+  long last = static_cast<long>(library_.size()) - 1;
+  selectedEntry_ = selectedEntry_ == kNoEntry
+    ? 0
+    : static_cast<size_t>(std::clamp(static_cast<long>(selectedEntry_) + offset, 0L, last));
+
+  const SampleLibrary::Entry& entry = library_.getEntries()[selectedEntry_];
+  std::cout << "[" << selectedEntry_ + 1 << "/" << library_.size() << "] " << entry.path;
+
+  if (entry.isReadable()) {
+    std::cout << "  " << entry.sampleRate << " Hz, " << entry.channels << " ch, "
+              << SampleConversion::getFormatName(entry.sampleFormat) << ", " << entry.getDuration() << " s, peak "
+              << formatLevel(entry.peak) << ", RMS " << formatLevel(entry.rms);
+  }
+  else {
+    std::cout << "  (unreadable)";
+  }
+  std::cout << std::endl;
+}
+
+void Application::loadSelectedEntry() {
+  if (selectedEntry_ >= library_.size()) {
+    std::cout << "No library file selected; browse with Up/Down" << std::endl;
+    return;
+  }
+
+  loadAudioFile(library_.getEntries()[selectedEntry_].path);
 }
 
 void Application::togglePlayback() {
@@ -153,7 +612,12 @@ void Application::togglePlayback() {
     }
   }
   else {
-    audioPlayer_->play(*audioBuffer_);
+    if (streaming_) {
+      audioPlayer_->play(playbackStream_);
+    }
+    else {
+      audioPlayer_->play(audioBuffer_, loadingFrames_);
+    }
     audioPlaying_ = true;
     std::cout << "Audio started" << std::endl;
   }
@@ -173,12 +637,25 @@ void Application::handleEvents() {
   SDL_Event event;
 
   while (window_->pollEvent(event)) {
+    // Any input or window event (expose, resize) may change what is shown
+    redrawNeeded_ = true;
+
     switch (event.type) {
       case SDL_QUIT: {
         quit();
         break;
       }
 
+      // Target texture contents (or, after a device reset, the textures
+      // themselves) are gone; the waveform is drawn into a new one
+      case SDL_RENDER_TARGETS_RESET:
+      case SDL_RENDER_DEVICE_RESET: {
+        if (waveformView_) {
+          waveformView_->releaseTexture();
+        }
+        break;
+      }
+
       case SDL_KEYDOWN: {
         switch (event.key.keysym.sym) {
           case SDLK_ESCAPE: {
@@ -213,15 +690,38 @@ void Application::handleEvents() {
             break;
           }
 
+          case SDLK_UP: {
+            selectLibraryEntry(-1);
+            break;
+          }
+
+          case SDLK_DOWN: {
+            selectLibraryEntry(1);
+            break;
+          }
+
+          case SDLK_PAGEUP: {
+            selectLibraryEntry(-kLibraryPageEntries);
+            break;
+          }
+
+          case SDLK_PAGEDOWN: {
+            selectLibraryEntry(kLibraryPageEntries);
+            break;
+          }
+
           case SDLK_l: {
-            if (std::filesystem::exists("sample.wav")) {
-              std::cout << "Loading sample.wav file..." << std::endl;
-              loadAudioFile("sample.wav");
-              std::cout << "File loading completed." << std::endl;
-            }
-            else {
-              std::cout << "No sample.wav file found. Create a WAV file named 'sample.wav' to test file loading." << std::endl;
-            }
+            loadSelectedEntry();
+            break;
+          }
+
+          case SDLK_r: {
+            scanLibrary();
+            break;
+          }
+
+          case SDLK_e: {
+            exportAudio("export.wav");
             break;
           }
         }
@@ -232,6 +732,33 @@ void Application::handleEvents() {
 }
 
 void Application::update() {
+  if (loadingFrames_ && asyncLoader_) {
+    updateLoading();
+  }
+
+  if (scanningStreamPeaks_) {
+    updateStreamPeaks();
+  }
+
+  if (libraryScan_.joinable() && libraryScanDone_.load(std::memory_order_acquire)) {
+    finishLibraryScan();
+  }
+
+  if (exportThread_.joinable()) {
+    updateExport();
+  }
+
+  if (audioPlayer_) {
+    audioPlayer_->collectRetiredSources();
+
+    CallbackStats::Snapshot stats = audioPlayer_->getCallbackStats().getSnapshot();
+
+    if (stats.getXruns() > reportedXruns_) {
+      std::cerr << "Audio xrun: " << stats.getXruns() << " total, worst callback "
+                << stats.getMaxLoad() * 100.0f << "% of the buffer period" << std::endl;
+      reportedXruns_ = stats.getXruns();
+    }
+  }
 }
 
 void Application::render() {
@@ -2,23 +2,169 @@
 #include <algorithm>
 #include <cmath>
 
+namespace {
+  // Upper bound on frames read per pixel when browsing a stream
+  const size_t kMaxStreamFramesPerPixel = 1024;
+}
+
 WaveformView::WaveformView(int x, int y, int width, int height)
   : x_(x), y_(y), width_(width), height_(height),
-  color_({ 255, 255, 255, 255 }), zoom_(1.0f), scrollOffset_(0),
-  audioBuffer_(nullptr), dataUpdated_(false) {}
+  color_({ 255, 255, 255, 255 }), zoom_(1.0f), displayGain_(1.0f), scrollOffset_(0),
+  audioBuffer_(nullptr), loadedFrames_(0), scannedFrames_(0), audioStream_(nullptr), dataUpdated_(false),
+  texture_(nullptr), textureRenderer_(nullptr), textureWidth_(0), textureHeight_(0),
+  textureValid_(false) {}
 
 void WaveformView::setAudioBuffer(const AudioBuffer& buffer) {
   audioBuffer_ = &buffer;
+  loadedFrames_ = scannedFrames_ = buffer.getFrameCount();
+  audioStream_ = nullptr;
+  peaks_.build(buffer);
+  dataUpdated_ = false;
+}
+
+void WaveformView::setAudioBuffer(const AudioBuffer& buffer, const PeakPyramid& peaks) {
+  audioBuffer_ = &buffer;
+  loadedFrames_ = scannedFrames_ = buffer.getFrameCount();
+  audioStream_ = nullptr;
+  peaks_ = peaks;
+  dataUpdated_ = false;
+}
+
+void WaveformView::setLoadingBuffer(const AudioBuffer& buffer) {
+  audioBuffer_ = &buffer;
+  loadedFrames_ = scannedFrames_ = 0;
+  audioStream_ = nullptr;
+  peaks_.reset(buffer.getFrameCount(), buffer.getChannelCount());
+  dataUpdated_ = false;
+}
+
+void WaveformView::setLoadingBuffer(const AudioBuffer& buffer, const PeakPyramid& peaks) {
+  audioBuffer_ = &buffer;
+  loadedFrames_ = 0;
+  scannedFrames_ = buffer.getFrameCount();
+  audioStream_ = nullptr;
+  peaks_ = peaks;
+  dataUpdated_ = false;
+}
+
+void WaveformView::setLoadedFrames(size_t frames) {
+  if (!audioBuffer_) return;
+
+  size_t frameCount = audioBuffer_->getFrameCount();
+  loadedFrames_ = std::min(frames, frameCount);
+
+  // Only whole base buckets are scanned until the end, so the pyramid never
+  // reads past the loaded frames
+  size_t scanEnd = loadedFrames_ == frameCount
+    ? frameCount
+    : loadedFrames_ / PeakPyramid::kBaseBucketFrames * PeakPyramid::kBaseBucketFrames;
+
+  if (scanEnd > scannedFrames_) {
+    peaks_.update(*audioBuffer_, scannedFrames_, scanEnd - scannedFrames_);
+    scannedFrames_ = scanEnd;
+  }
+  dataUpdated_ = false;
+}
+
+void WaveformView::refreshAudioRange(size_t startFrame, size_t frames) {
+  if (!audioBuffer_) return;
+
+  peaks_.update(*audioBuffer_, startFrame, frames);
+  dataUpdated_ = false;
+}
+
+void WaveformView::setAudioStream(WavStreamReader& stream) {
+  audioStream_ = &stream;
+  audioBuffer_ = nullptr;
+  loadedFrames_ = scannedFrames_ = 0;
+  peaks_.reset(stream.getFrameCount(), stream.getChannelCount());
+  dataUpdated_ = false;
+}
+
+void WaveformView::setAudioStream(WavStreamReader& stream, const PeakPyramid& peaks) {
+  audioStream_ = &stream;
+  audioBuffer_ = nullptr;
+  loadedFrames_ = 0;
+  scannedFrames_ = stream.getFrameCount();
+  peaks_ = peaks;
+  dataUpdated_ = false;
+}
+
+void WaveformView::addStreamPeaks(const PeakPyramid& piece, size_t startFrame) {
+  if (!audioStream_ || startFrame != scannedFrames_ || !peaks_.insertPiece(piece, startFrame)) return;
+
+  scannedFrames_ = startFrame + piece.getFrameCount();
   dataUpdated_ = false;
 }
 
+WaveformView::~WaveformView() {
+  releaseTexture();
+}
+
 void WaveformView::render(SDL_Renderer* renderer) {
-  if (!renderer || !audioBuffer_ || audioBuffer_->getFrameCount() == 0) {
+  if (!renderer || getSourceFrameCount() == 0) {
     return;
   }
 
-  updateWaveformData();
-  drawWaveform(renderer);
+  if (!dataUpdated_) {
+    updateWaveformData();
+    textureValid_ = false;
+  }
+
+  if (textureRenderer_ != renderer) {
+    textureValid_ = false;
+  }
+
+  if (!textureValid_ && !renderTexture(renderer)) {
+    // Renderer without target texture support: draw straight to the screen
+    drawWaveform(renderer, x_, y_);
+    return;
+  }
+
+  SDL_Rect destination = { x_, y_, width_, height_ };
+  SDL_RenderCopy(renderer, texture_, nullptr, &destination);
+}
+
+bool WaveformView::renderTexture(SDL_Renderer* renderer) {
+  if (texture_ && (textureRenderer_ != renderer || textureWidth_ != width_ || textureHeight_ != height_)) {
+    releaseTexture();
+  }
+
+  if (!texture_) {
+    if (width_ <= 0 || height_ <= 0) return false;
+
+    texture_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width_, height_);
+
+    if (!texture_) return false;
+
+    SDL_SetTextureBlendMode(texture_, SDL_BLENDMODE_BLEND);
+    textureRenderer_ = renderer;
+    textureWidth_ = width_;
+    textureHeight_ = height_;
+  }
+
+  if (SDL_SetRenderTarget(renderer, texture_) != 0) {
+    releaseTexture();
+    return false;
+  }
+
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+  SDL_RenderClear(renderer);
+  drawWaveform(renderer, 0, 0);
+  SDL_SetRenderTarget(renderer, nullptr);
+
+  textureValid_ = true;
+  return true;
+}
+
+void WaveformView::releaseTexture() {
+  if (texture_) {
+    SDL_DestroyTexture(texture_);
+    texture_ = nullptr;
+  }
+
+  textureRenderer_ = nullptr;
+  textureValid_ = false;
 }
 
 void WaveformView::setPosition(int x, int y) {
@@ -34,6 +180,7 @@ void WaveformView::setSize(int width, int height) {
 
 void WaveformView::setColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
   color_ = { r, g, b, a };
+  textureValid_ = false;
 }
 
 void WaveformView::setZoom(float zoom) {
@@ -41,24 +188,36 @@ void WaveformView::setZoom(float zoom) {
   dataUpdated_ = false;
 }
 
+void WaveformView::setDisplayGain(float gain) {
+  displayGain_ = std::max(0.0f, gain);
+  dataUpdated_ = false;
+}
+
 void WaveformView::setScrollOffset(int offset) {
   scrollOffset_ = std::max(0, offset);
   dataUpdated_ = false;
 }
 
+size_t WaveformView::getSourceFrameCount() const {
+  if (audioStream_) return audioStream_->getFrameCount();
+  if (audioBuffer_) return audioBuffer_->getFrameCount();
+  return 0;
+}
+
 void WaveformView::updateWaveformData() {
-  if (!audioBuffer_ || dataUpdated_) {
+  if ((!audioBuffer_ && !audioStream_) || dataUpdated_) {
     return;
   }
 
   waveformData_.clear();
   waveformData_.reserve(width_);
 
-  size_t frameCount = audioBuffer_->getFrameCount();
-  size_t channelCount = audioBuffer_->getChannelCount();
+  size_t frameCount = getSourceFrameCount();
 
   if (frameCount == 0) return;
 
+  float scale = zoom_ * displayGain_;
+
   // Calculate how many frames to skip for each pixel
   size_t framesPerPixel = std::max(1UL, frameCount / width_);
 
@@ -67,24 +226,31 @@ void WaveformView::updateWaveformData() {
 
     if (startFrame >= frameCount) break;
 
+    size_t frames = std::min(framesPerPixel, frameCount - startFrame);
+
+    // Wide pixels read the pyramid; narrow ones scan at most a base bucket.
+    // A stream's pyramid is only read as far as its scan has reached.
+    bool scanned = !audioStream_ || startFrame + frames <= scannedFrames_;
+
+    if (!peaks_.isEmpty() && scanned && frames >= PeakPyramid::kBaseBucketFrames) {
+      waveformData_.push_back(peaks_.query(startFrame, frames).rms * scale);
+      continue;
+    }
+
     // Calculate RMS value for this pixel range
     float sum = 0.0f;
     size_t count = 0;
 
-    for (size_t frame = startFrame;
-         frame < startFrame + framesPerPixel && frame < frameCount;
-         ++frame
-    ) {
-      for (size_t channel = 0; channel < channelCount; ++channel) {
-        float sample = audioBuffer_->getSample(frame, channel);
-        sum += sample * sample;
-        count++;
-      }
+    if (audioStream_) {
+      accumulateStream(startFrame, frames, sum, count);
+    }
+    else {
+      accumulateBuffer(startFrame, frames, sum, count);
     }
 
     if (count > 0) {
       float rms = std::sqrt(sum / count);
-      waveformData_.push_back(rms * zoom_);
+      waveformData_.push_back(rms * scale);
     }
     else {
       waveformData_.push_back(0.0f);
@@ -94,29 +260,73 @@ void WaveformView::updateWaveformData() {
   dataUpdated_ = true;
 }
 
-void WaveformView::drawWaveform(SDL_Renderer* renderer) {
+void WaveformView::accumulateBuffer(size_t startFrame, size_t frames, float& sum, size_t& count) const {
+  // Frames a background load has not written yet count as silence
+  if (startFrame >= loadedFrames_) return;
+
+  frames = std::min(frames, loadedFrames_ - startFrame);
+  size_t channelCount = audioBuffer_->getChannelCount();
+  ConstAudioBufferView view = audioBuffer_->getView(startFrame, frames);
+
+  if (view.isEmpty()) {
+    // Mapped storage converts per sample
+    for (size_t frame = startFrame; frame < startFrame + frames; ++frame) {
+      for (size_t channel = 0; channel < channelCount; ++channel) {
+        float sample = audioBuffer_->getSample(frame, channel);
+        sum += sample * sample;
+        count++;
+      }
+    }
+    return;
+  }
+
+  for (size_t channel = 0; channel < channelCount; ++channel) {
+    const float* samples = view.getChannelData(channel);
+    size_t stride = view.getFrameStride();
+
+    for (size_t frame = 0; frame < view.getFrameCount(); ++frame) {
+      sum += samples[frame * stride] * samples[frame * stride];
+    }
+    count += view.getFrameCount();
+  }
+}
+
+void WaveformView::accumulateStream(size_t startFrame, size_t frames, float& sum, size_t& count) {
+  // Sample a bounded window at the start of the pixel range; wide pixels
+  // only get here before the background scan has reached them
+  size_t framesToRead = std::min(frames, kMaxStreamFramesPerPixel);
+  streamBlock_.resize(framesToRead * audioStream_->getChannelCount());
+
+  audioStream_->seek(startFrame);
+  size_t framesRead = audioStream_->readFrames(streamBlock_.data(), framesToRead);
+
+  for (size_t i = 0; i < framesRead * audioStream_->getChannelCount(); ++i) {
+    sum += streamBlock_[i] * streamBlock_[i];
+    count++;
+  }
+}
+
+void WaveformView::drawWaveform(SDL_Renderer* renderer, int originX, int originY) {
   if (waveformData_.empty()) return;
 
   SDL_SetRenderDrawColor(renderer, color_.r, color_.g, color_.b, color_.a);
 
-  int centerY = y_ + height_ / 2;
+  // One rect per column spanning the bar and its center point, clipped to
+  // the view, submitted in a single call
+  int centerY = originY + height_ / 2;
+  int bottom = originY + height_ - 1;
+  int columns = std::min(static_cast<int>(waveformData_.size()), width_);
 
-  for (int x = 0; x < static_cast<int>(waveformData_.size()) && x < width_; ++x) {
-    float amplitude = waveformData_[x];
-    int barHeight = static_cast<int>(amplitude * height_ / 2);
+  bars_.clear();
+  bars_.reserve(columns);
 
-    // Draw center line
-    SDL_RenderDrawPoint(renderer, x_ + x, centerY);
+  for (int x = 0; x < columns; ++x) {
+    int barHeight = static_cast<int>(waveformData_[x] * height_ / 2);
+    int top = std::max(originY, centerY - barHeight);
+    int end = std::max(centerY, std::min(bottom, centerY + barHeight));
 
-    // Draw waveform bars
-    for (int y = 1; y <= barHeight; ++y) {
-      if (centerY + y < y_ + height_) {
-        SDL_RenderDrawPoint(renderer, x_ + x, centerY + y);
-      }
-
-      if (centerY - y >= y_) {
-        SDL_RenderDrawPoint(renderer, x_ + x, centerY - y);
-      }
-    }
+    bars_.push_back({ originX + x, top, 1, end - top + 1 });
   }
-}
\ No newline at end of file
+
+  SDL_RenderFillRects(renderer, bars_.data(), static_cast<int>(bars_.size()));
+}
@@ -82,4 +82,8 @@ void Window::setTitle(const std::string& title) {
 
 bool Window::pollEvent(SDL_Event& event) {
   return SDL_PollEvent(&event) != 0;
+}
+
+bool Window::waitForEvent(int timeoutMs) {
+  return SDL_WaitEventTimeout(nullptr, timeoutMs) != 0;
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Builds WAV file images chunk by chunk for the loader and index tests, so
+// each test states only the chunks it is about.
+namespace WavFixture {
+  using Chunk = std::pair<std::string, std::vector<uint8_t>>;
+
+  template <typename T>
+  void appendValue(std::vector<uint8_t>& bytes, T value) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+    bytes.insert(bytes.end(), p, p + sizeof(T));
+  }
+
+  // Plain "fmt " chunk body; `formatTag` 1 is PCM, 3 is float
+  inline std::vector<uint8_t> makeFormat(uint16_t formatTag, uint16_t channels, uint32_t sampleRate, uint16_t bits) {
+    std::vector<uint8_t> format;
+    appendValue<uint16_t>(format, formatTag);
+    appendValue<uint16_t>(format, channels);
+    appendValue<uint32_t>(format, sampleRate);
+    appendValue<uint32_t>(format, sampleRate * channels * bits / 8);
+    appendValue<uint16_t>(format, static_cast<uint16_t>(channels * bits / 8));
+    appendValue<uint16_t>(format, bits);
+    return format;
+  }
+
+  inline std::vector<uint8_t> makePcm16Format(uint16_t channels, uint32_t sampleRate = 44100) {
+    return makeFormat(1, channels, sampleRate, 16);
+  }
+
+  inline std::vector<uint8_t> makePcm16Data(const std::vector<int16_t>& samples) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(samples.data());
+    return std::vector<uint8_t>(p, p + samples.size() * sizeof(int16_t));
+  }
+
+  // RIFF file image of `chunks`, padding odd sizes. With `rf64` the RIFF
+  // and data sizes are left to a ds64 chunk the caller supplies.
+  inline std::vector<uint8_t> makeWav(const std::vector<Chunk>& chunks, bool rf64 = false) {
+    std::vector<uint8_t> body;
+
+    for (const Chunk& chunk : chunks) {
+      bool sizeInDs64 = rf64 && chunk.first == "data";
+
+      body.insert(body.end(), chunk.first.begin(), chunk.first.end());
+      appendValue<uint32_t>(body, sizeInDs64 ? 0xFFFFFFFF : static_cast<uint32_t>(chunk.second.size()));
+      body.insert(body.end(), chunk.second.begin(), chunk.second.end());
+
+      if (chunk.second.size() & 1) body.push_back(0);
+    }
+
+    const char* id = rf64 ? "RF64" : "RIFF";
+    std::vector<uint8_t> file(id, id + 4);
+    appendValue<uint32_t>(file, rf64 ? 0xFFFFFFFF : static_cast<uint32_t>(4 + body.size()));
+    file.insert(file.end(), { 'W', 'A', 'V', 'E' });
+    file.insert(file.end(), body.begin(), body.end());
+    return file;
+  }
+
+  inline void writeFile(const std::string& filename, const std::vector<uint8_t>& bytes) {
+    std::ofstream file(filename, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  }
+
+  inline void writeWav(const std::string& filename, const std::vector<Chunk>& chunks, bool rf64 = false) {
+    writeFile(filename, makeWav(chunks, rf64));
+  }
+}
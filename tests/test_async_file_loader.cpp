@@ -0,0 +1,99 @@
+#include "audio/AsyncFileLoader.h"
+#include "audio/AudioFileLoader.h"
+#include "WavFixture.h"
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+namespace {
+  // Stereo 16-bit PCM WAV long enough to take several worker blocks
+  void writeTestWav(const std::string& filename, size_t frames) {
+    std::vector<int16_t> samples;
+    samples.reserve(frames * 2);
+
+    for (size_t frame = 0; frame < frames; ++frame) {
+      samples.push_back(static_cast<int16_t>(frame * 7));
+      samples.push_back(static_cast<int16_t>(-static_cast<int>(frame % 1000)));
+    }
+
+    WavFixture::writeWav(filename, { { "fmt ", WavFixture::makePcm16Format(2, 48000) },
+                                     { "data", WavFixture::makePcm16Data(samples) } });
+  }
+}
+
+void testAsyncFileLoaderMatchesLoader() {
+  const std::string filename = "test_async_loader.wav";
+  const size_t frames = 200000;
+  writeTestWav(filename, frames);
+
+  AsyncFileLoader loader;
+  std::vector<size_t> progress;
+
+  assert(loader.start(filename, [&progress](size_t loaded, size_t total) {
+    assert(total == frames);
+    progress.push_back(loaded);
+  }));
+
+  // The whole buffer exists as soon as the load starts
+  assert(loader.getTotalFrames() == frames);
+  assert(loader.getBuffer()->getSampleRate() == 48000);
+
+  loader.wait();
+  assert(loader.getState() == AsyncFileLoader::State::Finished);
+  assert(loader.getLoadedFrames() == frames);
+  assert(loader.getLoadedFrameCounter()->load() == frames);
+  assert(loader.getProgress() == 1.0f);
+
+  // Several blocks, each published in order
+  assert(progress.size() > 1);
+  for (size_t i = 1; i < progress.size(); ++i) {
+    assert(progress[i] > progress[i - 1]);
+  }
+  assert(progress.back() == frames);
+
+  AudioFileLoader reference;
+  reference.setVerbose(false);
+  AudioBuffer expected;
+  assert(reference.loadWavFile(filename, expected));
+
+  const AudioBuffer& loaded = *loader.getBuffer();
+  for (size_t frame = 0; frame < frames; frame += 997) {
+    assert(loaded.getSample(frame, 0) == expected.getSample(frame, 0));
+    assert(loaded.getSample(frame, 1) == expected.getSample(frame, 1));
+  }
+
+  std::remove(filename.c_str());
+  std::cout << "✓ AsyncFileLoader matches loader test passed" << std::endl;
+}
+
+void testAsyncFileLoaderCancel() {
+  const std::string filename = "test_async_cancel.wav";
+  writeTestWav(filename, 400000);
+
+  AsyncFileLoader loader;
+  assert(loader.start(filename));
+  loader.cancel();
+
+  // The worker may have finished before the request arrived
+  AsyncFileLoader::State state = loader.getState();
+  assert(state == AsyncFileLoader::State::Cancelled || state == AsyncFileLoader::State::Finished);
+  assert(loader.getLoadedFrames() <= loader.getTotalFrames());
+
+  // A file that cannot be parsed leaves the current load alone
+  auto buffer = loader.getBuffer();
+  assert(!loader.start("test_async_missing.wav"));
+  assert(loader.getBuffer() == buffer);
+
+  // Restarting replaces the buffer and the counter
+  auto counter = loader.getLoadedFrameCounter();
+  assert(loader.start(filename));
+  assert(loader.getBuffer() != buffer);
+  assert(loader.getLoadedFrameCounter() != counter);
+  loader.wait();
+  assert(loader.getState() == AsyncFileLoader::State::Finished);
+
+  std::remove(filename.c_str());
+  std::cout << "✓ AsyncFileLoader cancel test passed" << std::endl;
+}
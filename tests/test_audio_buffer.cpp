@@ -1,6 +1,7 @@
 #include "audio/AudioBuffer.h"
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
 
 void testAudioBufferConstruction() {
@@ -114,3 +115,117 @@ void testAudioBufferMix() {
 
   std::cout << "✓ AudioBuffer mix test passed" << std::endl;
 }
+
+void testAudioBufferSharedStorage() {
+  AudioBuffer buffer(44100, 2);
+
+  buffer.resize(100);
+  buffer.setSample(10, 0, 0.25f);
+
+  // Copies share samples until one side writes
+  AudioBuffer copy(buffer);
+  const AudioBuffer& original = buffer;
+  const AudioBuffer& shared = copy;
+  assert(buffer.isShared() && copy.isShared());
+  assert(shared.getData() == original.getData());
+
+  copy.setSample(10, 0, 0.75f);
+  assert(!buffer.isShared() && !copy.isShared());
+  assert(std::abs(buffer.getSample(10, 0) - 0.25f) < 0.001f);
+  assert(std::abs(copy.getSample(10, 0) - 0.75f) < 0.001f);
+
+  // Moving hands over the storage and leaves an empty buffer behind
+  const float* data = shared.getData();
+  AudioBuffer moved(std::move(copy));
+  assert(static_cast<const AudioBuffer&>(moved).getData() == data);
+  assert(moved.getFrameCount() == 100);
+  assert(copy.getFrameCount() == 0);
+
+  copy = std::move(moved);
+  assert(copy.getFrameCount() == 100 && moved.getFrameCount() == 0);
+
+  moved.resize(10);
+  assert(moved.getFrameCount() == 10 && moved.getSample(5, 1) == 0.0f);
+
+  std::cout << "✓ AudioBuffer shared storage test passed" << std::endl;
+}
+
+void testAudioBufferView() {
+  AudioBuffer buffer(44100, 3);
+
+  buffer.resize(8);
+
+  for (size_t frame = 0; frame < 8; ++frame) {
+    for (size_t channel = 0; channel < 3; ++channel) {
+      buffer.setSample(frame, channel, frame * 10.0f + channel);
+    }
+  }
+
+  AudioBufferView view = buffer.getView(2, 4);
+  assert(view.getFrameCount() == 4 && view.getChannelCount() == 3 && view.isContiguous());
+  assert(view.at(0, 1) == 21.0f);
+
+  // A single channel keeps the interleaved stride
+  AudioBufferView channel = view.getChannel(2);
+  assert(channel.getChannelCount() == 1 && channel.getFrameStride() == 3 && !channel.isContiguous());
+  assert(channel.at(3, 0) == 52.0f);
+
+  channel.at(0, 0) = -1.0f;
+  assert(buffer.getSample(2, 2) == -1.0f);
+
+  // Ranges are clamped to the view
+  ConstAudioBufferView tail = static_cast<const AudioBuffer&>(buffer).getView(6, 100);
+  assert(tail.getFrameCount() == 2 && tail.at(1, 0) == 70.0f);
+  assert(buffer.getView(100, 1).isEmpty());
+
+  std::cout << "✓ AudioBuffer view test passed" << std::endl;
+}
+
+void testAudioBufferPlanarLayout() {
+  AudioBuffer buffer(44100, 2, SampleLayout::Planar);
+
+  buffer.resize(100);
+
+  for (size_t frame = 0; frame < 100; ++frame) {
+    buffer.setSample(frame, 0, frame * 0.01f);
+    buffer.setSample(frame, 1, -0.5f);
+  }
+
+  // Each channel is a contiguous, aligned run
+  size_t stride = buffer.getChannelStride();
+  assert(stride >= 100 && stride % (kSampleAlignment / sizeof(float)) == 0);
+  assert(reinterpret_cast<uintptr_t>(buffer.getData()) % kSampleAlignment == 0);
+  assert(buffer.getData()[stride + 10] == -0.5f);
+
+  AudioBufferView view = buffer.getView();
+  assert(view.isPlanar() && !view.isContiguous());
+  assert(std::abs(view.at(42, 0) - 0.42f) < 0.0001f);
+
+  // Converting to interleaved for the output path
+  float interleaved[20];
+  copyFrames(buffer.getView(10, 10), AudioBufferView(interleaved, 10, 2), 2.0f);
+  assert(std::abs(interleaved[0] - 0.2f) < 0.0001f && interleaved[1] == -1.0f);
+
+  // Growing keeps the samples and the padding silent
+  buffer.resize(130);
+  assert(std::abs(buffer.getSample(99, 0) - 0.99f) < 0.0001f && buffer.getSample(120, 1) == 0.0f);
+  buffer.resize(100);
+  assert(std::abs(buffer.getRMSAmplitude() - AudioBuffer(buffer).getRMSAmplitude()) < 1e-6f);
+
+  // Layout changes round trip
+  AudioBuffer copy(buffer);
+  copy.setLayout(SampleLayout::Interleaved);
+  assert(copy.getLayout() == SampleLayout::Interleaved && buffer.getLayout() == SampleLayout::Planar);
+  assert(copy.getData()[2 * 42] == buffer.getSample(42, 0));
+
+  copy.mix(buffer, 1.0f);
+  assert(copy.getSample(42, 1) == -0.5f);
+
+  copy.setLayout(SampleLayout::Planar);
+  for (size_t frame = 0; frame < 100; ++frame) {
+    assert(copy.getSample(frame, 0) == buffer.getSample(frame, 0));
+    assert(copy.getSample(frame, 1) == buffer.getSample(frame, 1));
+  }
+
+  std::cout << "✓ AudioBuffer planar layout test passed" << std::endl;
+}
@@ -0,0 +1,310 @@
+#include "audio/AudioFileLoader.h"
+#include "audio/AsyncFileLoader.h"
+#include "audio/WavStreamReader.h"
+#include "WavFixture.h"
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+  using WavFixture::appendValue;
+  using WavFixture::writeWav;
+
+  // Writes a 16-bit PCM WAV with an extra chunk before "data"
+  void writeTestWav(const std::string& filename, const std::vector<int16_t>& samples, uint16_t channels) {
+    writeWav(filename, { { "fmt ", WavFixture::makePcm16Format(channels, 22050) },
+                         { "junk", std::vector<uint8_t>(4) },
+                         { "data", WavFixture::makePcm16Data(samples) } });
+  }
+
+  // WAVE_FORMAT_EXTENSIBLE format chunk; `formatTag` selects PCM or float
+  std::vector<uint8_t> makeExtensibleFormat(uint16_t channels, uint16_t bits, uint16_t validBits,
+                                            uint32_t channelMask, uint16_t formatTag) {
+    static const uint8_t suffix[14] = {
+      0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+    };
+    std::vector<uint8_t> format;
+
+    appendValue<uint16_t>(format, 0xFFFE);
+    appendValue<uint16_t>(format, channels);
+    appendValue<uint32_t>(format, 48000);
+    appendValue<uint32_t>(format, 48000u * channels * bits / 8);
+    appendValue<uint16_t>(format, static_cast<uint16_t>(channels * bits / 8));
+    appendValue<uint16_t>(format, bits);
+    appendValue<uint16_t>(format, 22);
+    appendValue<uint16_t>(format, validBits);
+    appendValue<uint32_t>(format, channelMask);
+    appendValue<uint16_t>(format, formatTag);
+    format.insert(format.end(), suffix, suffix + sizeof(suffix));
+    return format;
+  }
+
+  // Packed 24-bit samples of `values`
+  std::vector<uint8_t> makePcm24(const std::vector<int32_t>& values) {
+    std::vector<uint8_t> bytes;
+
+    for (int32_t value : values) {
+      for (int shift = 0; shift < 24; shift += 8) {
+        bytes.push_back(static_cast<uint8_t>(static_cast<uint32_t>(value) >> shift));
+      }
+    }
+    return bytes;
+  }
+
+  std::vector<int16_t> makeTestSamples() {
+    std::vector<int16_t> samples;
+
+    for (int i = 0; i < 1000; ++i) {
+      samples.push_back(static_cast<int16_t>(i * 16));
+      samples.push_back(static_cast<int16_t>(-i * 16));
+    }
+    return samples;
+  }
+}
+
+void testAudioFileLoaderFileInfo() {
+  const std::string filename = "test_loader_info.wav";
+  writeTestWav(filename, makeTestSamples(), 2);
+
+  AudioFileLoader loader;
+  int sampleRate = 0, channels = 0, frameCount = 0;
+
+  assert(loader.canLoadFile(filename));
+  assert(loader.getFileInfo(filename, sampleRate, channels, frameCount));
+  assert(sampleRate == 22050);
+  assert(channels == 2);
+  assert(frameCount == 1000);
+
+  WavInfo info;
+  assert(loader.getWavInfo(filename, info));
+  assert(info.dataOffset == 12 + 24 + 12 + 8);
+
+  std::remove(filename.c_str());
+  std::cout << "✓ AudioFileLoader file info test passed" << std::endl;
+}
+
+void testAudioFileLoaderBuffered() {
+  const std::string filename = "test_loader_buffered.wav";
+  writeTestWav(filename, makeTestSamples(), 2);
+
+  AudioFileLoader loader;
+  AudioBuffer buffer;
+
+  assert(loader.loadWavFile(filename, buffer));
+  assert(!buffer.isMapped());
+  assert(buffer.getSampleRate() == 22050);
+  assert(buffer.getFrameCount() == 1000);
+  assert(std::abs(buffer.getSample(500, 0) - 8000.0f / 32768.0f) < 0.0001f);
+  assert(std::abs(buffer.getSample(500, 1) + 8000.0f / 32768.0f) < 0.0001f);
+
+  std::remove(filename.c_str());
+  std::cout << "✓ AudioFileLoader buffered load test passed" << std::endl;
+}
+
+void testAudioFileLoaderMapped() {
+  const std::string filename = "test_loader_mapped.wav";
+  writeTestWav(filename, makeTestSamples(), 2);
+
+  AudioFileLoader loader;
+  loader.setLoadMode(AudioFileLoader::LoadMode::Mapped);
+
+  AudioBuffer buffer;
+
+  assert(loader.loadWavFile(filename, buffer));
+  assert(buffer.isMapped());
+  assert(buffer.getFrameCount() == 1000);
+  assert(std::abs(buffer.getSample(500, 0) - 8000.0f / 32768.0f) < 0.0001f);
+  assert(std::abs(buffer.getPeakAmplitude() - 999.0f * 16.0f / 32768.0f) < 0.0001f);
+
+  float peak, rms;
+  buffer.getLevels(peak, rms);
+  assert(peak == buffer.getPeakAmplitude() && rms == buffer.getRMSAmplitude());
+
+  // Copies share the mapping; modifying one converts only that copy
+  AudioBuffer copy(buffer);
+  copy.applyGain(0.5f);
+  assert(!copy.isMapped());
+  assert(buffer.isMapped());
+  assert(std::abs(copy.getSample(500, 0) - 4000.0f / 32768.0f) < 0.0001f);
+  assert(std::abs(buffer.getSample(500, 0) - 8000.0f / 32768.0f) < 0.0001f);
+
+  std::remove(filename.c_str());
+  std::cout << "✓ AudioFileLoader mapped load test passed" << std::endl;
+}
+
+void testWavStreamReaderBlocks() {
+  const std::string filename = "test_loader_stream.wav";
+  writeTestWav(filename, makeTestSamples(), 2);
+
+  WavStreamReader reader(256);
+
+  assert(reader.open(filename));
+  assert(reader.getFrameCount() == 1000);
+  assert(reader.getChannelCount() == 2);
+
+  // Fixed-size blocks with a short final block
+  std::vector<float> block;
+  size_t totalFrames = 0;
+  size_t framesRead;
+
+  while ((framesRead = reader.readBlock(block)) > 0) {
+    assert(framesRead <= 256);
+    assert(block.size() == framesRead * 2);
+    totalFrames += framesRead;
+  }
+  assert(totalFrames == 1000);
+  assert(reader.tell() == 1000);
+
+  // Seeking
+  assert(reader.seek(500));
+  float frame[2];
+  assert(reader.readFrames(frame, 1) == 1);
+  assert(std::abs(frame[0] - 8000.0f / 32768.0f) < 0.0001f);
+  assert(std::abs(frame[1] + 8000.0f / 32768.0f) < 0.0001f);
+  assert(reader.tell() == 501);
+
+  assert(reader.seek(5000));
+  assert(reader.tell() == 1000);
+  assert(reader.readFrames(frame, 1) == 0);
+
+  reader.close();
+  std::remove(filename.c_str());
+  std::cout << "✓ WavStreamReader block read test passed" << std::endl;
+}
+
+void testAudioFileLoaderExtensible() {
+  const std::string filename = "test_loader_extensible.wav";
+
+  // 3 channels of 20-bit audio in 24-bit containers, behind an odd-sized
+  // chunk whose pad byte must be skipped
+  std::vector<int32_t> values;
+
+  for (int32_t i = 0; i < 100; ++i) {
+    values.push_back(i * 16 * 1000);
+    values.push_back(-i * 16 * 1000);
+    values.push_back(8388607);
+  }
+
+  writeWav(filename, {
+    { "fmt ", makeExtensibleFormat(3, 24, 20, 0x7, 1) },
+    { "odd ", { 1, 2, 3 } },
+    { "data", makePcm24(values) },
+  });
+
+  AudioFileLoader loader;
+  loader.setVerbose(false);
+  WavInfo info;
+
+  assert(loader.getWavInfo(filename, info));
+  assert(info.audioFormat == 0xFFFE);
+  assert(info.sampleFormat == SampleFormat::Int24);
+  assert(info.channelMask == 0x7);
+  assert(info.frameCount == 100);
+  assert(!info.isRF64);
+
+  for (AudioFileLoader::LoadMode mode : { AudioFileLoader::LoadMode::Buffered, AudioFileLoader::LoadMode::Mapped }) {
+    loader.setLoadMode(mode);
+    AudioBuffer buffer;
+
+    assert(loader.loadWavFile(filename, buffer));
+    assert(buffer.getChannelCount() == 3);
+    assert(buffer.getFrameCount() == 100);
+    assert(std::abs(buffer.getSample(50, 0) - 800000.0f / 8388608.0f) < 1e-6f);
+    assert(std::abs(buffer.getSample(50, 1) + 800000.0f / 8388608.0f) < 1e-6f);
+    assert(std::abs(buffer.getSample(99, 2) - 8388607.0f / 8388608.0f) < 1e-6f);
+  }
+
+  // Float sub-format
+  std::vector<uint8_t> floats;
+
+  for (float sample : { 0.5f, -0.25f, 1.5f, 0.0f }) {
+    appendValue<float>(floats, sample);
+  }
+
+  writeWav(filename, { { "fmt ", makeExtensibleFormat(2, 32, 32, 0x3, 3) }, { "data", floats } });
+  loader.setLoadMode(AudioFileLoader::LoadMode::Buffered);
+  AudioBuffer buffer;
+
+  assert(loader.loadWavFile(filename, buffer));
+  assert(buffer.getFrameCount() == 2);
+  assert(buffer.getSample(0, 0) == 0.5f && buffer.getSample(0, 1) == -0.25f);
+  assert(buffer.getSample(1, 0) == 1.5f);      // Float files may exceed full scale
+
+  // 8-bit PCM is not supported
+  writeWav(filename, { { "fmt ", makeExtensibleFormat(1, 8, 8, 0x4, 1) }, { "data", { 0x80, 0x80 } } });
+  assert(!loader.getWavInfo(filename, info));
+
+  std::remove(filename.c_str());
+  std::cout << "✓ AudioFileLoader extensible format test passed" << std::endl;
+}
+
+void testAudioFileLoaderRF64() {
+  const std::string filename = "test_loader_rf64.wav";
+
+  std::vector<int32_t> values;
+
+  for (int32_t i = 0; i < 64; ++i) {
+    values.push_back(i * 100000);
+  }
+  std::vector<uint8_t> data = makePcm24(values);
+
+  // Sizes live in ds64; the 32-bit data size field is 0xFFFFFFFF
+  std::vector<uint8_t> ds64;
+  appendValue<uint64_t>(ds64, 4 + 36 + 24 + 8 + data.size());
+  appendValue<uint64_t>(ds64, data.size());
+  appendValue<uint64_t>(ds64, values.size());
+  appendValue<uint32_t>(ds64, 0);
+
+  std::vector<uint8_t> format = WavFixture::makeFormat(1, 1, 96000, 24);
+
+  writeWav(filename, { { "ds64", ds64 }, { "fmt ", format }, { "data", data } }, true);
+
+  AudioFileLoader loader;
+  loader.setVerbose(false);
+  WavInfo info;
+
+  assert(loader.canLoadFile(filename));
+  assert(loader.getWavInfo(filename, info));
+  assert(info.isRF64);
+  assert(info.dataSize == data.size());
+  assert(info.frameCount == 64);
+
+  AudioBuffer buffer;
+  assert(loader.loadWavFile(filename, buffer));
+  assert(buffer.getSampleRate() == 96000);
+  assert(std::abs(buffer.getSample(63, 0) - 6300000.0f / 8388608.0f) < 1e-6f);
+
+  WavStreamReader reader;
+  float frame;
+  assert(reader.open(filename) && reader.seek(10));
+  assert(reader.readFrames(&frame, 1) == 1);
+  assert(std::abs(frame - 1000000.0f / 8388608.0f) < 1e-6f);
+  reader.close();
+
+  // Without ds64 the data size is unknown
+  writeWav(filename, { { "fmt ", format }, { "data", data } }, true);
+  assert(!loader.getWavInfo(filename, info));
+
+  // A ds64 data size past the end of the file is rejected before anything
+  // is allocated for it
+  std::vector<uint8_t> hugeDs64;
+  appendValue<uint64_t>(hugeDs64, 1ULL << 40);
+  appendValue<uint64_t>(hugeDs64, 1ULL << 40);
+  appendValue<uint64_t>(hugeDs64, (1ULL << 40) / 3);
+  appendValue<uint32_t>(hugeDs64, 0);
+  writeWav(filename, { { "ds64", hugeDs64 }, { "fmt ", format }, { "data", data } }, true);
+
+  assert(!loader.loadWavFile(filename, buffer));
+  loader.setLoadMode(AudioFileLoader::LoadMode::Mapped);
+  assert(!loader.loadWavFile(filename, buffer));
+
+  AsyncFileLoader asyncLoader;
+  assert(!asyncLoader.start(filename));
+
+  std::remove(filename.c_str());
+  std::cout << "✓ AudioFileLoader RF64 test passed" << std::endl;
+}
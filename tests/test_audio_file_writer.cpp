@@ -0,0 +1,227 @@
+#include "audio/AudioFileWriter.h"
+#include "audio/AudioFileLoader.h"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+namespace {
+  std::vector<uint8_t> readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  uint64_t getValue(const uint8_t* p, size_t bytes) {
+    uint64_t value = 0;
+
+    for (size_t i = 0; i < bytes; ++i) {
+      value |= static_cast<uint64_t>(p[i]) << (8 * i);
+    }
+    return value;
+  }
+
+  // Offset of a top-level chunk's payload, or 0 if absent
+  size_t findChunk(const std::vector<uint8_t>& file, const char* id) {
+    for (size_t offset = 12; offset + 8 <= file.size();) {
+      uint64_t size = getValue(&file[offset + 4], 4);
+
+      if (std::memcmp(&file[offset], id, 4) == 0) return offset + 8;
+      offset += 8 + size + (size & 1);
+    }
+    return 0;
+  }
+}
+
+void testAudioFileWriterRoundTrip() {
+  const std::string filename = "test_writer_roundtrip.wav";
+
+  for (SampleLayout layout : { SampleLayout::Interleaved, SampleLayout::Planar }) {
+    AudioBuffer buffer(48000, 3, layout);
+    buffer.resize(40000);
+
+    for (size_t frame = 0; frame < buffer.getFrameCount(); ++frame) {
+      for (size_t channel = 0; channel < 3; ++channel) {
+        buffer.setSample(frame, channel, std::sin(0.001f * frame * (channel + 1)) * 0.8f);
+      }
+    }
+    buffer.setSample(7, 0, 1.5f);   // Clipped on write
+
+    AudioFileWriter writer;
+    assert(writer.writeWavFile(filename, buffer));
+
+    AudioFileLoader loader;
+    loader.setVerbose(false);
+    AudioBuffer loaded;
+    assert(loader.loadWavFile(filename, loaded));
+    assert(loaded.getSampleRate() == 48000);
+    assert(loaded.getChannelCount() == 3);
+    assert(loaded.getFrameCount() == 40000);
+
+    for (size_t frame = 0; frame < loaded.getFrameCount(); frame += 13) {
+      for (size_t channel = 0; channel < 3; ++channel) {
+        float expected = std::max(-1.0f, std::min(1.0f, buffer.getSample(frame, channel)));
+        // Rounding plus up to one LSB of dither
+        assert(std::abs(loaded.getSample(frame, channel) - expected) <= 1.5f / 32768.0f);
+      }
+    }
+    assert(std::abs(loaded.getSample(7, 0) - 1.0f) <= 1.0f / 32768.0f);
+  }
+
+  std::remove(filename.c_str());
+  std::cout << "✓ AudioFileWriter round trip test passed" << std::endl;
+}
+
+void testAudioFileWriterFormats() {
+  const std::string filename = "test_writer_formats.wav";
+  const size_t frames = 1001;     // Odd, so 24-bit mono needs a pad byte
+
+  AudioBuffer buffer(44100, 1);
+  buffer.resize(frames);
+
+  for (size_t frame = 0; frame < frames; ++frame) {
+    buffer.setSample(frame, 0, std::sin(0.01f * frame) * 0.9f);
+  }
+
+  for (SampleFormat format : { SampleFormat::Int16, SampleFormat::Int24, SampleFormat::Int32, SampleFormat::Float32 }) {
+    AudioFileWriter writer;
+    writer.setSampleFormat(format);
+    writer.setDither(false);
+    assert(writer.writeWavFile(filename, buffer));
+    assert(!writer.isRF64());
+
+    std::vector<uint8_t> file = readFile(filename);
+    size_t bytesPerSample = SampleConversion::getBytesPerSample(format);
+    size_t fmt = findChunk(file, "fmt ");
+    size_t data = findChunk(file, "data");
+
+    assert(std::memcmp(file.data(), "RIFF", 4) == 0 && std::memcmp(file.data() + 8, "WAVE", 4) == 0);
+    assert(getValue(&file[4], 4) == file.size() - 8);
+    assert(file.size() % 2 == 0);
+    assert(fmt != 0 && data != 0);
+    assert(getValue(&file[fmt], 2) == (format == SampleFormat::Float32 ? 3u : 1u));
+    assert(getValue(&file[fmt + 2], 2) == 1);
+    assert(getValue(&file[fmt + 4], 4) == 44100);
+    assert(getValue(&file[fmt + 12], 2) == bytesPerSample);
+    assert(getValue(&file[fmt + 14], 2) == bytesPerSample * 8);
+    assert(getValue(&file[data - 4], 4) == frames * bytesPerSample);
+
+    if (format == SampleFormat::Float32) {
+      size_t fact = findChunk(file, "fact");
+      assert(fact != 0 && getValue(&file[fact], 4) == frames);
+    }
+
+    // Samples decode back to the source within the format's resolution
+    std::vector<float> decoded(frames);
+    SampleConversion::toFloat(format, &file[data], decoded.data(), frames);
+
+    for (size_t frame = 0; frame < frames; ++frame) {
+      float tolerance = format == SampleFormat::Int16 ? 0.5f / 32768.0f : 1e-6f;
+      assert(std::abs(decoded[frame] - buffer.getSample(frame, 0)) <= tolerance);
+    }
+
+    // The loader reads every format back, buffered and mapped
+    for (AudioFileLoader::LoadMode mode : { AudioFileLoader::LoadMode::Buffered, AudioFileLoader::LoadMode::Mapped }) {
+      AudioFileLoader loader;
+      loader.setVerbose(false);
+      loader.setLoadMode(mode);
+      AudioBuffer loaded;
+
+      assert(loader.loadWavFile(filename, loaded));
+      assert(loaded.getFrameCount() == frames);
+
+      for (size_t frame = 0; frame < frames; ++frame) {
+        assert(loaded.getSample(frame, 0) == decoded[frame]);
+      }
+    }
+  }
+
+  std::remove(filename.c_str());
+  std::cout << "✓ AudioFileWriter formats test passed" << std::endl;
+}
+
+void testAudioFileWriterStreaming() {
+  const std::string whole = "test_writer_whole.wav";
+  const std::string streamed = "test_writer_streamed.wav";
+  const size_t channels = 3;
+  const size_t frames = 50000;
+
+  std::vector<float> samples(frames * channels);
+
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = std::sin(0.003f * i) * 0.7f;
+  }
+
+  AudioBuffer buffer(48000, channels);
+  buffer.resize(frames);
+  std::memcpy(buffer.getData(), samples.data(), samples.size() * sizeof(float));
+
+  AudioFileWriter reference;
+  reference.setSampleFormat(SampleFormat::Int24);
+  reference.setDither(false);
+  assert(reference.writeWavFile(whole, buffer));
+
+  // Appending uneven blocks through a small buffer, with and without direct
+  // I/O, gives the same file as one write
+  for (bool direct : { false, true }) {
+    AudioFileWriter writer;
+    writer.setSampleFormat(SampleFormat::Int24);
+    writer.setDither(false);
+    writer.setBufferSize(5000);
+    writer.setDirectIo(direct);
+    assert(writer.getBufferSize() == 8192);
+
+    assert(writer.open(streamed, 48000, channels));
+    assert(writer.isOpen());
+
+    for (size_t frame = 0; frame < frames;) {
+      size_t block = std::min<size_t>(frames - frame, 997 + frame % 3001);
+      assert(writer.write(samples.data() + frame * channels, block));
+      frame += block;
+    }
+
+    assert(writer.getFramesWritten() == frames);
+    assert(!writer.write(ConstAudioBufferView(samples.data(), 10, 2)));
+    assert(writer.close());
+    assert(!writer.isOpen());
+    assert(readFile(streamed) == readFile(whole));
+  }
+
+  std::remove(whole.c_str());
+  std::remove(streamed.c_str());
+  std::cout << "✓ AudioFileWriter streaming test passed" << std::endl;
+}
+
+void testAudioFileWriterRF64Header() {
+  const std::string filename = "test_writer_rf64.wav";
+
+  AudioFileWriter writer;
+  writer.setSampleFormat(SampleFormat::Int24);
+  assert(writer.open(filename, 96000, 2));
+
+  // Small data keeps the JUNK placeholder and 32-bit sizes
+  std::vector<uint8_t> header = writer.buildHeader(600);
+  assert(std::memcmp(header.data(), "RIFF", 4) == 0);
+  assert(std::memcmp(header.data() + 12, "JUNK", 4) == 0);
+  assert(getValue(&header[4], 4) == header.size() - 8 + 600);
+
+  // Past 4 GiB the placeholder becomes ds64 and the 32-bit sizes are unused
+  const uint64_t dataSize = 6ULL * 1024 * 1024 * 1024;
+  header = writer.buildHeader(dataSize);
+  assert(std::memcmp(header.data(), "RF64", 4) == 0);
+  assert(getValue(&header[4], 4) == 0xFFFFFFFFu);
+  assert(std::memcmp(header.data() + 12, "ds64", 4) == 0);
+  assert(getValue(&header[16], 4) == 28);
+  assert(getValue(&header[20], 8) == header.size() - 8 + dataSize);
+  assert(getValue(&header[28], 8) == dataSize);
+  assert(getValue(&header[36], 8) == dataSize / 6);
+  assert(std::memcmp(&header[header.size() - 8], "data", 4) == 0);
+  assert(getValue(&header[header.size() - 4], 4) == 0xFFFFFFFFu);
+
+  assert(writer.close());
+  std::remove(filename.c_str());
+  std::cout << "✓ AudioFileWriter RF64 header test passed" << std::endl;
+}
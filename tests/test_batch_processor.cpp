@@ -0,0 +1,100 @@
+#include "audio/BatchProcessor.h"
+#include "audio/AudioFileLoader.h"
+#include "audio/AudioFileWriter.h"
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+void testBatchProcessorParseChain() {
+  std::vector<BatchProcessor::Step> steps;
+  std::string error;
+
+  assert(BatchProcessor::parseChain("gain=0.5,normalize=-6dB,gain=-6 dB,normalize", steps, error));
+  assert(steps.size() == 4);
+  assert(steps[0].type == BatchProcessor::Step::Type::Gain && steps[0].value == 0.5f);
+  assert(steps[1].type == BatchProcessor::Step::Type::Normalize);
+  assert(std::abs(steps[1].value - 0.501187f) < 1e-5f);
+  assert(std::abs(steps[2].value - 0.501187f) < 1e-5f);
+  assert(steps[3].value == 1.0f);
+
+  assert(!BatchProcessor::parseChain("", steps, error));
+  assert(!BatchProcessor::parseChain("reverb", steps, error));
+  assert(!BatchProcessor::parseChain("gain", steps, error));
+  assert(!BatchProcessor::parseChain("gain=-2", steps, error));
+  assert(!BatchProcessor::parseChain("normalize=loud", steps, error));
+
+  std::cout << "✓ BatchProcessor chain parsing test passed" << std::endl;
+}
+
+void testBatchProcessorRun() {
+  fs::path directory = "test_batch_input";
+  fs::path output = "test_batch_output";
+  fs::remove_all(directory);
+  fs::remove_all(output);
+  fs::create_directories(directory / "nested");
+
+  // Files of different lengths and levels; one is not audio at all
+  AudioFileWriter writer;
+  const char* names[] = { "a.wav", "b.wav", "nested/c.WAV" };
+
+  for (size_t i = 0; i < 3; ++i) {
+    AudioBuffer buffer(44100, 2);
+    buffer.resize(1000 * (i + 1));
+
+    for (size_t frame = 0; frame < buffer.getFrameCount(); ++frame) {
+      buffer.setSample(frame, 0, 0.1f * (i + 1));
+      buffer.setSample(frame, 1, -0.05f * (i + 1));
+    }
+    assert(writer.writeWavFile((directory / names[i]).string(), buffer));
+  }
+  std::ofstream(directory / "junk.wav") << "not a RIFF file";
+
+  std::vector<std::string> pattern = BatchProcessor::expandInputs({ (directory / "?.wav").string() });
+  assert(pattern.size() == 2);
+
+  std::vector<std::string> inputs = BatchProcessor::expandInputs({ directory.string() });
+  assert(inputs.size() == 4);
+
+  BatchProcessor::Options options;
+  std::string error;
+  assert(BatchProcessor::parseChain("gain=2,normalize=-6dB", options.steps, error));
+  options.outputDirectory = output.string();
+  options.suffix = "";
+  options.threads = 3;
+  options.memoryBudget = 1;   // Every file exceeds it, so they run one at a time
+
+  size_t reported = 0;
+  options.onFileDone = [&reported](const BatchProcessor::Result&) { ++reported; };
+
+  BatchProcessor processor(options);
+  std::vector<BatchProcessor::Result> results = processor.run(inputs);
+  assert(results.size() == 4 && reported == 4);
+
+  AudioFileLoader loader;
+  loader.setVerbose(false);
+
+  for (const auto& result : results) {
+    if (fs::path(result.input).filename() == "junk.wav") {
+      assert(!result.success && !fs::exists(result.output));
+      continue;
+    }
+
+    assert(result.success);
+    assert(fs::path(result.output).parent_path() == output);
+
+    AudioBuffer processed;
+    assert(loader.loadWavFile(result.output, processed));
+    assert(std::abs(processed.getPeakAmplitude() - 0.501187f) < 1e-3f);
+    assert(std::abs(processed.getSample(10, 1) + 0.2506f) < 1e-3f);
+  }
+
+  assert(!fs::exists(output / "a.wav.part"));
+
+  fs::remove_all(directory);
+  fs::remove_all(output);
+  std::cout << "✓ BatchProcessor run test passed" << std::endl;
+}
@@ -0,0 +1,95 @@
+#include "audio/CallbackStats.h"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+void testCallbackStatsRecording() {
+  CallbackStats stats;
+  stats.reset(480, 48000);   // 10 ms period
+
+  CallbackStats::Snapshot snapshot = stats.getSnapshot();
+  assert(snapshot.periodNs == 10000000);
+  assert(snapshot.callbacks == 0);
+  assert(snapshot.getLoadPercentile(99.0) == 0.0);
+
+  const uint64_t period = snapshot.periodNs;
+
+  // 98 callbacks at 10% load, one at 60%, one overrun that also came late
+  for (int i = 0; i < 98; ++i) {
+    stats.record(period / 10, period);
+  }
+  stats.record(period * 6 / 10, period);
+  stats.record(period * 3, period * 2);
+
+  snapshot = stats.getSnapshot();
+  assert(snapshot.callbacks == 100);
+  assert(snapshot.overruns == 1);
+  assert(snapshot.lateCallbacks == 1);
+  assert(snapshot.getXruns() == 2);
+  assert(snapshot.maxDurationNs == period * 3);
+  assert(snapshot.maxIntervalNs == period * 2);
+
+  assert(snapshot.histogram[2] == 98);
+  assert(snapshot.histogram[12] == 1);
+  assert(snapshot.histogram[CallbackStats::kBucketCount - 1] == 1);
+
+  assert(std::abs(snapshot.getMaxLoad() - 3.0) < 1e-6);
+  assert(std::abs(snapshot.getMinHeadroom() + 2.0) < 1e-6);
+  assert(std::abs(snapshot.getLoadPercentile(50.0) - 0.15) < 1e-9);
+  assert(std::abs(snapshot.getLoadPercentile(99.0) - 0.65) < 1e-9);
+  assert(std::abs(snapshot.getLoadPercentile(100.0) - 3.0) < 1e-6);
+
+  // Offline blocks carry no interval and are never late
+  stats.record(period / 10, 0);
+  assert(stats.getSnapshot().lateCallbacks == 1);
+
+  // The late start that follows an overrun is the same xrun, counted once
+  stats.record(period * 3 / 2, period);
+  stats.record(period / 10, period * 2);
+  snapshot = stats.getSnapshot();
+  assert(snapshot.overruns == 2 && snapshot.lateCallbacks == 1);
+
+  std::ostringstream report;
+  stats.getSnapshot().write(report);
+  assert(report.str().find("xruns: 3") != std::string::npos);
+  assert(report.str().find(">=200.0: 1") != std::string::npos);
+
+  stats.reset(512, 48000);
+  snapshot = stats.getSnapshot();
+  assert(snapshot.callbacks == 0 && snapshot.getXruns() == 0 && snapshot.maxDurationNs == 0);
+  assert(snapshot.histogram[2] == 0);
+
+  std::cout << "✓ CallbackStats recording test passed" << std::endl;
+}
+
+void testCallbackStatsConcurrentReads() {
+  const int kCallbacks = 100000;
+  CallbackStats stats;
+  stats.reset(1000000);
+
+  // One writer as on the audio thread, snapshots taken meanwhile
+  std::thread writer([&stats]() {
+    for (int i = 0; i < kCallbacks; ++i) {
+      stats.record(500000, 1000000);
+    }
+  });
+
+  uint64_t last = 0;
+
+  while (last < kCallbacks) {
+    CallbackStats::Snapshot snapshot = stats.getSnapshot();
+    assert(snapshot.callbacks >= last);
+    assert(snapshot.getXruns() == 0);
+    last = snapshot.callbacks;
+  }
+
+  writer.join();
+
+  CallbackStats::Snapshot snapshot = stats.getSnapshot();
+  assert(snapshot.histogram[CallbackStats::kBucketsPerPeriod / 2] == kCallbacks);
+  assert(std::abs(snapshot.getAverageLoad() - 0.5) < 1e-9);
+
+  std::cout << "✓ CallbackStats concurrent reads test passed" << std::endl;
+}
@@ -0,0 +1,111 @@
+#include "audio/ChannelMixer.h"
+#include "audio/CpuFeatures.h"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace {
+  bool near(float a, float b) {
+    return std::abs(a - b) < 1e-5f;
+  }
+}
+
+void testChannelMixerDefaults() {
+  const float fold = 0.70710678f;
+
+  // Mono plays on both sides of stereo
+  ChannelMixer upmix(1, 2);
+  std::vector<float> mono = { 0.5f, -0.25f };
+  std::vector<float> stereo(4);
+  upmix.process(mono.data(), stereo.data(), 2);
+  assert(near(stereo[0], 0.5f) && near(stereo[1], 0.5f));
+  assert(near(stereo[2], -0.25f) && near(stereo[3], -0.25f));
+
+  // Stereo to mono averages the two sides
+  ChannelMixer downmix(2, 1);
+  std::vector<float> out(2);
+  downmix.process(stereo.data(), out.data(), 2);
+  assert(near(out[0], 0.5f) && near(out[1], -0.25f));
+
+  // 5.1 to stereo: centre and surrounds fold in at -3 dB, LFE is dropped
+  ChannelMixer surround(6, 2);
+  assert(near(surround.getGain(0, 0), 1.0f) && near(surround.getGain(0, 1), 0.0f));
+  assert(near(surround.getGain(0, 2), fold) && near(surround.getGain(1, 2), fold));
+  assert(near(surround.getGain(0, 3), 0.0f) && near(surround.getGain(1, 3), 0.0f));
+  assert(near(surround.getGain(0, 4), fold) && near(surround.getGain(1, 4), 0.0f));
+  assert(near(surround.getGain(1, 5), fold) && near(surround.getGain(0, 5), 0.0f));
+
+  // Stereo into 5.1 stays on the front pair
+  ChannelMixer wide(2, 6);
+  assert(near(wide.getGain(0, 0), 1.0f) && near(wide.getGain(1, 1), 1.0f));
+  assert(near(wide.getGain(2, 0), 0.0f) && near(wide.getGain(4, 0), 0.0f));
+
+  // 7.1 side channels move to the 5.1 back pair
+  ChannelMixer eight(8, 6);
+  assert(near(eight.getGain(4, 6), 1.0f) && near(eight.getGain(5, 7), 1.0f));
+
+  assert(ChannelMixer(2, 2).isIdentity());
+  assert(!surround.isIdentity());
+
+  std::cout << "✓ ChannelMixer defaults test passed" << std::endl;
+}
+
+void testChannelMixerCustomMatrix() {
+  // Swap left and right
+  ChannelMixer swap(2, 2, { 0.0f, 1.0f, 1.0f, 0.0f });
+  assert(!swap.isIdentity());
+
+  std::vector<float> input = { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f };
+  std::vector<float> output(6);
+  swap.process(input.data(), output.data(), 3);
+
+  for (size_t frame = 0; frame < 3; ++frame) {
+    assert(near(output[frame * 2], input[frame * 2 + 1]));
+    assert(near(output[frame * 2 + 1], input[frame * 2]));
+  }
+
+  // Setting the matrix back to identity switches to the copy path
+  ChannelMixer mixer(2, 2, { 0.0f, 1.0f, 1.0f, 0.0f });
+  mixer.setGain(0, 0, 1.0f);
+  mixer.setGain(0, 1, 0.0f);
+  mixer.setGain(1, 0, 0.0f);
+  assert(!mixer.isIdentity());
+  mixer.setGain(1, 1, 1.0f);
+  assert(mixer.isIdentity());
+
+  mixer.process(input.data(), output.data(), 3);
+  assert(output == input);
+
+  std::cout << "✓ ChannelMixer custom matrix test passed" << std::endl;
+}
+
+void testChannelMixerKernelsMatch() {
+  // Odd frame counts exercise the scalar tail after the SIMD blocks
+  const size_t frames = 1027;
+
+  for (size_t inputs : { 1, 3, 6, 8 }) {
+    std::vector<float> input(frames * inputs);
+
+    for (size_t i = 0; i < input.size(); ++i) {
+      input[i] = static_cast<float>(std::sin(0.37 * i));
+    }
+
+    CpuFeatures::setLevelOverride(SimdLevel::Scalar);
+    std::vector<float> reference(frames * 2);
+    ChannelMixer(inputs, 2).process(input.data(), reference.data(), frames);
+
+    for (SimdLevel level : { SimdLevel::SSE2, SimdLevel::AVX2 }) {
+      CpuFeatures::setLevelOverride(level);
+      std::vector<float> output(frames * 2);
+      ChannelMixer(inputs, 2).process(input.data(), output.data(), frames);
+
+      for (size_t i = 0; i < output.size(); ++i) {
+        assert(std::abs(output[i] - reference[i]) < 1e-6f);
+      }
+    }
+  }
+
+  CpuFeatures::clearLevelOverride();
+  std::cout << "✓ ChannelMixer kernels match test passed" << std::endl;
+}
@@ -0,0 +1,120 @@
+#include "audio/EditTimeline.h"
+#include "audio/GainEffect.h"
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+  // Mono ramp where each sample holds its own frame index
+  AudioBuffer makeRamp(size_t frames, float offset = 0.0f) {
+    AudioBuffer buffer(44100, 1);
+    buffer.resize(frames);
+
+    for (size_t i = 0; i < frames; ++i) {
+      buffer.setSample(i, 0, offset + static_cast<float>(i));
+    }
+    return buffer;
+  }
+}
+
+void testEditTimelineCutPaste() {
+  EditTimeline timeline(44100, 1);
+  timeline.load(makeRamp(100));
+
+  assert(timeline.getFrameCount() == 100);
+  assert(timeline.getSegmentCount() == 1);
+  assert(!timeline.canUndo());
+
+  EditTimeline::Clip clip = timeline.cut(10, 20);
+  assert(clip.frames == 20);
+  assert(timeline.getFrameCount() == 80);
+  assert(timeline.getSample(10, 0) == 30.0f);
+
+  // Pasting at the end shares the cut block instead of copying samples
+  timeline.paste(80, clip);
+  assert(timeline.getFrameCount() == 100);
+  assert(timeline.getSample(80, 0) == 10.0f);
+  assert(timeline.getSample(99, 0) == 29.0f);
+  assert(timeline.getSegmentCount() == 3);
+
+  timeline.insert(0, makeRamp(5, 1000.0f));
+  assert(timeline.getSample(4, 0) == 1004.0f);
+  assert(timeline.getSample(5, 0) == 0.0f);
+
+  std::vector<float> frames(10);
+  assert(timeline.readFrames(12, 10, frames.data()) == 10);
+  assert(frames[0] == 7.0f && frames[3] == 30.0f);
+
+  AudioBuffer rendered = timeline.render();
+  assert(rendered.getFrameCount() == 105);
+  assert(rendered.getSample(104, 0) == 29.0f);
+
+  // Oversized ranges stop at the end of the timeline
+  EditTimeline::Clip tail = timeline.cut(100, SIZE_MAX);
+  assert(tail.frames == 5);
+  assert(timeline.getFrameCount() == 100);
+  assert(timeline.getSample(99, 0) == 24.0f);
+
+  timeline.erase(90, SIZE_MAX);
+  assert(timeline.getFrameCount() == 90);
+  assert(timeline.getSample(89, 0) == 14.0f);
+
+  // A clip from mono audio cannot be pasted once stereo audio is loaded
+  AudioBuffer stereo(44100, 2);
+  stereo.resize(50);
+  timeline.load(stereo);
+  bool rejected = false;
+
+  try {
+    timeline.paste(0, clip);
+  }
+  catch (const std::invalid_argument&) {
+    rejected = true;
+  }
+  assert(rejected && timeline.getFrameCount() == 50 && !timeline.canUndo());
+
+  std::cout << "✓ EditTimeline cut/paste test passed" << std::endl;
+}
+
+void testEditTimelineUndoRedo() {
+  EditTimeline timeline(44100, 1);
+  timeline.load(makeRamp(100));
+
+  GainEffect gain(2.0f);
+  timeline.applyEffect(40, 10, gain);
+
+  // Only the touched range is re-rendered
+  assert(timeline.getSegmentCount() == 3);
+  assert(timeline.getSample(39, 0) == 39.0f);
+  assert(timeline.getSample(40, 0) == 80.0f);
+  assert(timeline.getSample(50, 0) == 50.0f);
+
+  timeline.erase(0, 50);
+  assert(timeline.getFrameCount() == 50);
+
+  assert(timeline.undo());
+  assert(timeline.getFrameCount() == 100);
+  assert(timeline.getSample(45, 0) == 90.0f);
+
+  assert(timeline.undo());
+  assert(timeline.getSample(45, 0) == 45.0f);
+  assert(timeline.getSegmentCount() == 1);
+  assert(!timeline.undo());
+
+  assert(timeline.redo());
+  assert(timeline.getSample(45, 0) == 90.0f);
+
+  // A new edit drops the redo history
+  timeline.cut(0, 10);
+  assert(!timeline.canRedo());
+
+  // Cutting and pasting back in place re-joins the segments
+  EditTimeline plain(44100, 1);
+  plain.load(makeRamp(100));
+  plain.paste(30, plain.cut(30, 10));
+  assert(plain.getSegmentCount() == 1);
+
+  std::cout << "✓ EditTimeline undo/redo test passed" << std::endl;
+}
@@ -29,6 +29,12 @@ void testGainEffectProcessing() {
   assert(std::abs(buffer.getSample(50, 0) - 0.5f) < 0.001f);
   assert(std::abs(buffer.getSample(50, 1) - 0.25f) < 0.001f);
 
+  // Planar buffers give the same result
+  buffer.setLayout(SampleLayout::Planar);
+  effect.process(buffer);
+  assert(std::abs(buffer.getSample(50, 0) - 0.25f) < 0.001f);
+  assert(std::abs(buffer.getSample(50, 1) - 0.125f) < 0.001f);
+
   std::cout << "✓ GainEffect processing test passed" << std::endl;
 }
 
@@ -70,3 +76,34 @@ void testGainEffectSetGain() {
 
   std::cout << "✓ GainEffect setGain test passed" << std::endl;
 }
+
+void testGainEffectBlockProcessing() {
+  GainEffect effect(0.5f);
+  effect.prepare(44100, 4, 2);
+
+  float block[] = { 1.0f, -1.0f, 0.5f, -0.5f, 0.25f, -0.25f, 2.0f, -2.0f };
+  effect.processBlock(block, 4);
+
+  assert(std::abs(block[0] - 0.5f) < 0.001f);
+  assert(std::abs(block[3] + 0.25f) < 0.001f);
+  assert(std::abs(block[7] + 1.0f) < 0.001f);
+
+  std::cout << "✓ GainEffect block processing test passed" << std::endl;
+}
+
+void testGainEffectSmoothing() {
+  // 100 Hz with the default 20 ms ramp: changes take 2 frames
+  GainEffect effect(1.0f);
+  effect.prepare(100, 4, 1);
+
+  float block[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+  effect.setGain(0.0f);
+  effect.processBlock(block, 4);
+
+  // Ramps down instead of stepping, then holds the new value
+  assert(std::abs(block[0] - 0.5f) < 0.001f);
+  assert(std::abs(block[1]) < 0.001f);
+  assert(std::abs(block[3]) < 0.001f);
+
+  std::cout << "✓ GainEffect smoothing test passed" << std::endl;
+}
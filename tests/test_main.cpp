@@ -7,11 +7,74 @@ void testAudioBufferGain();
 void testAudioBufferPeakAmplitude();
 void testAudioBufferNormalize();
 void testAudioBufferMix();
+void testAudioBufferSharedStorage();
+void testAudioBufferView();
+void testAudioBufferPlanarLayout();
+
+void testAudioFileLoaderFileInfo();
+void testAudioFileLoaderBuffered();
+void testAudioFileLoaderMapped();
+void testAudioFileLoaderExtensible();
+void testAudioFileLoaderRF64();
+void testWavChunkIndexChunks();
+void testWavIndexCache();
+void testWavStreamReaderBlocks();
+void testAsyncFileLoaderMatchesLoader();
+void testAsyncFileLoaderCancel();
+void testAudioFileWriterRoundTrip();
+void testAudioFileWriterFormats();
+void testAudioFileWriterStreaming();
+void testAudioFileWriterRF64Header();
+void testBatchProcessorParseChain();
+void testBatchProcessorRun();
+void testSampleLibraryScan();
+void testSampleLibraryIndex();
+void testStreamPrefetcherRead();
+void testStreamPrefetcherUnderrun();
+
+void testSampleConversionRoundTrip();
+void testSampleConversionClipping();
+void testSampleConversionKernelsMatch();
+void testSampleConversionDither();
+
+void testSampleKernelsMatch();
+void testSampleKernelsPrecision();
+void testAudioBufferAnalysis();
+
+void testResamplerConvert();
+void testResamplerStreaming();
+void testResamplerKernelsMatch();
+void testChannelMixerDefaults();
+void testChannelMixerCustomMatrix();
+void testChannelMixerKernelsMatch();
+
+void testPeakPyramidLevels();
+void testPeakPyramidIncrementalUpdate();
+void testPeakFileRoundTrip();
+void testStreamPeakScanner();
+
+void testSpscQueueOrdering();
+void testSpscQueueThreads();
+
+void testCallbackStatsRecording();
+void testCallbackStatsConcurrentReads();
 
 void testGainEffectConstruction();
 void testGainEffectProcessing();
 void testGainEffectDisabled();
 void testGainEffectSetGain();
+void testGainEffectBlockProcessing();
+void testGainEffectSmoothing();
+
+void testSmoothedParameterRamps();
+void testSmoothedParameterAutomation();
+
+void testEffectChainSerial();
+void testParallelEffectsMix();
+void testThreadPoolNested();
+
+void testEditTimelineCutPaste();
+void testEditTimelineUndoRedo();
 
 void testWindowConstruction();
 void testWindowInitialization();
@@ -26,6 +89,7 @@ void testWaveformViewColor();
 void testWaveformViewZoom();
 void testWaveformViewAudioBuffer();
 void testWaveformViewEmptyBuffer();
+void testWaveformViewLoadingBuffer();
 
 int main() {
   std::cout << "Running all unit tests..." << std::endl;
@@ -38,11 +102,74 @@ int main() {
   testAudioBufferPeakAmplitude();
   testAudioBufferNormalize();
   testAudioBufferMix();
+  testAudioBufferSharedStorage();
+  testAudioBufferView();
+  testAudioBufferPlanarLayout();
+
+  testAudioFileLoaderFileInfo();
+  testAudioFileLoaderBuffered();
+  testAudioFileLoaderMapped();
+  testAudioFileLoaderExtensible();
+  testAudioFileLoaderRF64();
+  testWavChunkIndexChunks();
+  testWavIndexCache();
+  testWavStreamReaderBlocks();
+  testAsyncFileLoaderMatchesLoader();
+  testAsyncFileLoaderCancel();
+  testAudioFileWriterRoundTrip();
+  testAudioFileWriterFormats();
+  testAudioFileWriterStreaming();
+  testAudioFileWriterRF64Header();
+  testBatchProcessorParseChain();
+  testBatchProcessorRun();
+  testSampleLibraryScan();
+  testSampleLibraryIndex();
+  testStreamPrefetcherRead();
+  testStreamPrefetcherUnderrun();
+
+  testSampleConversionRoundTrip();
+  testSampleConversionClipping();
+  testSampleConversionKernelsMatch();
+  testSampleConversionDither();
+
+  testSampleKernelsMatch();
+  testSampleKernelsPrecision();
+  testAudioBufferAnalysis();
+
+  testResamplerConvert();
+  testResamplerStreaming();
+  testResamplerKernelsMatch();
+  testChannelMixerDefaults();
+  testChannelMixerCustomMatrix();
+  testChannelMixerKernelsMatch();
+
+  testPeakPyramidLevels();
+  testPeakPyramidIncrementalUpdate();
+  testPeakFileRoundTrip();
+  testStreamPeakScanner();
+
+  testSpscQueueOrdering();
+  testSpscQueueThreads();
+
+  testCallbackStatsRecording();
+  testCallbackStatsConcurrentReads();
 
   testGainEffectConstruction();
   testGainEffectProcessing();
   testGainEffectDisabled();
   testGainEffectSetGain();
+  testGainEffectBlockProcessing();
+  testGainEffectSmoothing();
+
+  testSmoothedParameterRamps();
+  testSmoothedParameterAutomation();
+
+  testEffectChainSerial();
+  testParallelEffectsMix();
+  testThreadPoolNested();
+
+  testEditTimelineCutPaste();
+  testEditTimelineUndoRedo();
 
   testWindowConstruction();
   testWindowInitialization();
@@ -57,6 +184,7 @@ int main() {
   testWaveformViewZoom();
   testWaveformViewAudioBuffer();
   testWaveformViewEmptyBuffer();
+  testWaveformViewLoadingBuffer();
 
   std::cout << "=========================" << std::endl;
   std::cout << "All tests passed!" << std::endl;
@@ -0,0 +1,239 @@
+#include "audio/AudioFileWriter.h"
+#include "audio/PeakFile.h"
+#include "audio/PeakPyramid.h"
+#include "audio/StreamPeakScanner.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace {
+  // Reference summary computed straight from the samples
+  PeakSummary scanBuffer(const AudioBuffer& buffer, size_t startFrame, size_t frames) {
+    PeakSummary summary;
+    summary.min = summary.max = buffer.getSample(startFrame, 0);
+    double sum = 0.0;
+
+    for (size_t frame = startFrame; frame < startFrame + frames; ++frame) {
+      for (size_t channel = 0; channel < buffer.getChannelCount(); ++channel) {
+        float sample = buffer.getSample(frame, channel);
+        summary.min = std::min(summary.min, sample);
+        summary.max = std::max(summary.max, sample);
+        sum += sample * sample;
+      }
+    }
+
+    summary.rms = static_cast<float>(std::sqrt(sum / (frames * buffer.getChannelCount())));
+    return summary;
+  }
+
+  void fillBuffer(AudioBuffer& buffer) {
+    for (size_t i = 0; i < buffer.getFrameCount(); ++i) {
+      float value = 0.5f * std::sin(static_cast<float>(i) * 0.01f);
+      buffer.setSample(i, 0, value);
+      buffer.setSample(i, 1, -0.25f * value);
+    }
+  }
+}
+
+void testPeakPyramidLevels() {
+  AudioBuffer buffer(44100, 2);
+  buffer.resize(70000);
+  fillBuffer(buffer);
+
+  PeakPyramid pyramid;
+  pyramid.build(buffer);
+
+  assert(pyramid.getFrameCount() == 70000);
+  assert(pyramid.getBucketFrames(0) == 256);
+  assert(pyramid.getBucketFrames(2) == 65536);
+  assert(pyramid.getBucketCount(0) == 274);
+  assert(pyramid.getBucketCount(1) == 18);
+  assert(pyramid.getBucketCount(2) == 2);
+
+  // Bucket-aligned ranges on every level match a direct scan
+  const size_t ranges[][2] = { { 512, 256 }, { 4096, 8192 }, { 0, 65536 }, { 0, 70000 } };
+
+  for (const auto& range : ranges) {
+    PeakSummary expected = scanBuffer(buffer, range[0], range[1]);
+    PeakSummary summary = pyramid.query(range[0], range[1]);
+
+    assert(summary.min == expected.min);
+    assert(summary.max == expected.max);
+    assert(std::abs(summary.rms - expected.rms) < 1e-4f);
+  }
+
+  assert(pyramid.query(70000, 100).rms == 0.0f);
+  std::cout << "✓ PeakPyramid levels test passed" << std::endl;
+}
+
+void testPeakPyramidIncrementalUpdate() {
+  AudioBuffer buffer(44100, 2);
+  buffer.resize(20000);
+  fillBuffer(buffer);
+
+  PeakPyramid pyramid;
+  pyramid.build(buffer);
+
+  buffer.setSample(5000, 1, 0.9f);
+  buffer.setSample(5001, 0, -0.8f);
+  pyramid.update(buffer, 5000, 2);
+
+  PeakSummary summary = pyramid.query(0, 20000);
+  assert(summary.max == 0.9f);
+  assert(summary.min == -0.8f);
+
+  PeakPyramid rebuilt;
+  rebuilt.build(buffer);
+  assert(std::abs(rebuilt.query(4096, 4096).rms - pyramid.query(4096, 4096).rms) < 1e-6f);
+
+  // Pieces scanned separately assemble into the same pyramid
+  AudioBuffer source(44100, 2);
+  source.resize(150000);
+  fillBuffer(source);
+
+  const size_t pieceFrames = 65536;
+  PeakPyramid assembled;
+  assembled.reset(source.getFrameCount(), 2);
+
+  for (size_t start = 0; start < source.getFrameCount(); start += pieceFrames) {
+    AudioBuffer chunk(44100, 2);
+    chunk.resize(std::min(pieceFrames, source.getFrameCount() - start));
+
+    for (size_t i = 0; i < chunk.getFrameCount(); ++i) {
+      chunk.setSample(i, 0, source.getSample(start + i, 0));
+      chunk.setSample(i, 1, source.getSample(start + i, 1));
+    }
+
+    PeakPyramid piece;
+    piece.build(chunk);
+    assert(assembled.insertPiece(piece, start));
+  }
+
+  PeakPyramid whole;
+  whole.build(source);
+
+  for (size_t start : { 0UL, 1000UL, 60000UL, 131072UL }) {
+    PeakSummary a = assembled.query(start, 70000);
+    PeakSummary b = whole.query(start, 70000);
+    assert(a.min == b.min && a.max == b.max && std::abs(a.rms - b.rms) < 1e-6f);
+  }
+
+  // Misaligned or oversized pieces are refused
+  PeakPyramid piece;
+  piece.reset(1000, 2);
+  assert(!assembled.insertPiece(piece, 256));
+  assert(!assembled.insertPiece(piece, 0));
+  piece.reset(20000, 2);
+  assert(!assembled.insertPiece(piece, 131072));
+
+  // A shape change rebuilds everything
+  buffer.resize(300);
+  pyramid.update(buffer, 0, 0);
+  assert(pyramid.getFrameCount() == 300);
+  assert(pyramid.getBucketCount(0) == 2);
+
+  std::cout << "✓ PeakPyramid incremental update test passed" << std::endl;
+}
+
+void testPeakFileRoundTrip() {
+  const std::string audioFile = "test_peak_source.bin";
+  const std::string sidecar = PeakFile::getSidecarPath(audioFile);
+
+  {
+    std::ofstream file(audioFile, std::ios::binary);
+    file << std::string(200000, 'a');
+  }
+
+  AudioBuffer buffer(44100, 2);
+  buffer.resize(10000);
+  fillBuffer(buffer);
+
+  PeakPyramid pyramid;
+  pyramid.build(buffer);
+
+  PeakFileKey key;
+  assert(PeakFile::computeKey(audioFile, key));
+  assert(PeakFile::save(sidecar, key, pyramid));
+
+  PeakPyramid loaded;
+  assert(PeakFile::load(sidecar, key, loaded));
+  assert(loaded.getFrameCount() == 10000);
+  assert(loaded.getChannelCount() == 2);
+  assert(loaded.query(0, 10000).max == pyramid.query(0, 10000).max);
+  assert(loaded.query(4096, 4096).rms == pyramid.query(4096, 4096).rms);
+
+  // Same size, different content near the end: the key no longer matches
+  {
+    std::fstream file(audioFile, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(199990);
+    file.put('b');
+  }
+
+  PeakFileKey changedKey;
+  assert(PeakFile::computeKey(audioFile, changedKey));
+  assert(changedKey != key);
+  assert(!PeakFile::load(sidecar, changedKey, loaded));
+
+  std::remove(audioFile.c_str());
+  std::remove(sidecar.c_str());
+  std::cout << "✓ PeakFile round trip test passed" << std::endl;
+}
+
+void testStreamPeakScanner() {
+  const std::string filename = "test_peak_stream.wav";
+
+  AudioBuffer buffer(44100, 2);
+  buffer.resize(600000);
+  fillBuffer(buffer);
+
+  AudioFileWriter writer;
+  writer.setSampleFormat(SampleFormat::Float32);
+  assert(writer.writeWavFile(filename, buffer));
+
+  StreamPeakScanner scanner;
+  assert(!scanner.start("missing.wav"));
+  assert(scanner.getState() == StreamPeakScanner::State::Idle);
+  assert(scanner.start(filename));
+
+  // Pieces arrive in order and assemble into the pyramid of the whole file
+  PeakPyramid assembled;
+  assembled.reset(scanner.getFrameCount(), scanner.getChannelCount());
+  size_t nextFrame = 0;
+
+  for (;;) {
+    StreamPeakScanner::State state = scanner.getState();
+    StreamPeakScanner::Piece piece;
+
+    while (scanner.takePiece(piece)) {
+      assert(piece.startFrame == nextFrame);
+      assert(assembled.insertPiece(piece.peaks, piece.startFrame));
+      nextFrame += piece.peaks.getFrameCount();
+    }
+
+    if (state != StreamPeakScanner::State::Scanning) {
+      assert(state == StreamPeakScanner::State::Finished);
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  assert(nextFrame == 600000);
+
+  PeakPyramid whole;
+  whole.build(buffer);
+  assert(assembled.query(0, 600000).max == whole.query(0, 600000).max);
+  assert(std::abs(assembled.query(300000, 200000).rms - whole.query(300000, 200000).rms) < 1e-6f);
+
+  // A cancelled scan leaves nothing to take
+  assert(scanner.start(filename));
+  scanner.cancel();
+  StreamPeakScanner::Piece piece;
+  assert(!scanner.takePiece(piece));
+
+  std::remove(filename.c_str());
+  std::cout << "✓ StreamPeakScanner test passed" << std::endl;
+}
@@ -0,0 +1,165 @@
+#include "audio/SampleConversion.h"
+#include "audio/CpuFeatures.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+  // Odd length so every kernel also runs its scalar tail
+  const size_t kTestSamples = 1003;
+
+  std::vector<float> makeTestSignal() {
+    std::vector<float> signal(kTestSamples);
+
+    for (size_t i = 0; i < kTestSamples; ++i) {
+      signal[i] = 1.2f * std::sin(static_cast<float>(i) * 0.05f);
+    }
+
+    // Edge cases: full scale, beyond full scale, NaN
+    signal[0] = 1.0f;
+    signal[1] = -1.0f;
+    signal[2] = 2.0f;
+    signal[3] = -2.0f;
+    signal[4] = NAN;
+    return signal;
+  }
+
+  const SampleFormat kFormats[] = {
+    SampleFormat::Int16, SampleFormat::Int24, SampleFormat::Int32, SampleFormat::Float32
+  };
+
+  const SimdLevel kLevels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+}
+
+void testSampleConversionRoundTrip() {
+  std::vector<float> signal = makeTestSignal();
+  signal[4] = 0.0f;
+
+  for (SampleFormat format : kFormats) {
+    std::vector<uint8_t> encoded(kTestSamples * SampleConversion::getBytesPerSample(format));
+    std::vector<float> decoded(kTestSamples);
+
+    SampleConversion::fromFloat(format, signal.data(), encoded.data(), kTestSamples);
+    SampleConversion::toFloat(format, encoded.data(), decoded.data(), kTestSamples);
+
+    float tolerance = format == SampleFormat::Int16 ? 1.0f / 32768.0f : 1.0f / 8388608.0f;
+
+    for (size_t i = 0; i < kTestSamples; ++i) {
+      float expected = format == SampleFormat::Float32
+        ? signal[i]
+        : std::max(-1.0f, std::min(1.0f, signal[i]));
+      assert(std::abs(decoded[i] - expected) <= tolerance);
+    }
+  }
+
+  std::cout << "✓ SampleConversion round trip test passed" << std::endl;
+}
+
+void testSampleConversionClipping() {
+  const float input[] = { 1.0f, -1.0f, 2.0f, -2.0f };
+  int16_t pcm16[4];
+  int32_t pcm32[4];
+
+  SampleConversion::fromFloat(SampleFormat::Int16, input, pcm16, 4);
+  SampleConversion::fromFloat(SampleFormat::Int32, input, pcm32, 4);
+
+  assert(pcm16[0] == 32767 && pcm16[1] == -32768);
+  assert(pcm16[2] == 32767 && pcm16[3] == -32768);
+  assert(pcm32[0] > 2147483000 && pcm32[1] == INT32_MIN);
+  assert(pcm32[2] == pcm32[0] && pcm32[3] == INT32_MIN);
+
+  const uint8_t pcm24[] = { 0xFF, 0xFF, 0x7F, 0x00, 0x00, 0x80, 0xFF, 0xFF, 0xFF };
+  float decoded[3];
+  SampleConversion::toFloat(SampleFormat::Int24, pcm24, decoded, 3);
+
+  assert(std::abs(decoded[0] - 8388607.0f / 8388608.0f) < 1e-7f);
+  assert(decoded[1] == -1.0f);
+  assert(decoded[2] == -1.0f / 8388608.0f);
+
+  std::cout << "✓ SampleConversion clipping test passed" << std::endl;
+}
+
+void testSampleConversionKernelsMatch() {
+  std::vector<float> signal = makeTestSignal();
+
+  for (SampleFormat format : kFormats) {
+    size_t bytes = kTestSamples * SampleConversion::getBytesPerSample(format);
+    std::vector<uint8_t> reference(bytes);
+    std::vector<float> referenceDecoded(kTestSamples);
+
+    CpuFeatures::setLevelOverride(SimdLevel::Scalar);
+    SampleConversion::fromFloat(format, signal.data(), reference.data(), kTestSamples);
+    SampleConversion::toFloat(format, reference.data(), referenceDecoded.data(), kTestSamples);
+
+    // Every level available on this CPU must be bit-exact with scalar code
+    for (SimdLevel level : kLevels) {
+      CpuFeatures::setLevelOverride(level);
+
+      std::vector<uint8_t> encoded(bytes);
+      std::vector<float> decoded(kTestSamples);
+
+      SampleConversion::fromFloat(format, signal.data(), encoded.data(), kTestSamples);
+      SampleConversion::toFloat(format, reference.data(), decoded.data(), kTestSamples);
+
+      if (format != SampleFormat::Float32) {
+        assert(encoded == reference);
+        assert(std::memcmp(decoded.data(), referenceDecoded.data(), kTestSamples * sizeof(float)) == 0);
+      }
+    }
+  }
+
+  CpuFeatures::clearLevelOverride();
+  std::cout << "✓ SampleConversion kernel consistency test passed ("
+            << CpuFeatures::getLevelName(CpuFeatures::getSupportedLevel()) << ")" << std::endl;
+}
+
+void testSampleConversionDither() {
+  const size_t count = 100003;
+  const float lsb = 1.0f / 32768.0f;
+
+  // Triangular noise within +-1 LSB with zero mean, identical on every
+  // kernel; blocks of whole lane groups continue the same sequence
+  CpuFeatures::setLevelOverride(SimdLevel::Scalar);
+  std::vector<float> reference(count, 0.25f);
+  SampleConversion::DitherState referenceState(7);
+  SampleConversion::addDither(SampleFormat::Int16, reference.data(), count, referenceState);
+
+  double sum = 0.0;
+  size_t nearZero = 0;
+
+  for (float sample : reference) {
+    float noise = sample - 0.25f;
+    assert(std::abs(noise) <= lsb);
+    sum += noise;
+    nearZero += std::abs(noise) < 0.5f * lsb ? 1 : 0;
+  }
+  assert(std::abs(sum / count) < 0.01 * lsb);
+
+  // Three quarters of a triangular distribution lie within half its width
+  assert(nearZero > count * 0.72 && nearZero < count * 0.78);
+
+  for (SimdLevel level : kLevels) {
+    CpuFeatures::setLevelOverride(level);
+    std::vector<float> samples(count, 0.25f);
+    SampleConversion::DitherState state(7);
+
+    for (size_t done = 0; done < count;) {
+      size_t block = std::min<size_t>(count - done, 4096);
+      SampleConversion::addDither(SampleFormat::Int16, samples.data() + done, block, state);
+      done += block;
+    }
+    assert(samples == reference);
+  }
+
+  // Formats without a useful float LSB pass through
+  std::vector<float> untouched(16, 0.5f);
+  SampleConversion::DitherState state;
+  SampleConversion::addDither(SampleFormat::Float32, untouched.data(), untouched.size(), state);
+  assert(untouched == std::vector<float>(16, 0.5f));
+
+  CpuFeatures::clearLevelOverride();
+  std::cout << "✓ SampleConversion dither test passed" << std::endl;
+}
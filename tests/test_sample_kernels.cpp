@@ -0,0 +1,131 @@
+#include "audio/SampleKernels.h"
+#include "audio/AudioBuffer.h"
+#include "audio/CpuFeatures.h"
+#include "audio/ThreadPool.h"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace {
+  // Odd length so every kernel also runs its scalar tail
+  const size_t kTestSamples = 1003;
+
+  std::vector<float> makeTestSignal(float offset) {
+    std::vector<float> signal(kTestSamples);
+
+    for (size_t i = 0; i < kTestSamples; ++i) {
+      signal[i] = offset + 0.8f * std::sin(static_cast<float>(i) * 0.37f);
+    }
+    return signal;
+  }
+
+  const SimdLevel kLevels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+}
+
+void testSampleKernelsMatch() {
+  std::vector<float> signal = makeTestSignal(0.1f);
+  std::vector<float> other = makeTestSignal(-0.2f);
+  signal[7] = -0.95f;
+
+  CpuFeatures::setLevelOverride(SimdLevel::Scalar);
+  float referencePeak = SampleKernels::peak(signal.data(), kTestSamples);
+  double referenceSquares = SampleKernels::sumSquares(signal.data(), kTestSamples);
+
+  for (SimdLevel level : kLevels) {
+    CpuFeatures::setLevelOverride(level);
+
+    assert(SampleKernels::peak(signal.data(), kTestSamples) == referencePeak);
+    assert(std::abs(SampleKernels::sumSquares(signal.data(), kTestSamples) - referenceSquares) < 1e-9);
+
+    // Channel counts the SIMD lanes cover, and ones that fall back
+    for (size_t channels = 1; channels <= 5; ++channels) {
+      size_t frames = kTestSamples / channels;
+      std::vector<double> sums(channels, 0.0);
+      SampleKernels::sumChannels(signal.data(), frames, channels, sums.data());
+
+      for (size_t channel = 0; channel < channels; ++channel) {
+        double expected = 0.0;
+
+        for (size_t frame = 0; frame < frames; ++frame) {
+          expected += signal[frame * channels + channel];
+        }
+        assert(std::abs(sums[channel] - expected) < 1e-9);
+      }
+    }
+
+    std::vector<float> gained = signal;
+    SampleKernels::applyGain(gained.data(), kTestSamples, 0.5f);
+
+    std::vector<float> mixed = signal;
+    SampleKernels::mix(mixed.data(), other.data(), kTestSamples, 0.25f, 0.75f);
+
+    for (size_t i = 0; i < kTestSamples; ++i) {
+      assert(gained[i] == signal[i] * 0.5f);
+      assert(std::abs(mixed[i] - (signal[i] * 0.25f + other[i] * 0.75f)) < 1e-6f);
+    }
+  }
+
+  CpuFeatures::clearLevelOverride();
+  std::cout << "✓ SampleKernels consistency test passed" << std::endl;
+}
+
+void testSampleKernelsPrecision() {
+  // A single float accumulator stops growing long before this many samples
+  std::vector<float> samples(size_t(1) << 24, 0.1f);
+
+  double sum = SampleKernels::sumSquares(samples.data(), samples.size());
+  float rms = static_cast<float>(std::sqrt(sum / samples.size()));
+  assert(std::abs(rms - 0.1f) < 1e-6f);
+
+  double dc = 0.0;
+  SampleKernels::sumChannels(samples.data(), samples.size(), 1, &dc);
+  assert(std::abs(dc / samples.size() - 0.1) < 1e-6);
+
+  std::cout << "✓ SampleKernels precision test passed" << std::endl;
+}
+
+void testAudioBufferAnalysis() {
+  const size_t frames = SampleKernels::kParallelThreshold + 4321;
+  const float pi = 3.14159265f;
+  AudioBuffer buffer(44100, 2);
+
+  buffer.resize(frames);
+  float* samples = buffer.getData();
+
+  for (size_t frame = 0; frame < frames; ++frame) {
+    samples[frame * 2] = 0.25f + 0.5f * std::sin(2.0f * pi * (frame % 100) / 100.0f);
+    samples[frame * 2 + 1] = -0.5f * std::sin(2.0f * pi * (frame % 100) / 100.0f);
+  }
+
+  assert(std::abs(buffer.getDCOffset(0) - 0.25f) < 1e-4f);
+  assert(std::abs(buffer.getDCOffset(1)) < 1e-4f);
+
+  AudioBuffer planar(buffer);
+  planar.setLayout(SampleLayout::Planar);
+  assert(std::abs(planar.getDCOffset(0) - buffer.getDCOffset(0)) < 1e-6f);
+
+  // The threaded path agrees with the single-threaded one
+  ThreadPool pool(3);
+
+  assert(buffer.getPeakAmplitude(&pool) == buffer.getPeakAmplitude());
+  assert(std::abs(buffer.getRMSAmplitude(&pool) - buffer.getRMSAmplitude()) < 1e-6f);
+  assert(std::abs(buffer.getDCOffset(0, &pool) - buffer.getDCOffset(0)) < 1e-6f);
+  assert(std::abs(buffer.getCrestFactor(&pool) - buffer.getCrestFactor()) < 1e-5f);
+
+  // A sine's crest factor is sqrt(2)
+  AudioBuffer tone(44100, 1);
+  tone.resize(1000);
+  for (size_t frame = 0; frame < 1000; ++frame) {
+    tone.setSample(frame, 0, std::sin(2.0f * pi * frame / 100.0f));
+  }
+  assert(std::abs(tone.getCrestFactor() - std::sqrt(2.0f)) < 1e-3f);
+
+  AudioBuffer threaded(buffer);
+  threaded.applyGain(0.5f, &pool);
+  buffer.applyGain(0.5f);
+  assert(threaded.getSample(frames - 1, 1) == buffer.getSample(frames - 1, 1));
+  assert(threaded.getSample(12345, 0) == buffer.getSample(12345, 0));
+
+  std::cout << "✓ AudioBuffer analysis test passed" << std::endl;
+}
@@ -0,0 +1,149 @@
+#include "audio/SampleLibrary.h"
+#include "audio/AudioFileWriter.h"
+#include "audio/ThreadPool.h"
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace {
+  // Stereo float file holding `left` and `right` in every frame
+  void writeLevels(const fs::path& path, size_t frames, float left, float right) {
+    AudioBuffer buffer(48000, 2);
+    buffer.resize(frames);
+
+    for (size_t frame = 0; frame < frames; ++frame) {
+      buffer.setSample(frame, 0, left);
+      buffer.setSample(frame, 1, right);
+    }
+
+    AudioFileWriter writer;
+    writer.setSampleFormat(SampleFormat::Float32);
+    assert(writer.writeWavFile(path.string(), buffer));
+  }
+
+  const SampleLibrary::Entry& getEntry(const SampleLibrary& library, const fs::path& path) {
+    size_t index = library.find(path.string());
+    assert(index < library.size());
+    return library.getEntries()[index];
+  }
+}
+
+void testSampleLibraryScan() {
+  fs::path directory = "test_library";
+  fs::remove_all(directory);
+  fs::create_directories(directory / "drums" / "kicks");
+  fs::create_directories(directory / "pads");
+
+  writeLevels(directory / "a.wav", 1000, 0.5f, 0.5f);
+  writeLevels(directory / "drums" / "b.wav", 2000, 0.25f, -0.75f);
+  writeLevels(directory / "drums" / "kicks" / "c.WAV", 3000, 0.1f, 0.1f);
+  std::ofstream(directory / "pads" / "broken.wav") << "not a RIFF file";
+  std::ofstream(directory / "pads" / "notes.txt") << "not audio";
+
+  ThreadPool pool(2);
+  SampleLibrary library;
+  SampleLibrary::ScanStats stats = library.scan({ directory.string() }, &pool);
+
+  assert(!stats.cancelled);
+  assert(stats.files == 4 && stats.analyzed == 4 && stats.failed == 1);
+  assert(stats.unchanged == 0 && stats.removed == 0);
+  assert(library.size() == 4);
+
+  for (size_t i = 1; i < library.size(); ++i) {
+    assert(library.getEntries()[i - 1].path < library.getEntries()[i].path);
+  }
+
+  const SampleLibrary::Entry& b = getEntry(library, directory / "drums" / "b.wav");
+  assert(b.isReadable());
+  assert(b.sampleRate == 48000 && b.channels == 2 && b.frameCount == 2000);
+  assert(b.sampleFormat == SampleFormat::Float32);
+  assert(b.fileSize == fs::file_size(directory / "drums" / "b.wav"));
+  assert(std::abs(b.peak - 0.75f) < 1e-6f);
+  assert(std::abs(b.rms - std::sqrt(0.3125f)) < 1e-5f);
+  assert(std::abs(b.getDuration() - 2000.0 / 48000.0) < 1e-9);
+
+  // Unreadable files are catalogued too, so rescans skip them until they change
+  assert(!getEntry(library, directory / "pads" / "broken.wav").isReadable());
+  assert(library.find((directory / "pads" / "notes.txt").string()) == library.size());
+
+  // Nothing changed: nothing is read again
+  stats = library.scan({ directory.string() }, &pool);
+  assert(stats.files == 4 && stats.unchanged == 4 && stats.analyzed == 0);
+
+  // A rewritten file is read again, a deleted one dropped, a new one added
+  writeLevels(directory / "drums" / "b.wav", 500, 0.9f, 0.0f);
+  fs::remove(directory / "drums" / "kicks" / "c.WAV");
+  writeLevels(directory / "pads" / "d.wav", 100, 0.2f, 0.2f);
+
+  stats = library.scan({ directory.string() });
+  assert(stats.files == 4 && stats.unchanged == 2 && stats.analyzed == 2 && stats.removed == 1);
+  assert(getEntry(library, directory / "drums" / "b.wav").frameCount == 500);
+  assert(std::abs(getEntry(library, directory / "drums" / "b.wav").peak - 0.9f) < 1e-6f);
+  assert(getEntry(library, directory / "pads" / "d.wav").isReadable());
+
+  // A cancelled scan leaves the catalogue as it was
+  std::atomic<bool> cancel(true);
+  fs::remove(directory / "a.wav");
+  stats = library.scan({ directory.string() }, &pool, &cancel);
+  assert(stats.cancelled);
+  assert(library.size() == 4 && library.find((directory / "a.wav").string()) < library.size());
+
+  fs::remove_all(directory);
+  std::cout << "✓ SampleLibrary scan test passed" << std::endl;
+}
+
+void testSampleLibraryIndex() {
+  fs::path directory = "test_library_index";
+  fs::remove_all(directory);
+  fs::create_directories(directory / "one" / "two");
+
+  for (int i = 0; i < 20; ++i) {
+    writeLevels(directory / "one" / ("take" + std::to_string(i) + ".wav"), 100 + i, 0.01f * i, 0.0f);
+  }
+  writeLevels(directory / "one" / "two" / "x.wav", 10, 0.5f, 0.5f);
+
+  SampleLibrary library;
+  library.scan({ directory.string() });
+  assert(library.size() == 21);
+
+  std::string indexPath = SampleLibrary::getIndexPath(directory.string());
+  assert(library.save(indexPath));
+
+  // The index itself is not catalogued by later scans
+  SampleLibrary rescanned = library;
+  assert(rescanned.scan({ directory.string() }).files == 21);
+
+  SampleLibrary loaded;
+  assert(loaded.load(indexPath));
+  assert(loaded.size() == library.size());
+
+  for (size_t i = 0; i < library.size(); ++i) {
+    const SampleLibrary::Entry& a = library.getEntries()[i];
+    const SampleLibrary::Entry& b = loaded.getEntries()[i];
+    assert(a.path == b.path && a.fileSize == b.fileSize && a.modifiedTime == b.modifiedTime);
+    assert(a.sampleRate == b.sampleRate && a.channels == b.channels && a.sampleFormat == b.sampleFormat);
+    assert(a.frameCount == b.frameCount && a.peak == b.peak && a.rms == b.rms);
+  }
+
+  // A loaded index makes the next scan incremental
+  SampleLibrary::ScanStats stats = loaded.scan({ directory.string() });
+  assert(stats.unchanged == 21 && stats.analyzed == 0);
+
+  // Shared directory prefixes are stored once: 43 fixed bytes per entry
+  // plus a few of path, where whole paths would take over 30
+  assert(fs::file_size(indexPath) < 16 + 21 * (43 + 12));
+
+  // A damaged index is rejected as a whole
+  fs::resize_file(indexPath, fs::file_size(indexPath) - 3);
+  assert(!loaded.load(indexPath));
+  assert(loaded.isEmpty());
+  assert(!loaded.load((directory / "missing").string()));
+
+  fs::remove_all(directory);
+  std::cout << "✓ SampleLibrary index test passed" << std::endl;
+}
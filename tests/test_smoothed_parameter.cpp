@@ -0,0 +1,79 @@
+#include "audio/SmoothedParameter.h"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+void testSmoothedParameterRamps() {
+  // 1000 Hz with a 10 ms ramp: 10 frames per change
+  SmoothedParameter linear(0.0f, SmoothedParameter::Ramp::Linear, 0.01f);
+  linear.prepare(1000, 8);
+
+  assert(!linear.processBlock(8));
+  assert(linear.getCurrentValue() == 0.0f);
+
+  linear.setTarget(1.0f);
+  assert(linear.processBlock(8));
+  assert(std::abs(linear.getValues()[0] - 0.1f) < 1e-5f);
+  assert(std::abs(linear.getValues()[7] - 0.8f) < 1e-5f);
+
+  assert(linear.processBlock(8));
+  assert(std::abs(linear.getValues()[1] - 1.0f) < 1e-5f);
+  assert(linear.getValues()[7] == 1.0f);
+  assert(!linear.processBlock(8));
+
+  // An empty block mid-ramp neither moves nor restarts it
+  linear.setTarget(0.0f);
+  assert(linear.processBlock(4));
+  assert(!linear.processBlock(0));
+  assert(std::abs(linear.getCurrentValue() - 0.6f) < 1e-5f);
+  assert(linear.processBlock(2));
+  assert(std::abs(linear.getValues()[1] - 0.4f) < 1e-5f);
+
+  SmoothedParameter exponential(1.0f, SmoothedParameter::Ramp::Exponential, 0.01f);
+  exponential.prepare(1000, 8);
+  exponential.setTarget(0.0f);
+
+  float previous = 1.0f;
+
+  for (int block = 0; block < 2; ++block) {
+    assert(exponential.processBlock(8));
+
+    for (size_t i = 0; i < 8; ++i) {
+      assert(exponential.getValues()[i] < previous);
+      previous = exponential.getValues()[i];
+    }
+  }
+
+  // Within 1% after the ramp time
+  assert(previous < 0.01f);
+  std::cout << "✓ SmoothedParameter ramps test passed" << std::endl;
+}
+
+void testSmoothedParameterAutomation() {
+  SmoothedParameter parameter(5.0f);
+  parameter.setAutomation({ { 20, 0.0f }, { 4, 1.0f }, { 12, 1.0f } });
+  parameter.prepare(44100, 8);
+
+  // Holds the first point, then follows each segment sample-accurately
+  assert(!parameter.processBlock(4));
+  assert(parameter.getCurrentValue() == 1.0f);
+
+  assert(parameter.processBlock(8));
+  assert(parameter.getValues()[0] == 1.0f && parameter.getValues()[7] == 1.0f);
+
+  assert(parameter.processBlock(8));
+  const float* values = parameter.getValues();
+  assert(values[0] == 1.0f);
+  assert(std::abs(values[4] - 0.5f) < 1e-6f);
+  assert(std::abs(values[7] - 0.125f) < 1e-6f);
+
+  assert(!parameter.processBlock(8));
+  assert(parameter.getCurrentValue() == 0.0f);
+
+  // Repositioning evaluates the envelope from there
+  parameter.setPosition(14);
+  assert(parameter.processBlock(4));
+  assert(std::abs(parameter.getValues()[0] - 0.75f) < 1e-6f);
+
+  std::cout << "✓ SmoothedParameter automation test passed" << std::endl;
+}
@@ -0,0 +1,61 @@
+#include "audio/SpscQueue.h"
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+void testSpscQueueOrdering() {
+  SpscQueue<int, 4> queue;
+  int value = 0;
+
+  assert(queue.isEmpty());
+  assert(!queue.tryPop(value));
+
+  for (int i = 0; i < 4; ++i) {
+    assert(queue.tryPush(int(i)));
+  }
+
+  // Full: the rejected element is left with the caller
+  auto extra = std::make_unique<int>(42);
+  SpscQueue<std::unique_ptr<int>, 2> owners;
+  assert(owners.tryPush(std::make_unique<int>(1)));
+  assert(owners.tryPush(std::make_unique<int>(2)));
+  assert(!owners.tryPush(std::move(extra)));
+  assert(extra && *extra == 42);
+
+  for (int i = 0; i < 4; ++i) {
+    assert(queue.tryPop(value));
+    assert(value == i);
+  }
+
+  assert(queue.isEmpty());
+  std::cout << "✓ SpscQueue ordering test passed" << std::endl;
+}
+
+void testSpscQueueThreads() {
+  const int kCount = 100000;
+  SpscQueue<int, 64> queue;
+
+  std::thread producer([&queue]() {
+    for (int i = 0; i < kCount; ++i) {
+      while (!queue.tryPush(int(i))) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int expected = 0;
+
+  while (expected < kCount) {
+    int value;
+
+    if (queue.tryPop(value)) {
+      assert(value == expected);
+      ++expected;
+    }
+  }
+
+  producer.join();
+  assert(queue.isEmpty());
+  std::cout << "✓ SpscQueue producer/consumer test passed" << std::endl;
+}
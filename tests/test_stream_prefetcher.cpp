@@ -0,0 +1,117 @@
+#include "audio/StreamPrefetcher.h"
+#include "audio/AudioFileWriter.h"
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace {
+  // Stereo float file whose left channel holds the frame index
+  void writeRamp(const std::string& filename, size_t frames) {
+    AudioBuffer buffer(48000, 2);
+    buffer.resize(frames);
+
+    for (size_t frame = 0; frame < frames; ++frame) {
+      buffer.setSample(frame, 0, static_cast<float>(frame));
+      buffer.setSample(frame, 1, -1.0f);
+    }
+
+    AudioFileWriter writer;
+    writer.setSampleFormat(SampleFormat::Float32);
+    assert(writer.writeWavFile(filename, buffer));
+  }
+
+  bool isRamp(const std::vector<float>& frames, size_t count, size_t first) {
+    for (size_t i = 0; i < count; ++i) {
+      if (frames[i * 2] != static_cast<float>(first + i) || frames[i * 2 + 1] != -1.0f) return false;
+    }
+    return true;
+  }
+}
+
+void testStreamPrefetcherRead() {
+  const std::string filename = "test_prefetcher.wav";
+  const size_t frameCount = 20000;
+  writeRamp(filename, frameCount);
+
+  // A ring smaller than the file, so the reader thread has to wrap
+  StreamPrefetcher prefetcher(4096, true);
+  assert(prefetcher.open(filename));
+  assert(prefetcher.getFrameCount() == frameCount);
+  assert(prefetcher.getChannelCount() == 2);
+  assert(prefetcher.getSampleRate() == 48000);
+
+  std::vector<float> block(1000 * 2);
+  size_t total = 0;
+  size_t framesRead;
+
+  while ((framesRead = prefetcher.read(block.data(), 1000)) > 0) {
+    assert(isRamp(block, framesRead, total));
+    total += framesRead;
+  }
+  assert(total == frameCount);
+  assert(prefetcher.getPosition() == frameCount);
+  assert(prefetcher.getUnderruns() == 0);
+
+  // Frames buffered before a seek are dropped
+  prefetcher.seek(12345);
+  assert(prefetcher.read(block.data(), 500) == 500);
+  assert(isRamp(block, 500, 12345));
+
+  prefetcher.seek(100);
+  prefetcher.seek(7000);
+  assert(prefetcher.read(block.data(), 10) == 10);
+  assert(isRamp(block, 10, 7000));
+
+  // Seeks past the end clamp
+  prefetcher.seek(frameCount + 50);
+  assert(prefetcher.getPosition() == frameCount);
+  assert(prefetcher.read(block.data(), 10) == 0);
+
+  std::remove(filename.c_str());
+  std::cout << "✓ StreamPrefetcher read test passed" << std::endl;
+}
+
+void testStreamPrefetcherUnderrun() {
+  const std::string filename = "test_prefetcher_underrun.wav";
+  writeRamp(filename, 5000);
+
+  // Cut the data chunk short behind the header's back
+  {
+    std::ifstream in(filename, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    bytes.resize(bytes.size() - 1000 * 2 * sizeof(float));
+    std::ofstream(filename, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+  }
+
+  StreamPrefetcher prefetcher(8192, false);
+  assert(prefetcher.open(filename));
+  assert(prefetcher.getFrameCount() == 5000);
+
+  // Without blocking, a read only returns what the reader thread has buffered
+  std::vector<float> block(8192 * 2);
+  size_t total = 0;
+
+  for (int attempt = 0; attempt < 2000 && total < 5000; ++attempt) {
+    size_t framesRead = prefetcher.read(block.data(), 256);
+    assert(isRamp(block, framesRead, total));
+    total += framesRead;
+
+    if (framesRead == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (prefetcher.getPosition() >= prefetcher.getEndFrame()) break;
+  }
+
+  // The stream ends where the file does, not where the header said
+  assert(total == 4000);
+  assert(prefetcher.getEndFrame() == 4000);
+  assert(prefetcher.read(block.data(), 256) == 0);
+
+  std::remove(filename.c_str());
+  std::cout << "✓ StreamPrefetcher underrun test passed" << std::endl;
+}
@@ -0,0 +1,150 @@
+#include "audio/AudioFileLoader.h"
+#include "audio/WavChunkIndex.h"
+#include "audio/WavIndexCache.h"
+#include "WavFixture.h"
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+  using WavFixture::makePcm16Format;
+  using WavFixture::makeWav;
+  using WavFixture::writeFile;
+
+  // Mono 16-bit file of `frames` frames with metadata on both sides of "data"
+  std::vector<uint8_t> makeTaggedWav(size_t frames) {
+    std::vector<uint8_t> data(frames * 2, 0x11);
+    std::vector<uint8_t> list(12, 'L');
+    std::vector<uint8_t> bext(5, 'B');      // Odd size, so a pad byte follows
+    std::vector<uint8_t> cue(28, 'C');
+
+    return makeWav({ { "fmt ", makePcm16Format(1) }, { "LIST", list }, { "bext", bext },
+                     { "data", data }, { "cue ", cue } });
+  }
+}
+
+void testWavChunkIndexChunks() {
+  std::vector<uint8_t> wav = makeTaggedWav(100);
+
+  // Every read the index makes, to prove no chunk header is read twice
+  std::vector<uint64_t> headerReads;
+  size_t reads = 0;
+
+  auto readAt = [&wav, &headerReads, &reads](uint64_t offset, void* dest, size_t bytes) {
+    ++reads;
+    if (bytes == 8) headerReads.push_back(offset);
+    if (offset > wav.size() || bytes > wav.size() - offset) return false;
+
+    std::memcpy(dest, wav.data() + offset, bytes);
+    return true;
+  };
+
+  WavChunkIndex index;
+  assert(WavChunkIndex::build(readAt, index));
+
+  // RIFF header, then fmt (16) + LIST (12) + bext (5 + pad) + data (200) + cue (28)
+  assert(index.format.offset == 20 && index.format.size == 16);
+  assert(index.list.offset == 44 && index.list.size == 12);
+  assert(index.bext.offset == 64 && index.bext.size == 5);
+  assert(index.data.offset == 78 && index.data.size == 200);
+  assert(index.cue.offset == 286 && index.cue.size == 28);
+
+  assert(index.info.dataOffset == index.data.offset);
+  assert(index.info.frameCount == 100);
+  assert(index.info.channels == 1 && index.info.sampleRate == 44100);
+
+  // Five chunk headers plus the one past the end that ends the walk
+  std::set<uint64_t> distinct(headerReads.begin(), headerReads.end());
+  assert(headerReads.size() == 6 && distinct.size() == headerReads.size());
+  assert(reads == 1 + 6 + 1);      // RIFF header, chunk headers, fmt payload
+
+  // The stream version finds the same chunks
+  std::istringstream stream(std::string(wav.begin(), wav.end()));
+  WavChunkIndex fromStream;
+  assert(WavChunkIndex::build(stream, fromStream));
+  assert(fromStream.cue.offset == index.cue.offset && fromStream.bext.size == index.bext.size);
+  assert(fromStream.info.frameCount == index.info.frameCount);
+
+  // Optional chunks may be missing; format and data may not
+  std::vector<uint8_t> plain = makeWav({ { "fmt ", makePcm16Format(2) }, { "data", std::vector<uint8_t>(40) } });
+  std::istringstream plainStream(std::string(plain.begin(), plain.end()));
+  assert(WavChunkIndex::build(plainStream, index));
+  assert(!index.list.isPresent() && !index.bext.isPresent() && !index.cue.isPresent());
+  assert(index.info.frameCount == 10);
+
+  std::vector<uint8_t> noData = makeWav({ { "fmt ", makePcm16Format(2) }, { "LIST", std::vector<uint8_t>(4) } });
+  std::istringstream noDataStream(std::string(noData.begin(), noData.end()));
+  assert(!WavChunkIndex::build(noDataStream, index));
+
+  std::cout << "✓ WavChunkIndex chunks test passed" << std::endl;
+}
+
+void testWavIndexCache() {
+  const std::string filename = "test_wav_index_cache.wav";
+  writeFile(filename, makeTaggedWav(100));
+
+  auto cache = std::make_shared<WavIndexCache>();
+  AudioFileLoader loader;
+  loader.setVerbose(false);
+  loader.setIndexCache(cache);
+
+  // Indexed once, then served from the cache for every later use
+  WavInfo info;
+  assert(loader.getWavInfo(filename, info));
+  assert(cache->size() == 1 && cache->getHits() == 0 && cache->getMisses() == 1);
+
+  assert(loader.canLoadFile(filename));
+
+  int sampleRate = 0, channels = 0, frameCount = 0;
+  assert(loader.getFileInfo(filename, sampleRate, channels, frameCount));
+  assert(frameCount == 100);
+
+  AudioBuffer buffer;
+  assert(loader.loadWavFile(filename, buffer));
+  assert(buffer.getFrameCount() == 100);
+
+  loader.setLoadMode(AudioFileLoader::LoadMode::Mapped);
+  assert(loader.loadWavFile(filename, buffer));
+  assert(buffer.getFrameCount() == 100);
+  assert(cache->getHits() == 4 && cache->getMisses() == 1);
+
+  WavChunkIndex index;
+  assert(loader.getChunkIndex(filename, index));
+  assert(index.cue.isPresent() && index.bext.size == 5);
+
+  // A rewritten file of another size is indexed again
+  buffer = AudioBuffer();
+  writeFile(filename, makeTaggedWav(250));
+  assert(loader.getWavInfo(filename, info));
+  assert(info.frameCount == 250);
+  assert(cache->getMisses() == 2 && cache->size() == 1);
+
+  // A deleted file is dropped
+  std::remove(filename.c_str());
+  assert(!cache->lookup(filename, index));
+  assert(cache->size() == 0);
+
+  // The least recently used entry goes first
+  const std::string other = "test_wav_index_cache_other.wav";
+  writeFile(filename, makeTaggedWav(10));
+  writeFile(other, makeTaggedWav(20));
+
+  WavIndexCache small(1);
+  assert(AudioFileLoader().getChunkIndex(filename, index));
+  small.store(filename, index);
+  small.store(other, index);
+  assert(small.size() == 1);
+  assert(!small.lookup(filename, index));
+  assert(small.lookup(other, index));
+
+  std::remove(filename.c_str());
+  std::remove(other.c_str());
+  std::cout << "✓ WavIndexCache test passed" << std::endl;
+}
@@ -47,6 +47,12 @@ void testWaveformViewZoom() {
   view.setZoom(0.5f);
   // Note: We can't easily test the zoom was set without rendering
   // but the calls shouldn't crash
+
+  // The gain preview is not limited like the zoom
+  view.setDisplayGain(0.05f);
+  assert(view.getDisplayGain() == 0.05f);
+  view.setDisplayGain(-1.0f);
+  assert(view.getDisplayGain() == 0.0f);
   std::cout << "✓ WaveformView zoom test passed" << std::endl;
 }
 
@@ -77,4 +83,33 @@ void testWaveformViewEmptyBuffer() {
   view.setAudioBuffer(buffer);
   // Should not crash with empty buffer
   std::cout << "✓ WaveformView empty buffer test passed" << std::endl;
-}
\ No newline at end of file
+}
+void testWaveformViewLoadingBuffer() {
+  WaveformView view(0, 0, 100, 100);
+  AudioBuffer buffer(44100, 2);
+  buffer.resize(10000);
+
+  for (size_t i = 0; i < 10000; ++i) {
+    buffer.setSample(i, 0, (i % 100) / 100.0f);
+    buffer.setSample(i, 1, -0.25f);
+  }
+
+  // Nothing is scanned until frames are reported as loaded
+  view.setLoadingBuffer(buffer);
+  assert(view.getPeaks().getFrameCount() == 10000);
+  assert(view.getPeaks().query(0, 10000).max == 0.0f);
+
+  // A partial load only scans whole buckets below the loaded edge
+  view.setLoadedFrames(1000);
+  assert(view.getPeaks().query(0, 768).min == -0.25f);
+  assert(view.getPeaks().query(4096, 4096).max == 0.0f);
+  view.updateWaveformData();
+
+  view.setLoadedFrames(10000);
+  PeakPyramid expected;
+  expected.build(buffer);
+  assert(view.getPeaks().query(0, 10000).max == expected.query(0, 10000).max);
+  assert(view.getPeaks().query(9984, 16).min == expected.query(9984, 16).min);
+
+  std::cout << "✓ WaveformView loading buffer test passed" << std::endl;
+}